@@ -0,0 +1,277 @@
+// ekf_replay - replay flight.dat.gz logs through the nav-ekf15 /
+// nav-ekf15-mag filters as fast as the cpu allows and sweep filter
+// noise parameters across all cores.
+//
+// Example:
+//   ekf-replay --sweep sig_gps_p_ne=1,2,3 --sweep tau_a=100,300
+//       flt00010/flight.dat.gz flt00011/flight.dat.gz
+
+#include <stdio.h>
+#include <stdlib.h>             // exit(), atof()
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "flight_log.h"
+#include "replay_run.h"
+#include "work_pool.h"
+
+// NAVconfig fields addressable from the command line
+static struct {
+    const char *name;
+    float NAVconfig::*field;
+} config_fields[] = {
+    { "sig_w_ax", &NAVconfig::sig_w_ax },
+    { "sig_w_ay", &NAVconfig::sig_w_ay },
+    { "sig_w_az", &NAVconfig::sig_w_az },
+    { "sig_w_gx", &NAVconfig::sig_w_gx },
+    { "sig_w_gy", &NAVconfig::sig_w_gy },
+    { "sig_w_gz", &NAVconfig::sig_w_gz },
+    { "sig_a_d", &NAVconfig::sig_a_d },
+    { "tau_a", &NAVconfig::tau_a },
+    { "sig_g_d", &NAVconfig::sig_g_d },
+    { "tau_g", &NAVconfig::tau_g },
+    { "sig_gps_p_ne", &NAVconfig::sig_gps_p_ne },
+    { "sig_gps_p_d", &NAVconfig::sig_gps_p_d },
+    { "sig_gps_v_ne", &NAVconfig::sig_gps_v_ne },
+    { "sig_gps_v_d", &NAVconfig::sig_gps_v_d },
+    { "sig_mag", &NAVconfig::sig_mag },
+};
+static const int num_config_fields = sizeof(config_fields) / sizeof(config_fields[0]);
+
+struct sweep_param_t {
+    int field;
+    vector<float> values;
+};
+
+struct variant_t {
+    NAVconfig config;
+    string label;
+};
+
+static void usage() {
+    printf("\nUsage: ekf-replay [options] flight.dat.gz [flight.dat.gz ...]\n");
+    printf("--filter nav-ekf15|nav-ekf15-mag (default nav-ekf15)\n");
+    printf("--threads n (default one per core)\n");
+    printf("--set name=value (fixed NAVconfig value)\n");
+    printf("--sweep name=v1,v2,... (sweep a NAVconfig value)\n");
+    printf("--sparse (block structured covariance propagation)\n");
+    printf("--sequential (sequential scalar measurement update)\n");
+    printf("--cov-rate hz (decimated covariance propagation)\n");
+    printf("--gps-delay sec (delayed gps fusion)\n");
+    printf("--output file.csv (per log/variant results, default stdout)\n");
+    printf("NAVconfig names:");
+    for ( int i = 0; i < num_config_fields; i++ ) {
+        printf(" %s", config_fields[i].name);
+    }
+    printf("\n");
+    exit(0);
+}
+
+static int find_field( const string &name ) {
+    for ( int i = 0; i < num_config_fields; i++ ) {
+        if ( name == config_fields[i].name ) {
+            return i;
+        }
+    }
+    printf("unknown NAVconfig field: %s\n", name.c_str());
+    usage();
+    return -1;
+}
+
+// parse "name=v1,v2,..."
+static sweep_param_t parse_param( const char *arg ) {
+    sweep_param_t param;
+    const char *eq = strchr(arg, '=');
+    if ( eq == NULL ) {
+        usage();
+    }
+    param.field = find_field( string(arg, eq - arg) );
+    const char *p = eq + 1;
+    while ( *p ) {
+        param.values.push_back( atof(p) );
+        const char *comma = strchr(p, ',');
+        if ( comma == NULL ) {
+            break;
+        }
+        p = comma + 1;
+    }
+    if ( param.values.empty() ) {
+        usage();
+    }
+    return param;
+}
+
+// cartesian product of all the sweep values
+static void build_variants( NAVconfig base, vector<sweep_param_t> &sweep,
+                            unsigned int level, string label,
+                            vector<variant_t> *variants )
+{
+    if ( level >= sweep.size() ) {
+        variant_t v;
+        v.config = base;
+        v.label = label;
+        variants->push_back(v);
+        return;
+    }
+    sweep_param_t &param = sweep[level];
+    for ( unsigned int i = 0; i < param.values.size(); i++ ) {
+        NAVconfig config = base;
+        config.*(config_fields[param.field].field) = param.values[i];
+        char buf[128];
+        snprintf( buf, sizeof(buf), "%s%s=%g", label.length() ? " " : "",
+                  config_fields[param.field].name, param.values[i] );
+        build_variants( config, sweep, level + 1, label + buf, variants );
+    }
+}
+
+int main( int argc, char **argv ) {
+    string filter_name = "nav-ekf15";
+    int threads = 0;
+    string output_file = "";
+    replay_options_t options;
+    NAVconfig base = ekf15_default_config();
+    vector<sweep_param_t> sweep;
+    vector<string> files;
+
+    // Parse the command line
+    for ( int iarg = 1; iarg < argc; iarg++ ) {
+        bool has_arg = iarg + 1 < argc;
+        if ( !strcmp(argv[iarg], "--filter") && has_arg ) {
+            filter_name = argv[++iarg];
+        } else if ( !strcmp(argv[iarg], "--threads") && has_arg ) {
+            threads = atoi(argv[++iarg]);
+        } else if ( !strcmp(argv[iarg], "--set") && has_arg ) {
+            sweep_param_t param = parse_param(argv[++iarg]);
+            base.*(config_fields[param.field].field) = param.values[0];
+        } else if ( !strcmp(argv[iarg], "--sweep") && has_arg ) {
+            sweep.push_back( parse_param(argv[++iarg]) );
+        } else if ( !strcmp(argv[iarg], "--sparse") ) {
+            options.sparse_covariance = true;
+        } else if ( !strcmp(argv[iarg], "--sequential") ) {
+            options.sequential_update = true;
+        } else if ( !strcmp(argv[iarg], "--cov-rate") && has_arg ) {
+            options.covariance_rate_hz = atof(argv[++iarg]);
+        } else if ( !strcmp(argv[iarg], "--gps-delay") && has_arg ) {
+            options.gps_delay_sec = atof(argv[++iarg]);
+        } else if ( !strcmp(argv[iarg], "--output") && has_arg ) {
+            output_file = argv[++iarg];
+        } else if ( argv[iarg][0] == '-' ) {
+            usage();
+        } else {
+            files.push_back(argv[iarg]);
+        }
+    }
+    if ( files.empty() ) {
+        usage();
+    }
+    if ( filter_name != "nav-ekf15" && filter_name != "nav-ekf15-mag" ) {
+        printf("unknown filter: %s\n", filter_name.c_str());
+        usage();
+    }
+    bool use_mag = filter_name == "nav-ekf15-mag";
+
+    work_pool_t pool(threads);
+
+    // load the logs (in parallel, they are independent)
+    vector<flight_log_t> logs(files.size());
+    vector< function<void()> > jobs;
+    for ( unsigned int i = 0; i < files.size(); i++ ) {
+        jobs.push_back( [&, i]() { load_flight_log(files[i], &logs[i]); } );
+    }
+    pool.run(jobs);
+    for ( unsigned int i = 0; i < logs.size(); i++ ) {
+        printf("%s: %d imu, %d gps records, %d parse errors\n",
+               files[i].c_str(), logs[i].imu_count, logs[i].gps_count,
+               logs[i].parse_errors);
+    }
+
+    vector<variant_t> variants;
+    build_variants( base, sweep, 0, "", &variants );
+    printf("Running %d variants x %d logs with %d threads\n",
+           (int)variants.size(), (int)logs.size(), pool.size());
+
+    // one job per (variant, log)
+    vector<replay_result_t> results(variants.size() * logs.size());
+    jobs.clear();
+    for ( unsigned int v = 0; v < variants.size(); v++ ) {
+        for ( unsigned int l = 0; l < logs.size(); l++ ) {
+            int index = v * logs.size() + l;
+            jobs.push_back( [&, v, l, index]() {
+                auto start = std::chrono::steady_clock::now();
+                replay_result_t r;
+                if ( use_mag ) {
+                    r = run_ekf15_mag(logs[l], variants[v].config, options);
+                } else {
+                    r = run_ekf15(logs[l], variants[v].config, options);
+                }
+                std::chrono::duration<double> elapsed
+                    = std::chrono::steady_clock::now() - start;
+                r.cpu_sec = elapsed.count();
+                results[index] = r;
+            } );
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    pool.run(jobs);
+    std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    FILE *out = stdout;
+    if ( output_file.length() ) {
+        out = fopen(output_file.c_str(), "w");
+        if ( out == NULL ) {
+            printf("unable to open: %s\n", output_file.c_str());
+            return 1;
+        }
+    }
+    fprintf(out, "log,variant,gps_updates,pos_rms_m,vel_rms_ms,nis,flight_sec,cpu_sec\n");
+    for ( unsigned int v = 0; v < variants.size(); v++ ) {
+        for ( unsigned int l = 0; l < logs.size(); l++ ) {
+            replay_result_t &r = results[v * logs.size() + l];
+            fprintf(out, "%s,%s,%d,%.4f,%.4f,%.4f,%.1f,%.3f\n",
+                    logs[l].name.c_str(), variants[v].label.c_str(),
+                    r.gps_updates, r.pos_rms_m, r.vel_rms_ms, r.nis,
+                    r.flight_sec, r.cpu_sec);
+        }
+    }
+    if ( out != stdout ) {
+        fclose(out);
+    }
+
+    // summary: mean innovation statistics per variant over all logs,
+    // best (smallest velocity innovation) first
+    vector<int> order(variants.size());
+    vector<double> pos(variants.size()), vel(variants.size()),
+        nis(variants.size());
+    double flight_sec = 0.0;
+    for ( unsigned int v = 0; v < variants.size(); v++ ) {
+        order[v] = v;
+        for ( unsigned int l = 0; l < logs.size(); l++ ) {
+            replay_result_t &r = results[v * logs.size() + l];
+            pos[v] += r.pos_rms_m / logs.size();
+            vel[v] += r.vel_rms_ms / logs.size();
+            nis[v] += r.nis / logs.size();
+            flight_sec += r.flight_sec;
+        }
+    }
+    std::sort( order.begin(), order.end(),
+               [&](int a, int b) { return vel[a] < vel[b]; } );
+    printf("\n%10s %10s %8s  variant\n", "pos_rms_m", "vel_rms_ms", "nis");
+    for ( unsigned int i = 0; i < order.size(); i++ ) {
+        int v = order[i];
+        printf("%10.4f %10.4f %8.3f  %s\n", pos[v], vel[v], nis[v],
+               variants[v].label.length() ? variants[v].label.c_str()
+               : "(defaults)");
+    }
+    printf("\nReplayed %.0f flight seconds in %.2f seconds (%.0fx real time)\n",
+           flight_sec, elapsed.count(),
+           elapsed.count() > 0.0 ? flight_sec / elapsed.count() : 0.0);
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+// flight_log.cpp - load imu/gps records from a flight.dat.gz log
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "flight_log.h"
+
+// message ids and python struct pack strings from
+// tools/messages/aura_messages.json (see src/comms/aura_messages.py)
+static const uint8_t gps_v2_id = 16;
+static const uint8_t gps_v3_id = 26;
+static const uint8_t gps_v4_id = 34;
+static const uint8_t imu_v3_id = 17;
+static const uint8_t imu_v4_id = 35;
+static const uint8_t imu_v5_id = 45;
+
+static const char *gps_v2_fmt = "BdddfhhhdBB";
+static const char *gps_v3_fmt = "BdddfhhhdBHHHB";
+static const char *gps_v4_fmt = "BfddfhhhdBHHHB";
+static const char *imu_v3_fmt = "BdfffffffffhB";
+static const char *imu_v4_fmt = "BffffffffffhB";
+static const char *imu_v5_fmt = "BffffffffffffffffhB";
+
+static const uint8_t START_OF_MSG0 = 147;
+static const uint8_t START_OF_MSG1 = 224;
+
+// decode a little endian packed payload described by a python struct
+// format string into an array of doubles.  Returns the number of
+// fields decoded or -1 if the payload length doesn't match.
+static int unpack_fields( const char *fmt, const uint8_t *buf, int len,
+                          double *out, int max_fields )
+{
+    int pos = 0;
+    int n = 0;
+    for ( const char *c = fmt; *c && n < max_fields; c++, n++ ) {
+        int size = 0;
+        switch ( *c ) {
+        case 'B': case 'b': size = 1; break;
+        case 'H': case 'h': size = 2; break;
+        case 'L': case 'l': case 'f': size = 4; break;
+        case 'Q': case 'q': case 'd': size = 8; break;
+        default: return -1;
+        }
+        if ( pos + size > len ) {
+            return -1;
+        }
+        const uint8_t *p = buf + pos;
+        switch ( *c ) {
+        case 'B': out[n] = *p; break;
+        case 'b': out[n] = (int8_t)*p; break;
+        case 'H': { uint16_t v; memcpy(&v, p, 2); out[n] = v; break; }
+        case 'h': { int16_t v; memcpy(&v, p, 2); out[n] = v; break; }
+        case 'L': { uint32_t v; memcpy(&v, p, 4); out[n] = v; break; }
+        case 'l': { int32_t v; memcpy(&v, p, 4); out[n] = v; break; }
+        case 'f': { float v; memcpy(&v, p, 4); out[n] = v; break; }
+        case 'Q': { uint64_t v; memcpy(&v, p, 8); out[n] = v; break; }
+        case 'q': { int64_t v; memcpy(&v, p, 8); out[n] = v; break; }
+        case 'd': { double v; memcpy(&v, p, 8); out[n] = v; break; }
+        }
+        pos += size;
+    }
+    return pos == len ? n : -1;
+}
+
+// returns true if the message was an imu/gps record
+static bool decode_message( uint8_t id, const uint8_t *buf, int len,
+                            log_record_t *rec )
+{
+    double f[32];
+    memset(rec, 0, sizeof(log_record_t));
+    if ( id == imu_v3_id || id == imu_v4_id || id == imu_v5_id ) {
+        const char *fmt = imu_v5_fmt;
+        if ( id == imu_v3_id ) { fmt = imu_v3_fmt; }
+        if ( id == imu_v4_id ) { fmt = imu_v4_fmt; }
+        int n = unpack_fields(fmt, buf, len, f, 32);
+        if ( n < 0 ) {
+            return false;
+        }
+        rec->is_gps = false;
+        rec->imu.time = f[1];
+        rec->imu.p = f[2];
+        rec->imu.q = f[3];
+        rec->imu.r = f[4];
+        rec->imu.ax = f[5];
+        rec->imu.ay = f[6];
+        rec->imu.az = f[7];
+        rec->imu.hx = f[8];
+        rec->imu.hy = f[9];
+        rec->imu.hz = f[10];
+        rec->imu.temp = f[n-2] / 10.0;
+        return true;
+    } else if ( id == gps_v2_id || id == gps_v3_id || id == gps_v4_id ) {
+        const char *fmt = gps_v4_fmt;
+        if ( id == gps_v2_id ) { fmt = gps_v2_fmt; }
+        if ( id == gps_v3_id ) { fmt = gps_v3_fmt; }
+        int n = unpack_fields(fmt, buf, len, f, 32);
+        if ( n < 0 ) {
+            return false;
+        }
+        rec->is_gps = true;
+        rec->gps.time = f[1];
+        rec->gps.lat = f[2];    // deg (as the filters expect)
+        rec->gps.lon = f[3];
+        rec->gps.alt = f[4];
+        rec->gps.vn = f[5] / 100.0;
+        rec->gps.ve = f[6] / 100.0;
+        rec->gps.vd = f[7] / 100.0;
+        rec->gps.unix_sec = f[8];
+        rec->gps.sats = f[9];
+        if ( id == gps_v2_id ) {
+            rec->fix_type = rec->gps.sats >= 5 ? 3 : 0;
+        } else {
+            rec->fix_type = f[13];
+        }
+        return true;
+    }
+    return false;
+}
+
+bool load_flight_log( const string &file, flight_log_t *log ) {
+    gzFile fd = gzopen( file.c_str(), "rb" );
+    if ( fd == NULL ) {
+        fprintf( stderr, "unable to open: %s\n", file.c_str() );
+        return false;
+    }
+    log->name = file;
+    log->records.clear();
+
+    // framing state machine (same wire format as SerialLink)
+    int state = 0;
+    uint8_t pkt_id = 0;
+    int pkt_len = 0;
+    int counter = 0;
+    uint8_t payload[256];
+    uint8_t cksum_lo = 0;
+
+    uint8_t buf[65536];
+    int len;
+    while ( (len = gzread(fd, buf, sizeof(buf))) > 0 ) {
+        for ( int i = 0; i < len; i++ ) {
+            uint8_t c = buf[i];
+            if ( state == 0 ) {
+                if ( c == START_OF_MSG0 ) {
+                    state = 1;
+                }
+            } else if ( state == 1 ) {
+                if ( c == START_OF_MSG1 ) {
+                    state = 2;
+                } else if ( c != START_OF_MSG0 ) {
+                    log->parse_errors++;
+                    state = 0;
+                }
+            } else if ( state == 2 ) {
+                pkt_id = c;
+                state = 3;
+            } else if ( state == 3 ) {
+                pkt_len = c;
+                counter = 0;
+                state = pkt_len > 0 ? 4 : 5;
+            } else if ( state == 4 ) {
+                payload[counter++] = c;
+                if ( counter >= pkt_len ) {
+                    state = 5;
+                }
+            } else if ( state == 5 ) {
+                cksum_lo = c;
+                state = 6;
+            } else if ( state == 6 ) {
+                uint8_t c0 = pkt_id;
+                uint8_t c1 = c0;
+                c0 += pkt_len;
+                c1 += c0;
+                for ( int j = 0; j < pkt_len; j++ ) {
+                    c0 += payload[j];
+                    c1 += c0;
+                }
+                if ( c0 == cksum_lo && c1 == c ) {
+                    log_record_t rec;
+                    if ( decode_message(pkt_id, payload, pkt_len, &rec) ) {
+                        log->records.push_back(rec);
+                        if ( rec.is_gps ) {
+                            log->gps_count++;
+                        } else {
+                            log->imu_count++;
+                        }
+                    }
+                } else {
+                    log->parse_errors++;
+                }
+                state = 0;
+            }
+        }
+    }
+    gzclose(fd);
+    return true;
+}
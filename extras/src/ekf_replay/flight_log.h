@@ -0,0 +1,29 @@
+// flight_log.h - load imu/gps records from a flight.dat.gz log (the
+// framed aura message stream written by src/comms/logging.py)
+
+#pragma once
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "filters/nav_common/structs.h"
+
+struct log_record_t {
+    bool is_gps;
+    IMUdata imu;
+    GPSdata gps;
+    int fix_type;               // 3 = 3d fix (gps records only)
+};
+
+struct flight_log_t {
+    string name;
+    vector<log_record_t> records;
+    int imu_count = 0;
+    int gps_count = 0;
+    int parse_errors = 0;
+};
+
+// returns false if the file could not be opened
+bool load_flight_log( const string &file, flight_log_t *log );
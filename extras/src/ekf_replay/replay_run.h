@@ -0,0 +1,125 @@
+// replay_run.h - run one filter configuration over one flight log
+
+#pragma once
+
+#include <math.h>
+
+#include "filters/nav_common/constants.h"
+#include "filters/nav_common/structs.h"
+
+#include "flight_log.h"
+
+// filter options beyond the NAVconfig noise parameters (mirror the
+// /config/filters section options)
+struct replay_options_t {
+    bool sparse_covariance = false;
+    bool sequential_update = false;
+    float covariance_rate_hz = 0.0;
+    float gps_delay_sec = 0.0;
+};
+
+// gps innovation statistics accumulated just before each measurement
+// update, plus timing
+struct replay_result_t {
+    int gps_updates = 0;
+    double pos_rms_m = 0.0;     // ned position innovation
+    double vel_rms_ms = 0.0;    // ned velocity innovation
+    double nis = 0.0;           // mean normalized innovation squared
+    double flight_sec = 0.0;
+    double cpu_sec = 0.0;
+};
+
+// the (shared) filter default noise configuration
+NAVconfig ekf15_default_config();
+
+replay_result_t run_ekf15( const flight_log_t &log, NAVconfig config,
+                           replay_options_t options );
+replay_result_t run_ekf15_mag( const flight_log_t &log, NAVconfig config,
+                               replay_options_t options );
+
+// Shared driver loop.  Follows the nav_ekf15_update() logic in
+// aura_interface.cpp: init once gps has held a 3d fix for 10 seconds,
+// then a time update for every imu record and a measurement update
+// for every new gps record.
+template <class FILTER, class GPS_UPDATE>
+replay_result_t run_filter( FILTER &filter, const flight_log_t &log,
+                            NAVconfig config, GPS_UPDATE gps_update )
+{
+    replay_result_t result;
+    const double gps_settle = 10.0;
+    const double Re = 6378137.0;
+
+    filter.set_config(config);
+
+    bool inited = false;
+    bool have_imu = false;
+    bool have_gps = false;
+    double gps_acq_time = -1.0;
+    double last_gps_time = 0.0;
+    double start_time = -1.0;
+    IMUdata imu;
+    GPSdata gps;
+    double sum_pos = 0.0, sum_vel = 0.0, sum_nis = 0.0;
+
+    for ( unsigned int i = 0; i < log.records.size(); i++ ) {
+        const log_record_t &rec = log.records[i];
+        if ( rec.is_gps ) {
+            gps = rec.gps;
+            if ( rec.fix_type >= 3 ) {
+                if ( gps_acq_time < 0.0 ) {
+                    gps_acq_time = gps.time;
+                }
+                have_gps = gps.time - gps_acq_time >= gps_settle;
+            }
+            continue;
+        }
+        imu = rec.imu;
+        if ( !have_imu ) {
+            start_time = imu.time;
+            have_imu = true;
+        }
+        result.flight_sec = imu.time - start_time;
+        if ( !inited ) {
+            if ( have_gps && fabs(imu.time - gps.time) < 1.0 ) {
+                filter.init(imu, gps);
+                last_gps_time = gps.time;
+                inited = true;
+            }
+            continue;
+        }
+        filter.time_update(imu);
+        if ( gps.time > last_gps_time ) {
+            last_gps_time = gps.time;
+            NAVdata nav = filter.get_nav();
+            double y[6];
+            y[0] = (gps.lat*D2R - nav.lat) * Re;
+            y[1] = (gps.lon*D2R - nav.lon) * Re * cos(nav.lat);
+            y[2] = nav.alt - gps.alt;
+            y[3] = gps.vn - nav.vn;
+            y[4] = gps.ve - nav.ve;
+            y[5] = gps.vd - nav.vd;
+            double p[6] = { nav.Pp0, nav.Pp1, nav.Pp2,
+                            nav.Pv0, nav.Pv1, nav.Pv2 };
+            double r[6] = { config.sig_gps_p_ne, config.sig_gps_p_ne,
+                            config.sig_gps_p_d, config.sig_gps_v_ne,
+                            config.sig_gps_v_ne, config.sig_gps_v_d };
+            for ( int j = 0; j < 6; j++ ) {
+                if ( j < 3 ) {
+                    sum_pos += y[j] * y[j];
+                } else {
+                    sum_vel += y[j] * y[j];
+                }
+                sum_nis += y[j] * y[j] / (p[j] + r[j] * r[j]);
+            }
+            gps_update(filter, imu, gps);
+            result.gps_updates++;
+        }
+    }
+
+    if ( result.gps_updates > 0 ) {
+        result.pos_rms_m = sqrt(sum_pos / result.gps_updates);
+        result.vel_rms_ms = sqrt(sum_vel / result.gps_updates);
+        result.nis = sum_nis / (6.0 * result.gps_updates);
+    }
+    return result;
+}
@@ -0,0 +1,24 @@
+// run_ekf15.cpp - replay a flight log through the nav-ekf15 filter
+
+#include "filters/nav_ekf15/EKF_15state.h"
+
+#include "replay_run.h"
+
+NAVconfig ekf15_default_config() {
+    EKF15 filter;
+    return filter.get_config();
+}
+
+replay_result_t run_ekf15( const flight_log_t &log, NAVconfig config,
+                           replay_options_t options )
+{
+    EKF15 filter;
+    filter.set_sparse_covariance(options.sparse_covariance);
+    filter.set_sequential_update(options.sequential_update);
+    filter.set_covariance_rate(options.covariance_rate_hz);
+    filter.set_gps_delay(options.gps_delay_sec);
+    return run_filter( filter, log, config,
+                       [](EKF15 &f, IMUdata &, GPSdata &gps) {
+                           f.measurement_update(gps);
+                       } );
+}
@@ -0,0 +1,20 @@
+// run_ekf15_mag.cpp - replay a flight log through the nav-ekf15-mag
+// filter
+
+#include "filters/nav_ekf15_mag/EKF_15state.h"
+
+#include "replay_run.h"
+
+replay_result_t run_ekf15_mag( const flight_log_t &log, NAVconfig config,
+                               replay_options_t options )
+{
+    EKF15_mag filter;
+    filter.set_sparse_covariance(options.sparse_covariance);
+    filter.set_sequential_update(options.sequential_update);
+    filter.set_covariance_rate(options.covariance_rate_hz);
+    filter.set_gps_delay(options.gps_delay_sec);
+    return run_filter( filter, log, config,
+                       [](EKF15_mag &f, IMUdata &imu, GPSdata &gps) {
+                           f.measurement_update(imu, gps);
+                       } );
+}
@@ -0,0 +1,85 @@
+// work_pool.h - a small work stealing thread pool for running a
+// fixed batch of independent jobs across all cores
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::deque;
+using std::function;
+using std::mutex;
+using std::thread;
+using std::vector;
+
+class work_pool_t {
+
+public:
+
+    // threads <= 0 means one per core
+    work_pool_t( int threads = 0 ) {
+        num_threads = threads > 0 ? threads : thread::hardware_concurrency();
+        if ( num_threads < 1 ) {
+            num_threads = 1;
+        }
+    }
+
+    int size() { return num_threads; }
+
+    // Run every job and return when all are finished.  Jobs are dealt
+    // round robin to per-thread queues.  A thread works from the back
+    // of its own queue and when that runs dry steals from the front
+    // of the others, so long jobs (big logs) don't leave cores idle.
+    void run( vector< function<void()> > &jobs ) {
+        vector<queue_t> queues(num_threads);
+        for ( unsigned int i = 0; i < jobs.size(); i++ ) {
+            queues[i % num_threads].jobs.push_back(i);
+        }
+        vector<thread> workers;
+        for ( int t = 0; t < num_threads; t++ ) {
+            workers.push_back( thread( [&, t]() {
+                int job;
+                while ( next_job(queues, t, &job) ) {
+                    jobs[job]();
+                }
+            } ) );
+        }
+        for ( unsigned int t = 0; t < workers.size(); t++ ) {
+            workers[t].join();
+        }
+    }
+
+private:
+
+    struct queue_t {
+        mutex lock;
+        deque<int> jobs;
+    };
+
+    int num_threads;
+
+    bool next_job( vector<queue_t> &queues, int self, int *job ) {
+        {
+            std::lock_guard<mutex> guard(queues[self].lock);
+            if ( !queues[self].jobs.empty() ) {
+                *job = queues[self].jobs.back();
+                queues[self].jobs.pop_back();
+                return true;
+            }
+        }
+        // no jobs are ever added once running, so if every queue is
+        // empty we are done
+        for ( int i = 1; i < num_threads; i++ ) {
+            queue_t &victim = queues[(self + i) % num_threads];
+            std::lock_guard<mutex> guard(victim.lock);
+            if ( !victim.jobs.empty() ) {
+                *job = victim.jobs.front();
+                victim.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+};
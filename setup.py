@@ -22,6 +22,7 @@ setup(
                   ],
                   depends=[
                       "src/control/actuators.h",
+                      "src/util/props_handle.h",
                       "src/util/timing.h"
                   ],
                   include_dirs=["src"],
@@ -31,6 +32,9 @@ setup(
                   define_macros=[("HAVE_PYBIND11", "1")],
                   sources=[
                       "src/control/ap.cpp",
+                      "src/control/ap_pool.cpp",
+                      "src/control/ap_profile.cpp",
+                      "src/control/ap_program.cpp",
                       "src/control/cas.cpp",
                       "src/control/control.cpp",
                       "src/control/dig_filter.cpp",
@@ -40,10 +44,14 @@ setup(
                       "src/control/predictor.cpp",
                       "src/control/summer.cpp",
                       "src/control/tecs.cpp",
+                      "src/util/butter.cpp",
                       "src/util/timing.cpp"
                   ],
                   depends=[
                       "src/control/ap.h",
+                      "src/control/ap_pool.h",
+                      "src/control/ap_profile.h",
+                      "src/control/ap_program.h",
                       "src/control/cas.h",
                       "src/control/control.h",
                       "src/control/dig_filter.h",
@@ -53,9 +61,12 @@ setup(
                       "src/control/predictor.h",
                       "src/control/summer.h",
                       "src/control/tecs.h",
+                      "src/util/butter.h",
+                      "src/util/props_handle.h",
                       "src/util/timing.h"
                   ],
                   include_dirs=["src"],
+                  libraries=["pthread"],
                   extra_objects=["/usr/local/lib/libpyprops.a"]
                   ),
         Extension("rcUAS.driver_mgr",
@@ -63,6 +74,7 @@ setup(
                   sources=[
                       "src/drivers/Aura4/Aura4.cpp",
                       "src/drivers/driver_mgr.cpp",
+                      "src/drivers/driver_reader.cpp",
                       "src/drivers/fgfs.cpp",
                       "src/drivers/gps_gpsd.cpp",
                       "src/drivers/lightware.cpp",
@@ -71,11 +83,12 @@ setup(
                       "src/drivers/ublox6.cpp",
                       "src/drivers/ublox8.cpp",
                       "src/drivers/ublox9.cpp",
+                      "src/drivers/ubx_link.cpp",
                       "src/filters/nav_common/coremag.c",
                       "src/filters/nav_common/nav_functions.cpp",
                       "src/util/butter.cpp",
+                      "src/util/clock_sync.cpp",
                       "src/util/geodesy.cpp",
-                      "src/util/linearfit.cpp",
                       "src/util/lowpass.cpp",
                       "src/util/netSocket.cpp",
                       "src/util/props_helper.cpp",
@@ -89,6 +102,7 @@ setup(
                       "src/drivers/Aura4/Aura4.h",
                       "src/drivers/driver.h",
                       "src/drivers/driver_mgr.h",
+                      "src/drivers/driver_reader.h",
                       "src/drivers/fgfs.h",
                       "src/drivers/gps_gpsd.h",
                       "src/drivers/lightware.h",
@@ -97,20 +111,25 @@ setup(
                       "src/drivers/ublox6.h",
                       "src/drivers/ublox8.h",
                       "src/drivers/ublox9.h",
+                      "src/drivers/ubx_link.h",
                       "src/filters/nav_common/coremag.h",
                       "src/filters/nav_common/nav_functions.h",
                       "src/util/butter.h",
+                      "src/util/clock_sync.h",
                       "src/util/geodesy.h",
-                      "src/util/linearfit.h",
                       "src/util/lowpass.h",
                       "src/util/netSocket.h",
+                      "src/util/props_record.h",
+                      "src/util/props_handle.h",
                       "src/util/props_helper.h",
                       "src/util/serial_link.h",
                       "src/util/sg_path.h",
+                      "src/util/spsc_queue.h",
                       "src/util/strutils.h",
                       "src/util/timing.h"
                   ],
                   include_dirs=["src"],
+                  libraries=["pthread"],
                   extra_objects=["/usr/local/lib/libpyprops.a"]
                   ),
         Extension("rcUAS.airdata_helper",
@@ -149,6 +168,7 @@ setup(
                       "src/filters/wind.cpp",
                       "src/filters/nav_ekf15/aura_interface.cpp",
                       "src/filters/nav_ekf15/EKF_15state.cpp",
+                      "src/filters/nav_ekf15/EKF_15state_bank.cpp",
                       "src/filters/nav_ekf15_mag/aura_interface.cpp",
                       "src/filters/nav_ekf15_mag/EKF_15state.cpp",
                       "src/filters/nav_common/coremag.c",
@@ -160,13 +180,18 @@ setup(
                       "src/filters/filter_mgr.h",
                       "src/filters/ground.h",
                       "src/filters/wind.h",
+                      "src/filters/nav_common/EKF_15state_core.h",
+                      "src/filters/nav_common/EKF_15state_core_impl.h",
                       "src/filters/nav_ekf15/aura_interface.h",
                       "src/filters/nav_ekf15/EKF_15state.h",
+                      "src/filters/nav_ekf15/EKF_15state_bank.h",
                       "src/filters/nav_ekf15_mag/aura_interface.h",
                       "src/filters/nav_ekf15_mag/EKF_15state.h",
                       "src/filters/nav_common/coremag.h",
                       "src/filters/nav_common/nav_functions.h",
                       "src/util/lowpass.h",
+                      "src/util/props_handle.h",
+                      "src/util/props_record.h",
                       "src/util/props_helper.h"
                   ],
                   include_dirs=["src"],
@@ -26,27 +26,43 @@ void actuators_t::init() {
     pilot_node = pyGetNode("/sensors/pilot_input", true);
     act_node = pyGetNode("/actuators", true);
     ap_node = pyGetNode("/autopilot", true);
+
+    flight_aileron.bind( flight_node, "aileron" );
+    flight_elevator.bind( flight_node, "elevator" );
+    flight_rudder.bind( flight_node, "rudder" );
+    flight_flaps.bind( flight_node, "flaps" );
+    flight_gear.bind( flight_node, "gear" );
+    engine_throttle.bind( engine_node, "throttle" );
+    act_timestamp.bind( act_node, "timestamp" );
+    act_aileron.bind( act_node, "aileron" );
+    act_elevator.bind( act_node, "elevator" );
+    act_rudder.bind( act_node, "rudder" );
+    act_flaps.bind( act_node, "flaps" );
+    act_gear.bind( act_node, "gear" );
+    act_throttle.bind( act_node, "throttle" );
+    act_throttle_safety.bind( act_node, "throttle_safety" );
+    excite_running.bind( excite_node, "running" );
 }
 
 void actuators_t::update() {
     // set time stamp for logging
-    act_node.setDouble( "timestamp", get_Time() );
+    act_timestamp.set( get_Time() );
 
-    float aileron = flight_node.getDouble("aileron");
-    act_node.setDouble( "aileron", aileron );
+    float aileron = flight_aileron.get();
+    act_aileron.set( aileron );
 
-    float elevator = flight_node.getDouble("elevator");
-    act_node.setDouble( "elevator", elevator );
+    float elevator = flight_elevator.get();
+    act_elevator.set( elevator );
 
     // rudder
-    float rudder = flight_node.getDouble("rudder");
-    act_node.setDouble( "rudder", rudder );
+    float rudder = flight_rudder.get();
+    act_rudder.set( rudder );
 
-    double flaps = flight_node.getDouble("flaps");
-    act_node.setDouble("flaps", flaps );
+    double flaps = flight_flaps.get();
+    act_flaps.set( flaps );
 
-    double gear = flight_node.getDouble("gear");
-    act_node.setDouble("gear", gear );
+    double gear = flight_gear.get();
+    act_gear.set( gear );
 
     // CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!!
     // CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!!
@@ -104,11 +120,11 @@ void actuators_t::update() {
 
     // throttle
 
-    double throttle = engine_node.getDouble("throttle");
-    act_node.setDouble("throttle", throttle );
+    double throttle = engine_throttle.get();
+    act_throttle.set( throttle );
 
     // add in excitation signals if excitation task is running
-    if ( excite_node.getBool("running") ) {
+    if ( excite_running.get() ) {
         float signal = 0.0;
         string target = "";
         int n = excite_node.getLong("channels");
@@ -136,17 +152,17 @@ void actuators_t::update() {
 
 	    static int sas_throttle_state = 0;
 	    if ( sas_throttle_state == 0 ) {
-		if ( engine_node.getDouble("throttle") < 0.05 ) {
+		if ( engine_throttle.get() < 0.05 ) {
 		    // wait for zero throttle
 		    sas_throttle_state = 1;
 		}
 	    } else if ( sas_throttle_state == 1 ) {
-		if ( engine_node.getDouble("throttle") > 0.95 ) {
+		if ( engine_throttle.get() > 0.95 ) {
 		    // next wait for full throttle
 		    sas_throttle_state = 2;
 		}
 	    } else if ( sas_throttle_state == 2 ) {
-		if ( engine_node.getDouble("throttle") < 0.05 ) {
+		if ( engine_throttle.get() < 0.05 ) {
 		    // next wait for zero throttle again.  Throttle pass
 		    // through is now live, even under 100' AGL
 		    sas_throttle_state = 3;
@@ -162,8 +178,8 @@ void actuators_t::update() {
     // elevation is the pressure altitude we recorded with the system
     // started up.
     if ( ! sas_throttle_override ) {
-	if ( act_node.getBool("throttle_safety") ) {
-	    act_node.setDouble("throttle", 0.0 );
+	if ( act_throttle_safety.get() ) {
+	    act_throttle.set( 0.0 );
 	}
     }
 
@@ -10,6 +10,8 @@
 
 #include <pyprops.h>
 
+#include "util/props_handle.h"
+
 class actuators_t {
 private:
     pyPropertyNode flight_node;
@@ -18,6 +20,14 @@ private:
     pyPropertyNode act_node;
     pyPropertyNode ap_node;
     pyPropertyNode excite_node;
+
+    // per-frame values (bound in init())
+    prop_double_t flight_aileron, flight_elevator, flight_rudder;
+    prop_double_t flight_flaps, flight_gear, engine_throttle;
+    prop_double_t act_timestamp, act_aileron, act_elevator, act_rudder;
+    prop_double_t act_flaps, act_gear, act_throttle;
+    prop_bool_t act_throttle_safety;
+    prop_bool_t excite_running;
     
 public:
     actuators_t() {}
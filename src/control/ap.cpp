@@ -39,12 +39,31 @@ using std::ostringstream;
 #include "summer.h"
 
 
-void AuraAutopilot::init() {
+void AuraAutopilot::init( ap_profile_t *profile ) {
+    this->profile = profile;
     if ( ! build() ) {
 	printf("AP: Detected an internal inconsistency in the autopilot\n");
 	printf("configuration.  See earlier errors for details.\n" );
 	exit(-1);
     }
+
+    // one profile stage per component, in run order, on the thread
+    // that runs it
+    if ( profile != NULL ) {
+        vector<int> task_of( components.size(), 0 );
+        for ( unsigned int t = 0; t < chains.size(); t++ ) {
+            for ( unsigned int i = 0; i < chains[t].size(); i++ ) {
+                task_of[chains[t][i]] = t;
+            }
+        }
+        for ( unsigned int i = 0; i < components.size(); ++i ) {
+            int id = profile->add( components[i]->get_name(),
+                                   pool.size() > 0 ? task_of[i] : 0 );
+            if ( i == 0 ) {
+                first_stage = id;
+            }
+        }
+    }
 }
 
 
@@ -58,14 +77,11 @@ void AuraAutopilot::reset() {
 bool AuraAutopilot::build() {
     pyPropertyNode config_props = pyGetNode( "/config/autopilot", true );
 
-    // FIXME: we have always depended on the order of children
-    // components here to ensure PID stages are run in the correct
-    // order, however that is a bad thing to assume ... especially now
-    // with pyprops!!!
+    // components are created in the order of the children here,
+    // compiled the run order comes from their dataflow (see
+    // schedule())
     vector <string> children = config_props.getChildren();
     for ( unsigned int i = 0; i < children.size(); ++i ) {
-	pyPropertyNode component = config_props.getChild(children[i].c_str(),
-							 true);
         printf("ap stage: %s\n", children[i].c_str());
 	string name = children[i];
 	size_t pos = name.find("[");
@@ -73,6 +89,8 @@ bool AuraAutopilot::build() {
 	    name = name.substr(0, pos);
 	}
 	if ( name == "component" ) {
+	    pyPropertyNode component
+		= config_props.getChild(children[i].c_str(), true);
 	    ostringstream config_path;
 	    config_path << "/config/autopilot/" << children[i];
 	    string module = component.getString("module");
@@ -108,16 +126,277 @@ bool AuraAutopilot::build() {
 	    // configuration placeholder, we don't do anything here.
 	} else if ( name == "TECS" ) {
             // configuration placeholder, we don't do anything here.
+	} else if ( name == "interpreter" || name == "threads"
+		    || name == "spin_ms" || name == "profile" ) {
+            // settings, handled below
          } else {
 	    printf("Unknown top level section: %s\n", children[i].c_str() );
             return false;
         }
     }
 
+    // compile (this also collects the dataflow graph)
+    for ( unsigned int i = 0; i < components.size(); ++i ) {
+        program.begin_component( i );
+        components[i]->compile( program );
+    }
+    program.finalize();
+
+    int threads = config_props.getLong("threads");
+    if ( threads < 0 ) {
+        threads = 0;
+    }
+    if ( threads > ap_pool_t::max_workers ) {
+        threads = ap_pool_t::max_workers;
+    }
+    bool interpreter = config_props.getBool("interpreter");
+    if ( interpreter && threads > 0 ) {
+        printf("AP: threads need compiled property access, running serially\n");
+        threads = 0;
+    }
+    schedule( threads + 1, !interpreter );
+
+    if ( interpreter ) {
+        program.clear();
+        printf("AP: interpreted property access\n");
+    } else {
+        compiled = true;
+        printf("AP: compiled %ld components, %d property slots\n",
+               components.size(), program.size());
+    }
+
+    int workers = 0;
+    for ( unsigned int i = 1; i < chains.size(); i++ ) {
+        if ( chains[i].size() > 0 ) {
+            workers = i;
+        }
+    }
+    if ( workers > 0 ) {
+        double spin_ms = 20.0;
+        if ( config_props.hasChild("spin_ms") ) {
+            spin_ms = config_props.getDouble("spin_ms");
+        }
+        pool.start( workers, spin_ms, [this]( int task ) {
+                run_chain( task );
+            } );
+        printf("AP: %d worker thread(s)\n", workers);
+    }
+
     return true;
 }
 
 
+// Order the components so every stage runs after the stages that
+// produce its inputs (config order breaks ties), then split them into
+// independent chains and deal the chains out to tasks.  Stages
+// writing the same property keep their config order (the last one
+// wins, as before.)  A dependency cycle is broken at its first stage
+// in config order, which then reads the rest of the cycle's outputs
+// from the previous frame; the other stages are still sorted.  Without
+// reorder (interpreted access) the config order is kept as is.
+bool AuraAutopilot::schedule( int tasks, bool reorder ) {
+    int n = components.size();
+    const vector<ap_program_t::access_t> &accesses = program.get_accesses();
+
+    // producers and consumers of each slot, in config order
+    vector< vector<int> > writers( program.size() );
+    vector< vector<int> > readers( program.size() );
+    for ( unsigned int i = 0; i < accesses.size(); i++ ) {
+        vector<int> &list = accesses[i].output
+            ? writers[accesses[i].slot] : readers[accesses[i].slot];
+        if ( list.empty() || list.back() != accesses[i].component ) {
+            list.push_back( accesses[i].component );
+        }
+    }
+
+    // edges (slot the edge came from, -1 = none)
+    vector< vector<int> > via( n, vector<int>( n, -1 ) );
+    for ( int s = 0; s < program.size(); s++ ) {
+        for ( unsigned int i = 0; i < writers[s].size(); i++ ) {
+            int w = writers[s][i];
+            for ( unsigned int j = 0; j < readers[s].size(); j++ ) {
+                int r = readers[s][j];
+                if ( r != w && via[w][r] < 0 ) {
+                    via[w][r] = s;
+                }
+            }
+            if ( i > 0 && writers[s][i-1] != w && via[writers[s][i-1]][w] < 0 ) {
+                via[writers[s][i-1]][w] = s;
+            }
+        }
+    }
+
+    // topological sort, lowest config index first
+    vector<int> indegree( n, 0 );
+    for ( int w = 0; w < n; w++ ) {
+        for ( int r = 0; r < n; r++ ) {
+            if ( via[w][r] >= 0 ) {
+                indegree[r]++;
+            }
+        }
+    }
+    vector<int> order;
+    vector<bool> placed( n, false );
+    bool acyclic = true;
+    while ( reorder && (int)order.size() < n ) {
+        int next = -1;
+        for ( int i = 0; i < n; i++ ) {
+            if ( !placed[i] && indegree[i] == 0 ) {
+                next = i;
+                break;
+            }
+        }
+        if ( next < 0 ) {
+            next = break_cycle( via, placed );
+            acyclic = false;
+        }
+        placed[next] = true;
+        order.push_back( next );
+        for ( int r = 0; r < n; r++ ) {
+            if ( via[next][r] >= 0 && !placed[r] ) {
+                indegree[r]--;
+            }
+        }
+    }
+    if ( !reorder ) {
+        for ( int i = 0; i < n; i++ ) {
+            order.push_back( i );
+        }
+    }
+
+    // consumers that were configured ahead of their producer (they
+    // used to see last frame's value)
+    vector<int> position( n );
+    for ( int i = 0; i < n; i++ ) {
+        position[order[i]] = i;
+    }
+    for ( int w = 0; w < n && reorder; w++ ) {
+        for ( int r = 0; r < w; r++ ) {
+            if ( via[w][r] >= 0 && position[w] < position[r] ) {
+                printf("AP: '%s' reads %s before its producer '%s' in the config, now runs after it\n",
+                       components[r]->get_name().c_str(),
+                       program.get_path( via[w][r] ),
+                       components[w]->get_name().c_str());
+            }
+        }
+    }
+
+    // independent chains: connected components of the graph
+    vector<int> chain_of( n, -1 );
+    int num_chains = 0;
+    for ( int i = 0; i < n; i++ ) {
+        if ( chain_of[i] >= 0 ) {
+            continue;
+        }
+        vector<int> stack( 1, i );
+        chain_of[i] = num_chains;
+        while ( !stack.empty() ) {
+            int c = stack.back();
+            stack.pop_back();
+            for ( int j = 0; j < n; j++ ) {
+                if ( chain_of[j] < 0 && (via[c][j] >= 0 || via[j][c] >= 0) ) {
+                    chain_of[j] = num_chains;
+                    stack.push_back( j );
+                }
+            }
+        }
+        num_chains++;
+    }
+
+    // biggest chains first, each to the least loaded task
+    vector<int> chain_size( num_chains, 0 );
+    for ( int i = 0; i < n; i++ ) {
+        chain_size[chain_of[i]]++;
+    }
+    vector<int> task_of( num_chains, 0 );
+    vector<int> load( tasks, 0 );
+    vector<bool> dealt( num_chains, false );
+    for ( int k = 0; k < num_chains; k++ ) {
+        int biggest = -1;
+        for ( int c = 0; c < num_chains; c++ ) {
+            if ( !dealt[c] && (biggest < 0 || chain_size[c] > chain_size[biggest]) ) {
+                biggest = c;
+            }
+        }
+        int task = 0;
+        for ( int t = 1; t < tasks; t++ ) {
+            if ( load[t] < load[task] ) {
+                task = t;
+            }
+        }
+        dealt[biggest] = true;
+        task_of[biggest] = task;
+        load[task] += chain_size[biggest];
+    }
+
+    vector<APComponent *> sorted;
+    chains.assign( tasks, vector<int>() );
+    for ( int i = 0; i < n; i++ ) {
+        sorted.push_back( components[order[i]] );
+        chains[task_of[chain_of[order[i]]]].push_back( i );
+    }
+    components = sorted;
+
+    printf("AP: run order (%d independent chain(s)):\n", num_chains);
+    for ( int i = 0; i < n; i++ ) {
+        printf("  %d: %s\n", chain_of[order[i]],
+               components[i]->get_name().c_str());
+    }
+
+    return acyclic;
+}
+
+
+// Pick the stage to run first when every unplaced stage still waits
+// on a producer: the first stage in config order that is on a cycle
+// which nothing outside the cycle feeds.  Its remaining producers are
+// reported, those inputs lag one frame.
+int AuraAutopilot::break_cycle( const vector< vector<int> > &via,
+                                const vector<bool> &placed ) {
+    int n = components.size();
+    // reach[i][j]: j reachable from i through unplaced stages
+    vector< vector<bool> > reach( n, vector<bool>( n, false ) );
+    for ( int i = 0; i < n; i++ ) {
+        for ( int j = 0; j < n; j++ ) {
+            reach[i][j] = !placed[i] && !placed[j] && via[i][j] >= 0;
+        }
+    }
+    for ( int k = 0; k < n; k++ ) {
+        for ( int i = 0; i < n; i++ ) {
+            for ( int j = 0; j < n; j++ ) {
+                if ( reach[i][k] && reach[k][j] ) {
+                    reach[i][j] = true;
+                }
+            }
+        }
+    }
+    int pick = -1;
+    for ( int i = 0; i < n && pick < 0; i++ ) {
+        if ( placed[i] || !reach[i][i] ) {
+            continue;
+        }
+        bool fed_from_outside = false;
+        for ( int p = 0; p < n; p++ ) {
+            if ( !placed[p] && via[p][i] >= 0 && !reach[i][p] ) {
+                fed_from_outside = true;
+            }
+        }
+        if ( !fed_from_outside ) {
+            pick = i;
+        }
+    }
+    for ( int p = 0; p < n; p++ ) {
+        if ( !placed[p] && via[p][pick] >= 0 ) {
+            printf("AP: WARNING: dependency cycle, '%s' reads %s from '%s' one frame late\n",
+                   components[pick]->get_name().c_str(),
+                   program.get_path( via[p][pick] ),
+                   components[p]->get_name().c_str());
+        }
+    }
+    return pick;
+}
+
+
 // normalize a value to lie between min and max
 template <class T>
 inline void SG_NORMALIZE_RANGE( T &val, const T min, const T max ) {
@@ -131,9 +410,44 @@ inline void SG_NORMALIZE_RANGE( T &val, const T min, const T max ) {
  * Update the list of autopilot components
  */
 
+void AuraAutopilot::run_chain( int task ) {
+    vector<int> &chain = chains[task];
+    if ( profile != NULL && profile->enabled ) {
+        int64_t start = ap_profile_t::now();
+        for ( unsigned int i = 0; i < chain.size(); ++i ) {
+            components[chain[i]]->update( frame_dt );
+            int64_t end = ap_profile_t::now();
+            profile->record( first_stage + chain[i], start, end );
+            start = end;
+        }
+    } else {
+        for ( unsigned int i = 0; i < chain.size(); ++i ) {
+            components[chain[i]]->update( frame_dt );
+        }
+    }
+}
+
 void AuraAutopilot::update( double dt ) {
-    for ( unsigned int i = 0; i < components.size(); ++i ) {
-        components[i]->update( dt );
+    frame_dt = dt;
+    if ( pool.size() > 0 ) {
+        // everything the workers read has to be in the slots first
+        program.fetch_all();
+        pool.run();
+    } else if ( profile != NULL && profile->enabled ) {
+        int64_t start = ap_profile_t::now();
+        for ( unsigned int i = 0; i < components.size(); ++i ) {
+            components[i]->update( dt );
+            int64_t end = ap_profile_t::now();
+            profile->record( first_stage + i, start, end );
+            start = end;
+        }
+    } else {
+        for ( unsigned int i = 0; i < components.size(); ++i ) {
+            components[i]->update( dt );
+        }
+    }
+    if ( compiled ) {
+        program.store();
     }
 }
 
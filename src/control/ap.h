@@ -27,6 +27,9 @@
 #include <vector>
 using std::vector;
 
+#include "ap_pool.h"
+#include "ap_profile.h"
+#include "ap_program.h"
 #include "component.h"
 
 
@@ -42,7 +45,8 @@ public:
     AuraAutopilot() {}
     ~AuraAutopilot() {}
 
-    void init();
+    // stages are timed into profile (if given)
+    void init( ap_profile_t *profile = NULL );
     void reset();
     void update( double dt );
 
@@ -52,4 +56,26 @@ private:
 
     bool serviceable;
     vector<APComponent *> components;
+
+    // property access of all components compiled into one slot
+    // table (/config/autopilot/interpreter = true: direct property
+    // access per component instead)
+    bool compiled = false;
+    ap_program_t program;
+
+    // compiled, stages run in dataflow order (producers before
+    // consumers).  Stages that share no properties form independent
+    // chains, with /config/autopilot/threads > 0 (compiled only) the
+    // chains are spread over that many pinned workers plus the
+    // caller.
+    bool schedule( int tasks, bool reorder );
+    int break_cycle( const vector< vector<int> > &via,
+                     const vector<bool> &placed );
+    vector< vector<int> > chains; // components per pool task
+    ap_pool_t pool;
+    double frame_dt = 0.0;
+
+    ap_profile_t *profile = NULL;
+    int first_stage = 0;        // profile id of components[0]
+    void run_chain( int task );
 };
@@ -0,0 +1,105 @@
+// ap_pool.cpp - pinned worker threads for independent autopilot chains
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "ap_pool.h"
+
+bool ap_pool_t::start( int count, double spin_ms,
+                       std::function<void(int)> task )
+{
+    stop();
+    if ( count > max_workers ) {
+        count = max_workers;
+    }
+    this->task = task;
+    this->spin_ms = spin_ms;
+    round = 0;
+    running = true;
+    long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+    for ( int i = 0; i < count; i++ ) {
+        worker_t &w = workers[i];
+        w.go = 0;
+        w.done = 0;
+        w.thread = std::thread( &ap_pool_t::work, this, i );
+        if ( cpus > 1 ) {
+            // leave core 0 to the main thread
+            cpu_set_t set;
+            CPU_ZERO( &set );
+            CPU_SET( 1 + i % (cpus - 1), &set );
+            if ( pthread_setaffinity_np( w.thread.native_handle(),
+                                         sizeof(set), &set ) != 0 ) {
+                printf("ap_pool: unable to pin worker %d\n", i + 1);
+            }
+        }
+    }
+    num_workers = count;
+    return true;
+}
+
+void ap_pool_t::stop() {
+    if ( !running ) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        running = false;
+    }
+    cv.notify_all();
+    for ( int i = 0; i < num_workers; i++ ) {
+        if ( workers[i].thread.joinable() ) {
+            workers[i].thread.join();
+        }
+    }
+    num_workers = 0;
+}
+
+void ap_pool_t::run() {
+    round++;
+    for ( int i = 0; i < num_workers; i++ ) {
+        workers[i].go.store( round );
+    }
+    if ( sleeping.load() > 0 ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        cv.notify_all();
+    }
+    task( 0 );
+    for ( int i = 0; i < num_workers; i++ ) {
+        while ( workers[i].done.load( std::memory_order_acquire ) != round ) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ap_pool_t::work( int index ) {
+    worker_t &w = workers[index];
+    uint32_t seen = 0;
+    while ( true ) {
+        auto spin_start = std::chrono::steady_clock::now();
+        while ( w.go.load() == seen && running ) {
+            std::chrono::duration<double, std::milli> spun
+                = std::chrono::steady_clock::now() - spin_start;
+            if ( spun.count() < spin_ms ) {
+                std::this_thread::yield();
+                continue;
+            }
+            // go is stored before sleeping is checked in run(), and
+            // sleeping is raised before go is checked here, so one
+            // side always sees the other
+            std::unique_lock<std::mutex> lock( mutex );
+            sleeping++;
+            cv.wait( lock, [&] { return w.go.load() != seen || !running; } );
+            sleeping--;
+        }
+        if ( !running ) {
+            return;
+        }
+        seen = w.go.load();
+        task( index + 1 );
+        w.done.store( seen, std::memory_order_release );
+    }
+}
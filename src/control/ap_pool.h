@@ -0,0 +1,58 @@
+// ap_pool.h - pinned worker threads for independent autopilot chains
+//
+// Each worker is pinned to its own core and owns a fixed task index.
+// run() releases every worker for one round, runs task 0 on the
+// calling thread and returns when all of them are done.  Between
+// rounds a worker spins for spin_ms and then blocks: spinning across
+// the frame period keeps the hand off to a few microseconds at the
+// price of a busy core, a blocked worker takes a wake up.  Tasks must
+// not touch the property tree or anything else python: the caller
+// keeps the GIL.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class ap_pool_t {
+
+public:
+
+    static const int max_workers = 7;
+
+    ap_pool_t() {}
+    ~ap_pool_t() { stop(); }
+
+    // start count workers that run task(1) .. task(count) each
+    // round (the caller runs task(0))
+    bool start( int count, double spin_ms, std::function<void(int)> task );
+    void stop();
+    void run();
+
+    int size() { return num_workers; }
+
+private:
+
+    struct worker_t {
+        std::thread thread;
+        std::atomic<uint32_t> go{0};
+        std::atomic<uint32_t> done{0};
+    };
+    worker_t workers[max_workers];
+    int num_workers = 0;
+    uint32_t round = 0;
+    double spin_ms = 0.0;
+    std::function<void(int)> task;
+
+    std::atomic<bool> running{false};
+    std::atomic<int> sleeping{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    void work( int index );
+};
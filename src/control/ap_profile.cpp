@@ -0,0 +1,234 @@
+// ap_profile.cpp - execution time histograms for the control update
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ap_profile.h"
+
+void ap_profile_t::init() {
+    pyPropertyNode config_node = pyGetNode( "/config/autopilot", true );
+    enabled = true;
+    if ( config_node.hasChild("profile") ) {
+        enabled = config_node.getBool("profile");
+    }
+    profile_node = pyGetNode( "/autopilot/profile", true );
+    profile_node.setString( "dump", "" );
+    profile_node.setBool( "reset", false );
+    trace.resize( trace_len );
+    t0 = now();
+    next_publish = t0 + 1000000000;
+    if ( !enabled ) {
+        printf("AP: stage profiling off\n");
+    }
+    self_stage = add( "profile" );
+}
+
+ap_profile_t::~ap_profile_t() {
+    if ( writer.joinable() ) {
+        writer.join();
+    }
+}
+
+int ap_profile_t::add( const string &name, int tid ) {
+    stage_t s;
+    s.name = name;
+    s.tid = tid;
+    stages.push_back( s );
+    stage_nodes.push_back( profile_node.getChild( "stage", stages.size() - 1, true ) );
+    stage_nodes.back().setString( "name", name );
+    stage_t &added = stages.back();
+    added.count = 0;
+    memset( added.hist, 0, sizeof(added.hist) );
+    added.min = added.max = 0;
+    added.sum = 0.0;
+    added.start = added.end = 0;
+    added.ran = false;
+    return stages.size() - 1;
+}
+
+void ap_profile_t::reset() {
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+        stage_t &s = stages[i];
+        memset( s.hist, 0, sizeof(s.hist) );
+        s.count = 0;
+        s.min = s.max = 0;
+        s.sum = 0.0;
+    }
+}
+
+void ap_profile_t::end_frame() {
+    if ( !enabled ) {
+        return;
+    }
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+        stage_t &s = stages[i];
+        if ( s.ran ) {
+            trace[trace_head] = { (int)i, s.start, s.end };
+            trace_head++;
+            if ( trace_head >= trace.size() ) {
+                trace_head = 0;
+                trace_full = true;
+            }
+            s.ran = false;
+        }
+    }
+
+    int64_t t = now();
+    if ( t >= next_publish ) {
+        next_publish = t + 1000000000;
+        publish();
+        string file = profile_node.getString("dump");
+        if ( file != "" ) {
+            profile_node.setString( "dump", "" );
+            if ( writing ) {
+                printf("AP: profile trace still being written, %s skipped\n",
+                       file.c_str());
+            } else {
+                if ( writer.joinable() ) {
+                    writer.join();
+                }
+                snapshot_t *snap = snapshot();
+                writing = true;
+                writer = std::thread( [this, snap, file]() {
+                        write_trace( snap, file );
+                        delete snap;
+                        writing = false;
+                    } );
+            }
+        }
+        if ( profile_node.getBool("reset") ) {
+            reset();
+            profile_node.setBool( "reset", false );
+        }
+        record( self_stage, t, now() );
+    }
+}
+
+int64_t ap_profile_t::bucket_top( int b ) {
+    if ( b <= 0 ) {
+        return 1LL << octave_min;
+    }
+    int octave = (b - 1) / 4 + octave_min;
+    int quarter = (b - 1) % 4;
+    return (int64_t)(5 + quarter) << (octave - 2);
+}
+
+// upper edge of the bucket holding the p quantile (no more than the
+// exact max)
+int64_t ap_profile_t::percentile( const uint32_t *hist, uint64_t count,
+                                  int64_t max, double p ) {
+    if ( count == 0 ) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(p * count + 0.5);
+    if ( target < 1 ) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for ( int b = 0; b < num_buckets - 1; b++ ) {
+        seen += hist[b];
+        if ( seen >= target ) {
+            int64_t top = bucket_top( b );
+            return top < max ? top : max;
+        }
+    }
+    return max;
+}
+
+void ap_profile_t::publish() {
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+        stage_t &s = stages[i];
+        pyPropertyNode &node = stage_nodes[i];
+        node.setLong( "count", s.count );
+        node.setDouble( "min_us", s.min / 1000.0 );
+        node.setDouble( "mean_us", s.count ? s.sum / s.count / 1000.0 : 0.0 );
+        node.setDouble( "p99_us", percentile( s.hist, s.count, s.max, 0.99 ) / 1000.0 );
+        node.setDouble( "max_us", s.max / 1000.0 );
+    }
+}
+
+ap_profile_t::snapshot_t *ap_profile_t::snapshot() {
+    snapshot_t *snap = new snapshot_t;
+    snap->stages = stages;
+    unsigned int len = trace_full ? trace.size() : trace_head;
+    unsigned int first = trace_full ? trace_head : 0;
+    snap->spans.reserve( len );
+    for ( unsigned int k = 0; k < len; k++ ) {
+        snap->spans.push_back( trace[(first + k) % trace.size()] );
+    }
+    snap->t0 = t0;
+    return snap;
+}
+
+bool ap_profile_t::dump( const string &file ) {
+    snapshot_t *snap = snapshot();
+    bool result = write_trace( snap, file );
+    delete snap;
+    return result;
+}
+
+// stage names as json strings
+static void write_json_string( FILE *fp, const string &str ) {
+    fputc( '"', fp );
+    for ( unsigned int i = 0; i < str.length(); i++ ) {
+        unsigned char c = str[i];
+        if ( c == '"' || c == '\\' ) {
+            fprintf( fp, "\\%c", c );
+        } else if ( c < 0x20 ) {
+            fprintf( fp, "\\u%04x", c );
+        } else {
+            fputc( c, fp );
+        }
+    }
+    fputc( '"', fp );
+}
+
+// chrome trace event format: one complete ("X") event per span,
+// times in microseconds since init()
+bool ap_profile_t::write_trace( const snapshot_t *snap, const string &file ) {
+    FILE *fp = fopen( file.c_str(), "w" );
+    if ( fp == NULL ) {
+        printf("AP: cannot write profile trace: %s\n", file.c_str());
+        return false;
+    }
+    const vector<stage_t> &stages = snap->stages;
+    fprintf( fp, "{\"traceEvents\":[\n" );
+    fprintf( fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"control\"}}" );
+    int max_tid = 0;
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+        if ( stages[i].tid > max_tid ) {
+            max_tid = stages[i].tid;
+        }
+    }
+    for ( int t = 1; t <= max_tid; t++ ) {
+        fprintf( fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"ap worker %d\"}}", t, t );
+    }
+    for ( unsigned int k = 0; k < snap->spans.size(); k++ ) {
+        const span_t &sp = snap->spans[k];
+        const stage_t &s = stages[sp.id];
+        fprintf( fp, ",\n{\"name\":" );
+        write_json_string( fp, s.name );
+        fprintf( fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                 s.tid, (sp.start - snap->t0) / 1000.0,
+                 (sp.end - sp.start) / 1000.0 );
+    }
+    fprintf( fp, "\n],\n\"displayTimeUnit\":\"ns\",\n\"profile\":[\n" );
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+        const stage_t &s = stages[i];
+        fprintf( fp, "%s{\"name\":", i ? ",\n" : "" );
+        write_json_string( fp, s.name );
+        fprintf( fp, ",\"count\":%llu,\"min_us\":%.3f,\"mean_us\":%.3f,\"p99_us\":%.3f,\"max_us\":%.3f,\"hist\":[",
+                 (unsigned long long)s.count,
+                 s.min / 1000.0, s.count ? s.sum / s.count / 1000.0 : 0.0,
+                 percentile( s.hist, s.count, s.max, 0.99 ) / 1000.0,
+                 s.max / 1000.0 );
+        for ( int b = 0; b < num_buckets; b++ ) {
+            fprintf( fp, "%s%u", b ? "," : "", s.hist[b] );
+        }
+        fprintf( fp, "]}" );
+    }
+    fprintf( fp, "\n]}\n" );
+    fclose( fp );
+    printf("AP: wrote profile trace: %s\n", file.c_str());
+    return true;
+}
@@ -0,0 +1,162 @@
+// ap_profile.h - execution time histograms for the control update
+//
+// myprof's control_prof times the whole control update: tecs, the
+// python navigation module and every autopilot stage together.  This
+// times each of them separately.  A stage is registered once with
+// add(), then every run is recorded as a (start, end) pair of
+// CLOCK_MONOTONIC nanosecond stamps (a vdso call, no system call;
+// consecutive stages share stamps so n stages cost n+1 reads.)
+//
+// Durations go into a log spaced histogram (4 buckets per octave,
+// 64ns .. 1s, so a percentile is good to ~20%) along with the exact
+// count, min, max and sum.  Stages may be recorded from the autopilot
+// worker threads as long as each stage is only ever recorded by one
+// thread per frame; end_frame() runs on the main thread after the
+// workers are done.
+//
+// end_frame() also keeps the spans of the recent frames in a ring
+// for dump(), which writes them as a chrome trace (chrome://tracing
+// or https://ui.perfetto.dev) with the histogram summary attached.
+// Once a second the summary is published to
+//
+//   /autopilot/profile/stage[i]/{name,count,min_us,mean_us,p99_us,max_us}
+//
+// and the commands are checked: set /autopilot/profile/dump to a file
+// name to write the trace, set /autopilot/profile/reset to clear the
+// histograms.  /config/autopilot/profile = false turns it all off.
+// A dump requested that way copies the ring and the histograms and
+// writes the file from a separate thread, so the flight loop only
+// pays for the copy.  That once a second work is itself timed as the
+// "profile" stage.
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include <pyprops.h>
+
+class ap_profile_t {
+
+public:
+
+    ap_profile_t() {}
+    ~ap_profile_t();
+
+    void init();
+
+    // register a stage (tid: the thread that runs it, for the trace),
+    // returns its id
+    int add( const string &name, int tid = 0 );
+
+    static inline int64_t now() {
+        struct timespec ts;
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+
+    inline void record( int id, int64_t start, int64_t end ) {
+        if ( !enabled ) {
+            return;
+        }
+        stage_t &s = stages[id];
+        int64_t ns = end - start;
+        s.hist[bucket(ns)]++;
+        s.count++;
+        s.sum += ns;
+        if ( s.count == 1 || ns < s.min ) {
+            s.min = ns;
+        }
+        if ( ns > s.max ) {
+            s.max = ns;
+        }
+        s.start = start;
+        s.end = end;
+        s.ran = true;
+    }
+
+    // collect this frame's spans, publish and check the commands
+    void end_frame();
+
+    void reset();
+    // write the trace now (end_frame() writes a requested dump from a
+    // separate thread)
+    bool dump( const string &file );
+
+    bool enabled = false;
+
+    static const int octave_min = 6;     // 64ns
+    static const int octave_max = 30;    // 1.07s
+    static const int num_buckets = (octave_max - octave_min) * 4 + 2;
+    static const int trace_len = 8192;   // spans
+
+    // bucket 0: < 64ns, then 4 per octave, the last one: >= 1.07s
+    static inline int bucket( int64_t ns ) {
+        if ( ns < (1LL << octave_min) ) {
+            return 0;
+        }
+        int octave = 63 - __builtin_clzll( (uint64_t)ns );
+        if ( octave >= octave_max ) {
+            return num_buckets - 1;
+        }
+        int quarter = (ns >> (octave - 2)) & 3;
+        return (octave - octave_min) * 4 + quarter + 1;
+    }
+    // first duration past bucket b
+    static int64_t bucket_top( int b );
+    // upper edge of the bucket holding the p quantile (capped at max)
+    static int64_t percentile( const uint32_t *hist, uint64_t count,
+                               int64_t max, double p );
+
+private:
+
+    // plain data, copied for the dump thread
+    struct stage_t {
+        string name;
+        int tid;
+        uint32_t hist[num_buckets];
+        uint64_t count;
+        int64_t min;
+        int64_t max;
+        double sum;
+        int64_t start;          // the last run
+        int64_t end;
+        bool ran;               // since the last end_frame()
+    };
+    vector<stage_t> stages;
+    vector<pyPropertyNode> stage_nodes;
+
+    struct span_t {
+        int id;
+        int64_t start;
+        int64_t end;
+    };
+    vector<span_t> trace;
+    unsigned int trace_head = 0;
+    bool trace_full = false;
+
+    int64_t t0 = 0;
+    int64_t next_publish = 0;
+    pyPropertyNode profile_node;
+    int self_stage = -1;        // the publish / dump work
+
+    // what a dump writes, spans oldest first
+    struct snapshot_t {
+        vector<stage_t> stages;
+        vector<span_t> spans;
+        int64_t t0;
+    };
+    snapshot_t *snapshot();
+    static bool write_trace( const snapshot_t *snap, const string &file );
+    std::thread writer;
+    std::atomic<bool> writing{false};
+
+    void publish();
+};
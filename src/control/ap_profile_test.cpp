@@ -0,0 +1,113 @@
+// ap_profile_test.cpp - histogram buckets and percentiles, and the
+// trace dump (build against libpyprops, embeds python)
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <pyprops.h>
+
+#include "ap_profile.h"
+#include "util/test_check.h"
+
+static void test_buckets() {
+    // every duration lands in the bucket whose edges hold it
+    bool inside = true;
+    bool monotonic = true;
+    int last = 0;
+    for ( int64_t ns = 1; ns < 4000000000LL; ns += ns / 37 + 1 ) {
+        int b = ap_profile_t::bucket( ns );
+        if ( b < last ) {
+            monotonic = false;
+        }
+        last = b;
+        if ( b < ap_profile_t::num_buckets - 1 ) {
+            if ( ns >= ap_profile_t::bucket_top( b ) ) {
+                inside = false;
+            }
+        }
+        if ( b > 0 && ns < ap_profile_t::bucket_top( b - 1 ) ) {
+            inside = false;
+        }
+    }
+    check( inside, "durations fall inside their bucket" );
+    check( monotonic, "buckets increase with duration" );
+    check( ap_profile_t::bucket( 63 ) == 0 && ap_profile_t::bucket( 64 ) == 1,
+           "64ns is the first bucket edge" );
+    check( ap_profile_t::bucket( 1LL << 30 ) == ap_profile_t::num_buckets - 1
+           && ap_profile_t::bucket( 60000000000LL ) == ap_profile_t::num_buckets - 1,
+           "1.07s and up in the last bucket" );
+    bool narrow = true;
+    for ( int b = 2; b < ap_profile_t::num_buckets - 1; b++ ) {
+        double ratio = (double)ap_profile_t::bucket_top( b )
+            / ap_profile_t::bucket_top( b - 1 );
+        if ( ratio > 1.25 + 1e-9 ) {
+            narrow = false;
+        }
+    }
+    check( narrow, "buckets no wider than 25%" );
+}
+
+static void test_percentiles() {
+    uint32_t hist[ap_profile_t::num_buckets] = { 0 };
+    check( ap_profile_t::percentile( hist, 0, 0, 0.99 ) == 0, "empty histogram" );
+
+    // 990 runs of 1us and 10 of 1ms
+    hist[ap_profile_t::bucket( 1000 )] = 990;
+    hist[ap_profile_t::bucket( 1000000 )] = 10;
+    int64_t p50 = ap_profile_t::percentile( hist, 1000, 1000000, 0.5 );
+    int64_t p99 = ap_profile_t::percentile( hist, 1000, 1000000, 0.99 );
+    int64_t p999 = ap_profile_t::percentile( hist, 1000, 1000000, 0.999 );
+    int64_t p100 = ap_profile_t::percentile( hist, 1000, 1000000, 1.0 );
+    check( p50 > 1000 && p50 <= 1250 && p99 == p50, "p50 and p99 at the 1us bucket" );
+    check( p999 == 1000000 && p100 == 1000000, "tail capped at the exact max" );
+}
+
+static void test_dump() {
+    unlink( "/tmp/ap_profile_test2.json" );
+    {
+        ap_profile_t prof;
+        prof.init();
+        int a = prof.add( "say \"hi\"\\path" );
+        int b = prof.add( "tab\there", 1 );
+        for ( int i = 0; i < 100; i++ ) {
+            int64_t t = ap_profile_t::now();
+            prof.record( a, t, t + 1000 );
+            prof.record( b, t + 1000, t + 3000 );
+            prof.end_frame();
+        }
+        check( prof.dump( "/tmp/ap_profile_test.json" ), "dump" );
+        int r = PyRun_SimpleString(
+            "import json\n"
+            "d = json.load(open('/tmp/ap_profile_test.json'))\n"
+            "names = [p['name'] for p in d['profile']]\n"
+            "assert names[1] == 'say \"hi\"\\\\path' and names[2] == 'tab\\there', names\n"
+            "assert d['profile'][1]['count'] == 100\n"
+            "assert len([e for e in d['traceEvents'] if e['ph'] == 'X']) == 200\n" );
+        check( r == 0, "trace is valid json with the names intact" );
+
+        // requested through the property tree the file is written in
+        // the background at the next once a second check (the
+        // destructor waits for it)
+        pyGetNode( "/autopilot/profile", true )
+            .setString( "dump", "/tmp/ap_profile_test2.json" );
+        usleep( 1100000 );
+        prof.end_frame();
+    }
+    int r = PyRun_SimpleString(
+        "import json\n"
+        "d = json.load(open('/tmp/ap_profile_test2.json'))\n"
+        "assert [p['name'] for p in d['profile']][0] == 'profile'\n"
+        "assert d['profile'][1]['count'] == 100\n" );
+    check( r == 0, "requested dump written in the background" );
+}
+
+int main() {
+    Py_Initialize();
+    pyPropsInit();
+
+    test_buckets();
+    test_percentiles();
+    test_dump();
+
+    return check_summary();
+}
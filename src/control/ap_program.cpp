@@ -0,0 +1,125 @@
+// ap_program.cpp - compiled property access for the autopilot components
+
+#include <assert.h>
+
+#include <thread>
+
+#include "ap_program.h"
+
+// the thread allowed to fetch (set by finalize())
+#ifndef NDEBUG
+static std::thread::id owner;
+#endif
+
+template <class T>
+static bool same_property( const ap_binding_t &b, const prop_handle_t<T> &h ) {
+    return b.dval.same( h ) || b.bval.same( h );
+}
+
+// the slot for a property (one of the handles is NULL), created on
+// first use
+int ap_program_t::find_slot( const string &path, prop_double_t *dval,
+                             prop_bool_t *bval ) {
+    int index = -1;
+    for ( unsigned int i = 0; i < bindings.size(); i++ ) {
+        if ( (dval != NULL && same_property( bindings[i], *dval ))
+             || (bval != NULL && same_property( bindings[i], *bval )) ) {
+            index = i;
+            break;
+        }
+    }
+    if ( index < 0 ) {
+        ap_binding_t b;
+        b.path = path;
+        bindings.push_back( b );
+        index = bindings.size() - 1;
+    }
+    ap_binding_t &b = bindings[index];
+    if ( dval != NULL && b.dval.isNull() ) {
+        b.dval = *dval;
+    }
+    if ( bval != NULL && b.bval.isNull() ) {
+        b.bval = *bval;
+    }
+    return index;
+}
+
+void ap_program_t::attach( ap_double_t &port, bool output ) {
+    if ( port.isNull() ) {
+        return;
+    }
+    int index = find_slot( port.path, &port.handle, NULL );
+    fixups.push_back( { &port.slot, index } );
+    accesses.push_back( { component, index, output } );
+}
+
+void ap_program_t::attach( ap_bool_t &port ) {
+    if ( port.isNull() ) {
+        return;
+    }
+    int index = find_slot( port.path, NULL, &port.handle );
+    fixups.push_back( { &port.slot, index } );
+    accesses.push_back( { component, index, false } );
+}
+
+void ap_slot_t::fetch() {
+#ifndef NDEBUG
+    assert( std::this_thread::get_id() == owner );
+#endif
+    if ( binding->dval.isNull() ) {
+        value = binding->bval.get() ? 1.0 : 0.0;
+    } else {
+        value = binding->dval.get();
+    }
+    fresh = true;
+}
+
+void ap_program_t::finalize() {
+#ifndef NDEBUG
+    owner = std::this_thread::get_id();
+#endif
+    slots.resize( bindings.size() );
+    for ( unsigned int i = 0; i < slots.size(); i++ ) {
+        slots[i].value = 0.0;
+        slots[i].fresh = false;
+        slots[i].dirty = false;
+        slots[i].binding = &bindings[i];
+    }
+    for ( unsigned int i = 0; i < fixups.size(); i++ ) {
+        *fixups[i].port_slot = &slots[fixups[i].index];
+    }
+}
+
+void ap_program_t::fetch_all() {
+    for ( unsigned int i = 0; i < slots.size(); i++ ) {
+        if ( !slots[i].fresh ) {
+            slots[i].fetch();
+        }
+    }
+}
+
+void ap_program_t::clear() {
+    for ( unsigned int i = 0; i < fixups.size(); i++ ) {
+        *fixups[i].port_slot = NULL;
+    }
+    fixups.clear();
+    bindings.clear();
+    slots.clear();
+    accesses.clear();
+    component = -1;
+}
+
+void ap_program_t::store() {
+    for ( unsigned int i = 0; i < slots.size(); i++ ) {
+        if ( slots[i].dirty ) {
+            ap_binding_t &b = bindings[i];
+            if ( b.dval.isNull() ) {
+                b.bval.set( slots[i].value != 0.0 );
+            } else {
+                b.dval.set( slots[i].value );
+            }
+            slots[i].dirty = false;
+        }
+        slots[i].fresh = false;
+    }
+}
@@ -0,0 +1,152 @@
+// ap_program.h - compiled property access for the autopilot components
+//
+// Interpreted, every component reads its enables, debug flag,
+// inputs, gains and outputs straight from the property tree each
+// frame (a python dictionary probe per value, several components
+// touching the same values.)  Compiled, each distinct property the
+// components use gets one slot in a contiguous value table.  A slot
+// is fetched from the property tree at most once per frame, on its
+// first read (a stage reading an earlier stage's output gets the slot
+// directly, gains of a disabled stage are never fetched), and only
+// the slots written during the frame are stored back at the end, so
+// python sees the same values after the autopilot update either way.
+//
+// Components hold their property references as ap_port_t's, which
+// bind like prop_handle_t's and go through the handle until the
+// program attaches them to a slot.  Slots are keyed by property, so a
+// value used as a bool by one component and as a double by another
+// shares one slot (fetched and stored as a double in that case.)  The
+// program also records which component reads and which writes each
+// slot, the dataflow graph the autopilot orders its stages by.
+//
+// Slots are fetched through python, so only the thread that owns the
+// property tree (the one that ran finalize()) may fetch; debug builds
+// check this.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+using std::vector;
+
+#include "util/props_handle.h"
+
+struct ap_binding_t;
+
+struct ap_slot_t {
+    double value;
+    bool fresh;                 // value is current for this frame
+    bool dirty;                 // written this frame
+    ap_binding_t *binding;
+    void fetch();
+};
+
+template <class T>
+class ap_port_t {
+
+public:
+
+    bool bind( pyPropertyNode &n, const char *name ) {
+        slot = NULL;
+        path = name;
+        return handle.bind( n, name );
+    }
+    bool bind( const string &prop ) {
+        slot = NULL;
+        path = prop;
+        return handle.bind( prop );
+    }
+
+    bool isNull() { return handle.isNull(); }
+    const char *get_name() { return handle.get_name(); }
+
+    inline T get() {
+        if ( slot != NULL ) {
+            if ( !slot->fresh ) {
+                slot->fetch();
+            }
+            return (T)slot->value;
+        }
+        return handle.get();
+    }
+    inline void set( T val ) {
+        if ( slot != NULL ) {
+            slot->value = val;
+            slot->fresh = true;
+            slot->dirty = true;
+        } else {
+            handle.set( val );
+        }
+    }
+
+    prop_handle_t<T> handle;
+    ap_slot_t *slot = NULL;     // NULL: interpreted
+    string path;                // for reports
+};
+
+typedef ap_port_t<double> ap_double_t;
+typedef ap_port_t<bool> ap_bool_t;
+
+struct ap_binding_t {
+    string path;
+    prop_double_t dval;         // bound if a double port uses the slot
+    prop_bool_t bval;           // bound if a bool port does (dval wins)
+};
+
+class ap_program_t {
+
+public:
+
+    ap_program_t() {}
+    ~ap_program_t() { clear(); }
+
+    // collect ports (unbound ports stay on their handle and read as
+    // 0), then finalize() allocates the slots and points the ports at
+    // them.  Ports must not move after they are attached.  Ports
+    // attached after begin_component(id) belong to component id.
+    void begin_component( int id ) { component = id; }
+    void attach( ap_double_t &port, bool output = false );
+    void attach( ap_bool_t &port );
+    void finalize();
+
+    // detach all ports (back to interpreted access)
+    void clear();
+
+    // written slots -> property tree, then mark every slot stale
+    // for the next frame
+    void store();
+
+    // fetch every slot now (workers running components must not
+    // touch python, and a stage may read back its own output, e.g. a
+    // disabled pid holding its last value)
+    void fetch_all();
+
+    int size() { return slots.size(); }
+    const char *get_path( int slot ) { return bindings[slot].path.c_str(); }
+
+    // the dataflow graph
+    struct access_t {
+        int component;
+        int slot;
+        bool output;
+    };
+    const vector<access_t> &get_accesses() { return accesses; }
+
+private:
+
+    vector<ap_slot_t> slots;
+    vector<ap_binding_t> bindings; // one per slot
+
+    // ports to point at their slot in finalize()
+    struct fixup_t {
+        ap_slot_t **port_slot;
+        int index;
+    };
+    vector<fixup_t> fixups;
+
+    int component = -1;
+    vector<access_t> accesses;
+
+    int find_slot( const string &path, prop_double_t *dval, prop_bool_t *bval );
+};
@@ -23,6 +23,8 @@
 
 #include <pyprops.h>
 
+#include "ap_program.h"
+
 #include <string>
 #include <vector>
 
@@ -38,25 +40,24 @@ class APComponent {
 protected:
 
     pyPropertyNode component_node;
+    ap_bool_t debug_handle;
     
-    vector <pyPropertyNode> enables_node;
-    vector <string> enables_attr;
+    vector <ap_bool_t> enable_handles;
 
     bool honor_passive;
     bool enabled;
 
-    pyPropertyNode input_node;
-    string input_attr;
+    ap_double_t input_handle;
     
-    pyPropertyNode ref_node;
-    string ref_attr;
+    ap_double_t ref_handle;
     string ref_value;
   
-    vector <pyPropertyNode> output_node;
-    vector <string> output_attr;
+    vector <ap_double_t> output_handles;
 
     pyPropertyNode config_node;
 
+    string name;
+
 public:
 
     APComponent() :
@@ -68,6 +69,24 @@ public:
 
     virtual void reset() = 0;
     virtual void update( double dt ) = 0;
+
+    // attach all property ports to prog (see ap_program.h),
+    // components with ports of their own extend this
+    virtual void compile( ap_program_t &prog ) {
+        prog.attach( debug_handle );
+        for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+            prog.attach( enable_handles[i] );
+        }
+        prog.attach( input_handle );
+        prog.attach( ref_handle );
+        for ( unsigned int i = 0; i < output_handles.size(); i++ ) {
+            prog.attach( output_handles[i], true );
+        }
+        name = component_node.getString("name");
+    }
     
-    inline string get_name() { return component_node.getString("name"); }
+    // (cached by compile(), no python access after that)
+    inline string get_name() {
+        return name != "" ? name : component_node.getString("name");
+    }
 };
@@ -43,8 +43,14 @@ void control_t::init() {
     navigation.init("control.navigation");
     
     // initialize and build the autopilot controller from the property
-    // tree config (/config/autopilot)
-    ap.init();
+    // tree config (/config/autopilot), the autopilot adds a profile
+    // stage per component
+    profile.init();
+    tecs_stage = profile.add("update_tecs");
+    navigation_stage = profile.add("navigation.update");
+    ap.init( &profile );
+    ap_stage = profile.add("autopilot");
+    control_stage = profile.add("control");
 
     printf("Autopilot initialized\n");
 }
@@ -83,6 +89,8 @@ void control_t::copy_pilot_inputs() {
 }
 
 void control_t::update(float dt) {
+    int64_t frame_start = ap_profile_t::now();
+
     // sanity check
     if ( dt > 1.0 ) { dt = 0.01; }
     if ( dt < 0.00001 ) { dt = 0.01; }
@@ -99,16 +107,25 @@ void control_t::update(float dt) {
     }
     
     // update tecs (total energy) values and error metrics
+    int64_t start = ap_profile_t::now();
     update_tecs();
+    int64_t end = ap_profile_t::now();
+    profile.record( tecs_stage, start, end );
 
     // navigation update (circle or route heading)
+    start = end;
     navigation.update(dt);
+    end = ap_profile_t::now();
+    profile.record( navigation_stage, start, end );
 
     // update the autopilot stages (even in manual flight mode.)  This
     // keeps the differential value up to date, tracks manual inputs,
     // and keeps more continuity in the flight when the mode is
     // switched to autopilot.
+    start = end;
     ap.update( dt );
+    end = ap_profile_t::now();
+    profile.record( ap_stage, start, end );
 
     // copy pilot inputs to flight control outputs with not in
     // autopilot mode or in a pilot_pass_through mode
@@ -116,6 +133,9 @@ void control_t::update(float dt) {
     if ( !master_switch or pass_through ) {
         copy_pilot_inputs();
     }
+
+    profile.record( control_stage, frame_start, ap_profile_t::now() );
+    profile.end_frame();
 }
 
 PYBIND11_MODULE(control_mgr, m) {
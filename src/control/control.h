@@ -4,6 +4,7 @@
 #include <pymodule.h>
 
 #include "ap.h"
+#include "ap_profile.h"
 
 class control_t {
 public:
@@ -16,6 +17,13 @@ public:
 private:
     pyModuleBase navigation;
     AuraAutopilot ap;
+
+    // per stage timing (/autopilot/profile)
+    ap_profile_t profile;
+    int tecs_stage;
+    int navigation_stage;
+    int ap_stage;
+    int control_stage;
     
     pyPropertyNode status_node;
     pyPropertyNode ap_node;
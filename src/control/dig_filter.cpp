@@ -18,17 +18,35 @@
 //
 
 
+#include <math.h>
+
 #include <pyprops.h>
 
+#include "util/butter.h"
+
 #include "dig_filter.h"
 
 
-AuraDigitalFilter::AuraDigitalFilter( string config_path )
+AuraDigitalFilter::AuraDigitalFilter( string config_path ):
+    Tf( 0.0 ),
+    samples( 1 ),
+    rateOfChange( 0.0 ),
+    filterType( exponential ),
+    output_1( 0.0 ),
+    output_2( 0.0 ),
+    head( 0 ),
+    sum( 0.0 ),
+    num_sections( 0 ),
+    order( 2 ),
+    cutoff_hz( 1.0 ),
+    center_hz( 10.0 ),
+    bandwidth_hz( 5.0 ),
+    design_dt( 0.0 ),
+    primed( false )
 {
-    size_t pos;
-    samples = 1;
 
     component_node = pyGetNode(config_path, true);
+    debug_handle.bind( component_node, "debug" );
     vector <string> children;
     
     // enable
@@ -39,13 +57,9 @@ AuraDigitalFilter::AuraDigitalFilter( string config_path )
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string enable_prop = node.getString(children[i].c_str());
             printf("  %s\n", enable_prop.c_str());
-	    pos = enable_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = enable_prop.substr(0, pos);
-		string attr = enable_prop.substr(pos+1);
-		pyPropertyNode en_node = pyGetNode( path, true );
-		enables_node.push_back( en_node );
-		enables_attr.push_back( attr );
+	    ap_bool_t en;
+	    if ( en.bind( enable_prop ) ) {
+		enable_handles.push_back( en );
 	    } else {
 		printf("WARNING: requested bad enable path: %s\n",
 		       enable_prop.c_str());
@@ -59,12 +73,7 @@ AuraDigitalFilter::AuraDigitalFilter( string config_path )
     // input
     node = component_node.getChild("input", true);
     string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	input_node = pyGetNode( path, true );
-    }
+    input_handle.bind( input_prop );
 
     if ( component_node.hasChild("type") ) {
 	string cval = component_node.getString("type");
@@ -76,6 +85,12 @@ AuraDigitalFilter::AuraDigitalFilter( string config_path )
 	    filterType = movingAverage;
 	} else if (cval == "noise-spike") {
 	    filterType = noiseSpike;
+	} else if (cval == "butterworth") {
+	    filterType = butterworth;
+	} else if (cval == "notch") {
+	    filterType = notch;
+	} else {
+	    printf("WARNING: unknown filter type: %s\n", cval.c_str());
 	}
     }
     if ( component_node.hasChild("filter_time") ) {
@@ -83,10 +98,30 @@ AuraDigitalFilter::AuraDigitalFilter( string config_path )
     }
     if ( component_node.hasChild("samples") ) {
 	samples = component_node.getLong("samples");
+	if ( samples < 1 ) {
+	    samples = 1;
+	}
     }
     if ( component_node.hasChild("max_rate_of_change") ) {
 	rateOfChange = component_node.getDouble("max_rate_of_change");
     }
+    if ( component_node.hasChild("order") ) {
+	order = component_node.getLong("order");
+	// even, up to max_sections second order sections
+	order = (order + 1) / 2 * 2;
+	if ( order < 2 ) { order = 2; }
+	if ( order > 2 * max_sections ) { order = 2 * max_sections; }
+    }
+    if ( component_node.hasChild("cutoff_hz") ) {
+	cutoff_hz = component_node.getDouble("cutoff_hz");
+    }
+    if ( component_node.hasChild("center_hz") ) {
+	center_hz = component_node.getDouble("center_hz");
+	bandwidth_hz = 0.5 * center_hz;
+    }
+    if ( component_node.hasChild("bandwidth_hz") ) {
+	bandwidth_hz = component_node.getDouble("bandwidth_hz");
+    }
 
     // output
     node = component_node.getChild( "output", true );
@@ -94,13 +129,9 @@ AuraDigitalFilter::AuraDigitalFilter( string config_path )
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
+	    ap_double_t out;
+	    if ( out.bind( output_prop ) ) {
+		output_handles.push_back( out );
 	    } else {
 		printf("WARNING: requested bad output path: %s\n",
 		       output_prop.c_str());
@@ -111,89 +142,165 @@ AuraDigitalFilter::AuraDigitalFilter( string config_path )
 	}
     }
 
-    output.resize(2, 0.0);
-    input.resize(samples + 1, 0.0);
+    window.assign( samples, 0.0 );
 }
 
 void AuraDigitalFilter::reset() {
+    primed = false;
+}
+
+// (re)compute the second order sections for sample interval dt
+void AuraDigitalFilter::design( double dt ) {
+    double fs = 1.0 / dt;
+    if ( filterType == butterworth ) {
+        double fc = cutoff_hz;
+        if ( fc > 0.45 * fs ) { fc = 0.45 * fs; }
+        num_sections = order / 2;
+        for ( int i = 0; i < num_sections; i++ ) {
+            double A, d1, d2;
+            butterworth_section( order, i, fs, fc, &A, &d1, &d2 );
+            biquad_t &s = sections[i];
+            s.b0 = A;
+            s.b1 = 2.0 * A;
+            s.b2 = A;
+            s.a1 = -d1;
+            s.a2 = -d2;
+        }
+    } else if ( filterType == notch ) {
+        // the usual band stop biquad, Q = center / bandwidth
+        double f0 = center_hz;
+        if ( f0 > 0.45 * fs ) { f0 = 0.45 * fs; }
+        double bw = bandwidth_hz > 0.0 ? bandwidth_hz : 0.5 * f0;
+        double w0 = 2.0 * M_PI * f0 / fs;
+        double alpha = sin(w0) * bw / (2.0 * f0);
+        double a0 = 1.0 + alpha;
+        biquad_t &s = sections[0];
+        s.b0 = 1.0 / a0;
+        s.b1 = -2.0 * cos(w0) / a0;
+        s.b2 = 1.0 / a0;
+        s.a1 = s.b1;
+        s.a2 = (1.0 - alpha) / a0;
+        num_sections = 1;
+    }
+    design_dt = dt;
+}
+
+// start every section in its steady state for a constant input x
+void AuraDigitalFilter::prime( double x ) {
+    for ( int i = 0; i < num_sections; i++ ) {
+        biquad_t &s = sections[i];
+        double w = x / (1.0 + s.a1 + s.a2);
+        s.w1 = w;
+        s.w2 = w;
+        x = (s.b0 + s.b1 + s.b2) * w;
+    }
+    primed = true;
+}
+
+double AuraDigitalFilter::run_sections( double x ) {
+    for ( int i = 0; i < num_sections; i++ ) {
+        biquad_t &s = sections[i];
+        double w = x - s.a1 * s.w1 - s.a2 * s.w2;
+        x = s.b0 * w + s.b1 * s.w1 + s.b2 * s.w2;
+        s.w2 = s.w1;
+        s.w1 = w;
+    }
+    return x;
 }
 
 void AuraDigitalFilter::update(double dt)
 {
     // test if all of the provided enable flags are true
     enabled = true;
-    for ( unsigned int i = 0; i < enables_node.size(); i++ ) {
-        if ( !enables_node[i].getBool(enables_attr[i].c_str()) ) {
+    for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+        if ( !enable_handles[i].get() ) {
             enabled = false;
             break;
         }
     }
 
-    input.push_front( input_node.getDouble(input_attr.c_str()) );
-    input.resize(samples + 1, 0.0);
+    double in = input_handle.get();
+
+    // the moving average window keeps sliding while disabled (as the
+    // input history always did)
+    if ( filterType == movingAverage ) {
+        sum += in - window[head];
+        window[head] = in;
+        head++;
+        if ( head >= samples ) {
+            // refresh the running sum once per window so round off
+            // can't creep in
+            head = 0;
+            sum = 0.0;
+            for ( unsigned int i = 0; i < samples; i++ ) {
+                sum += window[i];
+            }
+        }
+    }
 
     if ( enabled && dt > 0.0 ) {
-        /*
-         * Exponential filter
-         *
-         * Output[n] = alpha*Input[n] + (1-alpha)*Output[n-1]
-         *
-         */
+        double out = output_1;
 
         if (filterType == exponential)
         {
+            /*
+             * Exponential filter
+             *
+             * Output[n] = alpha*Input[n] + (1-alpha)*Output[n-1]
+             *
+             */
             double alpha = 1 / ((Tf/dt) + 1);
-            output.push_front(alpha * input[0] + 
-                              (1 - alpha) * output[0]);
-	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-            output.resize(1);
+            out = alpha * in + (1 - alpha) * output_1;
         } 
         else if (filterType == doubleExponential)
         {
             double alpha = 1 / ((Tf/dt) + 1);
-            output.push_front(alpha * alpha * input[0] + 
-                              2 * (1 - alpha) * output[0] -
-                              (1 - alpha) * (1 - alpha) * output[1]);
- 	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-            output.resize(2);
+            out = alpha * alpha * in +
+                2 * (1 - alpha) * output_1 -
+                (1 - alpha) * (1 - alpha) * output_2;
         }
         else if (filterType == movingAverage)
         {
-            output.push_front(output[0] + 
-                              (input[0] - input.back()) / samples);
- 	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-            output.resize(1);
+            out = sum / samples;
         }
         else if (filterType == noiseSpike)
         {
             double maxChange = rateOfChange * dt;
 
-            if ((output[0] - input[0]) > maxChange)
+            if ((output_1 - in) > maxChange)
             {
-                output.push_front(output[0] - maxChange);
+                out = output_1 - maxChange;
             }
-            else if ((output[0] - input[0]) < -maxChange)
+            else if ((output_1 - in) < -maxChange)
             {
-                output.push_front(output[0] + maxChange);
+                out = output_1 + maxChange;
             }
-            else if (fabs(input[0] - output[0]) <= maxChange)
+            else if (fabs(in - output_1) <= maxChange)
             {
-                output.push_front(input[0]);
+                out = in;
+            }
+        }
+        else if (filterType == butterworth || filterType == notch)
+        {
+            if ( fabs(dt - design_dt) > 0.01 * design_dt ) {
+                design( dt );
+            }
+            if ( !primed ) {
+                prime( in );
             }
+            out = run_sections( in );
+        }
 
- 	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-	    output.resize(1);
+        output_2 = output_1;
+        output_1 = out;
+        for ( unsigned int i = 0; i < output_handles.size(); i++ ) {
+            output_handles[i].set( out );
         }
-        if ( component_node.getBool("debug") ) {
-            printf("input: %.3f\toutput: %.3f\n", input[0], output[0]);
+        if ( debug_handle.get() ) {
+            printf("input: %.3f\toutput: %.3f\n", in, out);
         }
+    } else {
+        // restart the sections from steady state when enabled
+        primed = false;
     }
 }
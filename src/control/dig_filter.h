@@ -20,10 +20,10 @@
 #pragma once
 
 #include <string>
-#include <deque>
+#include <vector>
 
 using std::string;
-using std::deque;
+using std::vector;
 
 #include "component.h"
 
@@ -35,8 +35,16 @@ using std::deque;
  * Double exponential filter
  * Moving average filter
  * Noise spike filter
+ * Butterworth low pass (cascade of second order sections)
+ * Notch (second order band stop)
  *
- * All these filters are low-pass filters.
+ * All but the notch are low-pass filters.  All state is sized at
+ * construction, an update does no allocation: the moving average
+ * keeps a ring buffer of its window with a running sum.  The second
+ * order section filters are designed for the current dt (redesigned
+ * when dt moves by more than 1%) and start from their steady state
+ * for the current input when enabled, so engaging them causes no
+ * transient.
  *
  */
 
@@ -46,11 +54,38 @@ private:
     double Tf;            // Filter time [s]
     unsigned int samples; // Number of input samples to average
     double rateOfChange;  // The maximum allowable rate of change [1/s]
-    deque <double> output;
-    deque <double> input;
-    enum filterTypes { exponential, doubleExponential, movingAverage, noiseSpike };
+    enum filterTypes { exponential, doubleExponential, movingAverage,
+                       noiseSpike, butterworth, notch };
     filterTypes filterType;
 
+    // previous outputs
+    double output_1, output_2;
+
+    // moving average window
+    vector <double> window;
+    unsigned int head;    // oldest sample
+    double sum;
+
+    // butterworth / notch: second order sections, direct form II
+    // (w = x - a1*w1 - a2*w2, y = b0*w + b1*w1 + b2*w2)
+    struct biquad_t {
+        double b0, b1, b2, a1, a2;
+        double w1, w2;
+    };
+    static const int max_sections = 4;
+    biquad_t sections[max_sections];
+    int num_sections;
+    int order;            // butterworth order (even)
+    double cutoff_hz;     // butterworth cutoff
+    double center_hz;     // notch center
+    double bandwidth_hz;  // notch -3db width
+    double design_dt;     // dt the sections were designed for
+    bool primed;          // sections hold state for the current input
+
+    void design( double dt );
+    void prime( double x );
+    double run_sections( double x );
+
     bool debug;
 
 public:
@@ -0,0 +1,121 @@
+// dig_filter_test.cpp - frequency response of the butterworth and
+// notch filter stages, measured by running sine waves through them
+// (build against libpyprops, embeds python)
+
+#include <math.h>
+#include <stdio.h>
+
+#include <pyprops.h>
+
+#include "dig_filter.h"
+#include "util/test_check.h"
+
+static const double fs = 200.0;
+static const double dt = 1.0 / fs;
+
+static pyPropertyNode io;
+
+// configure /config/autopilot/<name> as a filter stage
+static AuraDigitalFilter *make_filter( const char *name, const char *type ) {
+    string path = string("/config/autopilot/") + name;
+    pyPropertyNode n = pyGetNode( path, true );
+    n.setString( "name", name );
+    n.setString( "type", type );
+    pyPropertyNode in = n.getChild( "input", true );
+    in.setString( "prop", "/test/filter/in" );
+    pyPropertyNode out = n.getChild( "output", true );
+    out.setString( "prop", "/test/filter/out" );
+    return new AuraDigitalFilter( path );
+}
+
+// steady state gain at f (hz): settle, then fit a sine over a whole
+// number of periods
+static double gain( AuraDigitalFilter *f, double hz ) {
+    f->reset();
+    int settle = (int)(3.0 * fs);
+    int periods = (int)(2.0 * hz);
+    if ( periods < 1 ) {
+        periods = 1;
+    }
+    int n = (int)(periods * fs / hz + 0.5);
+    double s = 0.0, c = 0.0;
+    for ( int i = 0; i < settle + n; i++ ) {
+        double w = 2.0 * M_PI * hz * i * dt;
+        io.setDouble( "in", sin( w ) );
+        f->update( dt );
+        if ( i >= settle ) {
+            double y = io.getDouble( "out" );
+            s += y * sin( w );
+            c += y * cos( w );
+        }
+    }
+    return 2.0 * sqrt( s * s + c * c ) / n;
+}
+
+// frequency between lo and hi where the gain crosses target (gain
+// rising with frequency when rising is set)
+static double crossing( AuraDigitalFilter *f, double lo, double hi,
+                        double target, bool rising ) {
+    for ( int i = 0; i < 20; i++ ) {
+        double mid = 0.5 * (lo + hi);
+        if ( (gain( f, mid ) < target) == rising ) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+int main() {
+    Py_Initialize();
+    pyPropsInit();
+    io = pyGetNode( "/test/filter", true );
+    const double half_power = sqrt( 0.5 );
+
+    // butterworth: unity dc gain and -3db at the cutoff
+    const int orders[] = { 2, 4, 8 };
+    for ( int k = 0; k < 3; k++ ) {
+        char name[64];
+        snprintf( name, sizeof(name), "butter%d", orders[k] );
+        pyPropertyNode n = pyGetNode( string("/config/autopilot/") + name, true );
+        n.setLong( "order", orders[k] );
+        n.setDouble( "cutoff_hz", 10.0 );
+        AuraDigitalFilter *f = make_filter( name, "butterworth" );
+
+        io.setDouble( "in", 0.0 );
+        f->update( dt );
+        io.setDouble( "in", 1.0 );
+        for ( int i = 0; i < 2 * (int)fs; i++ ) {
+            f->update( dt );
+        }
+        char what[128];
+        snprintf( what, sizeof(what), "order %d dc gain 1", orders[k] );
+        check( fabs( io.getDouble( "out" ) - 1.0 ) < 1e-6, what );
+        double g = gain( f, 10.0 );
+        snprintf( what, sizeof(what), "order %d -3db at the cutoff (%.4f)",
+                  orders[k], g );
+        check( fabs( g - half_power ) < 0.01, what );
+        snprintf( what, sizeof(what), "order %d stop band", orders[k] );
+        check( gain( f, 40.0 ) < pow( 0.25, orders[k] ) * 1.5, what );
+        delete f;
+    }
+
+    // notch: -3db edges bandwidth_hz apart around the center (the
+    // Q = center / bandwidth design narrows slightly as the center
+    // nears nyquist)
+    pyPropertyNode n = pyGetNode( "/config/autopilot/notch", true );
+    n.setDouble( "center_hz", 10.0 );
+    n.setDouble( "bandwidth_hz", 4.0 );
+    AuraDigitalFilter *f = make_filter( "notch", "notch" );
+    check( gain( f, 10.0 ) < 0.01, "notch center rejected" );
+    check( gain( f, 1.0 ) > 0.99 && gain( f, 50.0 ) > 0.99, "notch pass band" );
+    double lo = crossing( f, 2.0, 10.0, half_power, false );
+    double hi = crossing( f, 10.0, 40.0, half_power, true );
+    char what[128];
+    snprintf( what, sizeof(what), "notch -3db edges %.2f .. %.2f hz", lo, hi );
+    check( fabs( (hi - lo) - 4.0 ) < 0.2 && lo < 10.0 && hi > 10.0, what );
+    delete f;
+
+    return check_summary();
+}
@@ -19,8 +19,12 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 //
 
+#include <math.h>
+
 #include <iostream>
 
+#include <eigen3/Eigen/LU>
+
 #include <pyprops.h>
 
 #include "dtss.h"
@@ -30,12 +34,14 @@ AuraDTSS::AuraDTSS( string config_path ):
     nx(1),
     nz(1),
     nu(1),
-    do_reset(true)
+    do_reset(true),
+    cached_dt(0.0),
+    dt_tolerance(0.01)
 {
-    size_t pos;
     unsigned int len;
     
     component_node = pyGetNode(config_path, true);
+    debug_handle.bind( component_node, "debug" );
     vector <string> children;
 
     // enable
@@ -46,13 +52,9 @@ AuraDTSS::AuraDTSS( string config_path ):
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string enable_prop = node.getString(children[i].c_str());
             printf("  %s\n", enable_prop.c_str());
-	    pos = enable_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = enable_prop.substr(0, pos);
-		string attr = enable_prop.substr(pos+1);
-		pyPropertyNode en_node = pyGetNode( path, true );
-		enables_node.push_back( en_node );
-		enables_attr.push_back( attr );
+	    ap_bool_t en;
+	    if ( en.bind( enable_prop ) ) {
+		enable_handles.push_back( en );
 	    } else {
 		printf("WARNING: requested bad enable path: %s\n",
 		       enable_prop.c_str());
@@ -72,13 +74,9 @@ AuraDTSS::AuraDTSS( string config_path ):
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string input_prop = node.getString(children[i].c_str());
             printf("  %s\n", input_prop.c_str());
-	    pos = input_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = input_prop.substr(0, pos);
-		string attr = input_prop.substr(pos+1);
-		pyPropertyNode inode = pyGetNode( path, true );
-		inputs_node.push_back( inode );
-		inputs_attr.push_back( attr );
+	    ap_double_t in;
+	    if ( in.bind( input_prop ) ) {
+		input_handles.push_back( in );
 	    } else {
 		printf("WARNING: requested bad input path: %s\n",
 		       input_prop.c_str());
@@ -108,17 +106,13 @@ AuraDTSS::AuraDTSS( string config_path ):
     for ( unsigned int i = 0; i < nu; ++i ) {
         pyPropertyNode child = component_node.getChild( "outputs", i, true );
         string output_prop = child.getString("prop");        
-        pos = output_prop.rfind("/");
         double min = child.getDouble("u_min");  
         double max = child.getDouble("u_max");
         double trim = child.getDouble("u_trim");
         printf("  %s [%.2f, %.2f]\n", output_prop.c_str(), min, max);
-        if ( pos != string::npos ) {
-            string path = output_prop.substr(0, pos);
-            string attr = output_prop.substr(pos+1);
-            pyPropertyNode onode = pyGetNode( path, true );
-            outputs_node.push_back( onode );
-            outputs_attr.push_back( attr );
+        ap_double_t out;
+        if ( out.bind( output_prop ) ) {
+            output_handles.push_back( out );
             u_min.push_back( min );
             u_max.push_back( max );
             u_trim.push_back( trim );
@@ -191,14 +185,87 @@ AuraDTSS::AuraDTSS( string config_path ):
     u.setZero();
 
     // allocate internally used matrices
+    dz = VectorXd(nz);
+    x_next = VectorXd(nx);
     M = MatrixXd(nx + nz, nx + nz);
-    S = MatrixXd(nx + nz, nx + nz);
-    T = MatrixXd(nx + nz, nx + nz);
     F = MatrixXd(nx, nx);
     G = MatrixXd(nx, nz);
 
     // config
     config_node = component_node.getChild( "config", true );
+    if ( config_node.hasChild("dt_tolerance") ) {
+        dt_tolerance = config_node.getDouble("dt_tolerance");
+    }
+}
+
+
+// matrix exponential, Pade(6,6) approximation with scaling and
+// squaring (Golub & Van Loan, Algorithm 11.3.1).  Templated so small
+// systems run on fixed size matrices.
+template <typename Mat>
+static void expm( const Mat &M, Mat &E ) {
+    double norm = M.cwiseAbs().rowwise().sum().maxCoeff();
+    int s = 0;
+    if ( norm > 0.5 ) {
+        s = (int)ceil( log2( norm / 0.5 ) );
+    }
+    Mat A = M / pow( 2.0, s );
+
+    const int q = 6;
+    double c = 0.5;
+    Mat X = A;
+    Mat N = Mat::Identity( M.rows(), M.cols() ) + c * A;
+    Mat D = Mat::Identity( M.rows(), M.cols() ) - c * A;
+    bool positive = true;
+    for ( int k = 2; k <= q; k++ ) {
+        c = c * (q - k + 1) / (k * (2 * q - k + 1));
+        X = A * X;
+        N += c * X;
+        if ( positive ) {
+            D += c * X;
+        } else {
+            D -= c * X;
+        }
+        positive = !positive;
+    }
+    E = D.partialPivLu().solve( N );
+    for ( int k = 0; k < s; k++ ) {
+        E = E * E;
+    }
+}
+
+// exp([A B; 0 0] * dt) = [F G; 0 I].  A fixed size M larger than the
+// system is zero padded, which only appends identity to the result.
+template <typename Mat>
+static void discretize_with( Mat &M, const MatrixXd &A, const MatrixXd &B,
+                             double dt, MatrixXd &F, MatrixXd &G )
+{
+    unsigned int nx = A.rows();
+    unsigned int nz = B.cols();
+    M.setZero();
+    M.topLeftCorner(nx, nx) = A * dt;
+    M.block(0, nx, nx, nz) = B * dt;
+    Mat S;
+    expm( M, S );
+    F = S.topLeftCorner(nx, nx);
+    G = S.block(0, nx, nx, nz);
+}
+
+void AuraDTSS::discretize( double dt ) {
+    unsigned int n = nx + nz;
+    if ( n <= 4 ) {
+        Matrix<double, 4, 4> M4;
+        discretize_with( M4, A, B, dt, F, G );
+    } else if ( n <= 8 ) {
+        Matrix<double, 8, 8> M8;
+        discretize_with( M8, A, B, dt, F, G );
+    } else if ( n <= 16 ) {
+        Matrix<double, 16, 16> M16;
+        discretize_with( M16, A, B, dt, F, G );
+    } else {
+        discretize_with( M, A, B, dt, F, G );
+    }
+    cached_dt = dt;
 }
 
 
@@ -207,52 +274,49 @@ void AuraDTSS::reset() {
 }
 
 
+void AuraDTSS::compile( ap_program_t &prog ) {
+    APComponent::compile( prog );
+    for ( unsigned int i = 0; i < input_handles.size(); i++ ) {
+        prog.attach( input_handles[i] );
+    }
+}
+
+
 void AuraDTSS::update( double dt ) {
     // test if all of the provided enable flags are true
     enabled = true;
-    for ( unsigned int i = 0; i < enables_node.size(); i++ ) {
-        if ( !enables_node[i].getBool(enables_attr[i].c_str()) ) {
+    for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+        if ( !enable_handles[i].get() ) {
             enabled = false;
             break;
         }
     }
 
-    bool debug = component_node.getBool("debug");
+    bool debug = debug_handle.get();
     if ( debug ) printf("Updating %s\n", get_name().c_str());
 
-    // construct the M matrix
-    M.topLeftCorner(nx,nx) = A * dt;
-    M.topRightCorner(nx,nz) = B * dt;
-    M.bottomRows(nz).setZero();
-
-    // compute the S matrix = I + M + M^2/2 + M^3/6
-    S.setIdentity();
-    T = M;                      // M
-    S += T;
-    T *= M;                     // M^2
-    S += T / 2.0;
-    T *= M;                     // M^3
-    S += T / 6.0;
-
-    // extract the F & G matrices
-    F = S.topLeftCorner(nx, nx);
-    G = S.topRightCorner(nx, nz);
+    // discretize (F & G), only when dt has moved
+    if ( dt > 0.0 && fabs(dt - cached_dt) > dt_tolerance * cached_dt ) {
+        discretize( dt );
+        if ( debug ) printf("  discretized for dt = %.4f\n", dt);
+    }
 
-    // update states
+    // update states (no allocation in here)
     if ( do_reset ) {
         do_reset = false;
         x.setZero();
-        for ( unsigned int i = 0; i < nz; ++i ) {
-            z(i) = inputs_node[i].getDouble(inputs_attr[i].c_str());
-        }
-        u = C*x + D*(z - z_trim);
-    } else {
-        x = F*x + G*(z - z_trim);
-        for ( unsigned int i = 0; i < nz; ++i ) {
-            z(i) = inputs_node[i].getDouble(inputs_attr[i].c_str());
-        }
-        u = C*x + D*(z - z_trim);
+    } else if ( cached_dt > 0.0 ) {
+        dz = z - z_trim;
+        x_next.noalias() = F * x;
+        x_next.noalias() += G * dz;
+        x.swap( x_next );
+    }
+    for ( unsigned int i = 0; i < nz; ++i ) {
+        z(i) = input_handles[i].get();
     }
+    dz = z - z_trim;
+    u.noalias() = C * x;
+    u.noalias() += D * dz;
 
     if ( debug ) {
         std::cout << "z: " << z << std::endl;
@@ -268,7 +332,7 @@ void AuraDTSS::update( double dt ) {
             double value = u(i) + u_trim[i];
             if ( value < u_min[i] ) { value = u_min[i]; }
             if ( value > u_max[i] ) { value = u_max[i]; }
-            outputs_node[i].setDouble( outputs_attr[i].c_str(), value );
+            output_handles[i].set( value );
         }
     }
 }
@@ -43,16 +43,19 @@ private:
     bool do_reset;
 
     VectorXd x, z, u;
+    VectorXd dz, x_next;        // update() work space
     MatrixXd A, B, C, D;
-    MatrixXd M, S, T, F, G;
+
+    // discretized system (x' = F x + G z) for cached_dt, only
+    // recomputed when dt moves more than dt_tolerance (relative)
+    MatrixXd M, F, G;
+    double cached_dt;
+    double dt_tolerance;
+    void discretize( double dt );
     
-    vector <pyPropertyNode> inputs_node;
-    vector <string> inputs_attr;
+    vector <ap_double_t> input_handles;
     VectorXd z_trim;
     
-    vector <pyPropertyNode> outputs_node;
-    vector <string> outputs_attr;
-
     vector <double> u_min;
     vector <double> u_max;
     vector <double> u_trim;
@@ -64,4 +67,5 @@ public:
 
     void reset();
     void update( double dt );
+    void compile( ap_program_t &prog );
 };
@@ -34,11 +34,13 @@ AuraPID::AuraPID( string config_path ):
     iterm( 0.0 ),
     y_n( 0.0 ),
     y_n_1( 0.0 ),
-    r_n( 0.0 )
+    r_n( 0.0 ),
+    ref_const( 0.0 ),
+    wrap( wrap_none )
 {
-    size_t pos;
 
     component_node = pyGetNode(config_path, true);
+    debug_handle.bind( component_node, "debug" );
     vector <string> children;
 
     // enable
@@ -49,13 +51,9 @@ AuraPID::AuraPID( string config_path ):
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string enable_prop = node.getString(children[i].c_str());
             printf("  %s\n", enable_prop.c_str());
-	    pos = enable_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = enable_prop.substr(0, pos);
-		string attr = enable_prop.substr(pos+1);
-		pyPropertyNode en_node = pyGetNode( path, true );
-		enables_node.push_back( en_node );
-		enables_attr.push_back( attr );
+	    ap_bool_t en;
+	    if ( en.bind( enable_prop ) ) {
+		enable_handles.push_back( en );
 	    } else {
 		printf("WARNING: requested bad enable path: %s\n",
 		       enable_prop.c_str());
@@ -69,23 +67,22 @@ AuraPID::AuraPID( string config_path ):
     // input
     node = component_node.getChild("input", true);
     string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	input_node = pyGetNode( path, true );
-    }
+    input_handle.bind( input_prop );
 
     // reference
     node = component_node.getChild("reference", true);
     string ref_prop = node.getString("prop");
     ref_value = node.getString("value");
-    pos = ref_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = ref_prop.substr(0, pos);
-	ref_attr = ref_prop.substr(pos+1);
-	// printf("path = %s attr = %s\n", path.c_str(), ref_attr.c_str());
-	ref_node = pyGetNode( path, true );
+    if ( ref_value != "" ) {
+        ref_const = atof(ref_value.c_str());
+    }
+    ref_handle.bind( ref_prop );
+
+    string wrap_value = component_node.getString("wrap");
+    if ( wrap_value == "180" ) {
+        wrap = wrap_180;
+    } else if ( wrap_value == "pi" ) {
+        wrap = wrap_pi;
     }
 
     // output
@@ -94,13 +91,9 @@ AuraPID::AuraPID( string config_path ):
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
+	    ap_double_t out;
+	    if ( out.bind( output_prop ) ) {
+		output_handles.push_back( out );
 	    } else {
 		printf("WARNING: requested bad output path: %s\n",
 		       output_prop.c_str());
@@ -113,6 +106,12 @@ AuraPID::AuraPID( string config_path ):
  
     // config
     config_node = component_node.getChild( "config", true );
+    config_props.Kp.bind( config_node, "Kp" );
+    config_props.Ti.bind( config_node, "Ti" );
+    config_props.Td.bind( config_node, "Td" );
+    config_props.u_min.bind( config_node, "u_min" );
+    config_props.u_max.bind( config_node, "u_max" );
+    config_props.u_trim.bind( config_node, "u_trim" );
 }
 
 
@@ -121,36 +120,46 @@ void AuraPID::reset() {
 }
 
 
+void AuraPID::compile( ap_program_t &prog ) {
+    APComponent::compile( prog );
+    prog.attach( config_props.Kp );
+    prog.attach( config_props.Ti );
+    prog.attach( config_props.Td );
+    prog.attach( config_props.u_min );
+    prog.attach( config_props.u_max );
+    prog.attach( config_props.u_trim );
+}
+
+
 void AuraPID::update( double dt ) {
     // test if all of the provided enable flags are true
     enabled = true;
-    for ( unsigned int i = 0; i < enables_node.size(); i++ ) {
-        if ( !enables_node[i].getBool(enables_attr[i].c_str()) ) {
+    for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+        if ( !enable_handles[i].get() ) {
             enabled = false;
             break;
         }
     }
 
-    bool debug = component_node.getBool("debug");
+    bool debug = debug_handle.get();
     if ( debug ) printf("Updating %s\n", get_name().c_str());
-    y_n = input_node.getDouble(input_attr.c_str());
+    y_n = input_handle.get();
 
     double r_n = 0.0;
     if ( ref_value != "" ) {
 	// printf("nonzero ref_value\n");
-	r_n = atof(ref_value.c_str());
+	r_n = ref_const;
     } else {
-	r_n = ref_node.getDouble(ref_attr.c_str());
+	r_n = ref_handle.get();
     }
                       
     double error = r_n - y_n;
 
-    string wrap = component_node.getString("wrap");
-    if ( wrap == "180" ) {
+    if ( wrap == wrap_180 ) {
         // wrap error (by +/- 360 degrees to put the result in [-180, 180]
         if ( error < -180 ) { error += 360; }
         if ( error > 180 ) { error -= 360; }
-    } else if ( wrap == "pi" ) {
+    } else if ( wrap == wrap_pi ) {
         // wrap error (by +/- 2*pi degrees to put the result in [-pi, pi]
         if ( error < -M_PI ) { error += 2*M_PI; }
         if ( error > M_PI ) { error -= 2*M_PI; }
@@ -159,13 +168,13 @@ void AuraPID::update( double dt ) {
     if ( debug ) printf("input = %.3f reference = %.3f error = %.3f\n",
 			y_n, r_n, error);
 
-    double u_trim = config_node.getDouble("u_trim");
-    double u_min = config_node.getDouble("u_min");
-    double u_max = config_node.getDouble("u_max");
+    double u_trim = config_props.u_trim.get();
+    double u_min = config_props.u_min.get();
+    double u_max = config_props.u_max.get();
 
-    double Kp = config_node.getDouble("Kp");
-    double Ti = config_node.getDouble("Ti");
-    double Td = config_node.getDouble("Td");
+    double Kp = config_props.Kp.get();
+    double Ti = config_props.Ti.get();
+    double Td = config_props.Td.get();
     double Ki = 0.0;
     if ( Ti > 0.0001 ) {
 	Ki = Kp / Ti;
@@ -187,10 +196,10 @@ void AuraPID::update( double dt ) {
     // iterm) then unset the do_reset flag.
     if ( do_reset ) {
         if ( Ti > 0.0001 ) {
-            double u_n = output_node[0].getDouble(output_attr[0].c_str());
+            double u_n = output_handles[0].get();
             // and clip
-            double u_min = config_node.getDouble("u_min");
-            double u_max = config_node.getDouble("u_max");
+            double u_min = config_props.u_min.get();
+            double u_max = config_props.u_max.get();
             if ( u_n < u_min ) { u_n = u_min; }
             if ( u_n > u_max ) { u_n = u_max; }
             iterm = u_n - pterm;
@@ -230,8 +239,8 @@ void AuraPID::update( double dt ) {
         do_reset = true;
     } else {
 	// Copy the result to the output node(s)
-	for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-	    output_node[i].setDouble( output_attr[i].c_str(), output );
+	for ( unsigned int i = 0; i < output_handles.size(); i++ ) {
+	    output_handles[i].set( output );
 	}
     }
 }
@@ -43,6 +43,15 @@ private:
     double y_n_1;		// previous process value (input)
     double r_n;                 // reference (set point) value
 
+    // fixed config (parsed once)
+    double ref_const;           // reference/value if given
+    enum { wrap_none, wrap_180, wrap_pi } wrap;
+
+    // tunable config values (read every update)
+    struct {
+        ap_double_t Kp, Ti, Td, u_min, u_max, u_trim;
+    } config_props;
+
 public:
 
     AuraPID( string config_path );
@@ -50,6 +59,7 @@ public:
 
     void reset();
     void update( double dt );
+    void compile( ap_program_t &prog );
 };
 
 
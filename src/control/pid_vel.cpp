@@ -30,11 +30,12 @@ AuraPIDVel::AuraPIDVel( string config_path ):
     edf_n_2( 0.0 ),
     u_n_1( 0.0 ),
     desiredTs( 0.00001 ),
-    elapsedTime( 0.0 )
+    elapsedTime( 0.0 ),
+    ref_const( 0.0 )
 {
-    size_t pos;
 
     component_node = pyGetNode(config_path, true);
+    debug_handle.bind( component_node, "debug" );
         vector <string> children;
     
     // enable
@@ -45,13 +46,9 @@ AuraPIDVel::AuraPIDVel( string config_path ):
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string enable_prop = node.getString(children[i].c_str());
             printf("  %s\n", enable_prop.c_str());
-	    pos = enable_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = enable_prop.substr(0, pos);
-		string attr = enable_prop.substr(pos+1);
-		pyPropertyNode en_node = pyGetNode( path, true );
-		enables_node.push_back( en_node );
-		enables_attr.push_back( attr );
+	    ap_bool_t en;
+	    if ( en.bind( enable_prop ) ) {
+		enable_handles.push_back( en );
 	    } else {
 		printf("WARNING: requested bad enable path: %s\n",
 		       enable_prop.c_str());
@@ -65,25 +62,16 @@ AuraPIDVel::AuraPIDVel( string config_path ):
     // input
     node = component_node.getChild("input", true);
     string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	printf("path = %s attr = %s\n", path.c_str(), input_attr.c_str());
-	input_node = pyGetNode( path, true );
-    }
+    input_handle.bind( input_prop );
 
     // reference
     node = component_node.getChild("reference", true);
     string ref_prop = node.getString("prop");
     ref_value = node.getString("value");
-    pos = ref_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = ref_prop.substr(0, pos);
-	ref_attr = ref_prop.substr(pos+1);
-	printf("path = %s attr = %s\n", path.c_str(), ref_attr.c_str());
-	ref_node = pyGetNode( path, true );
+    if ( ref_value != "" ) {
+        ref_const = atof(ref_value.c_str());
     }
+    ref_handle.bind( ref_prop );
 
     // output
     node = component_node.getChild( "output", true );
@@ -91,14 +79,9 @@ AuraPIDVel::AuraPIDVel( string config_path ):
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		printf("path = %s attr = %s\n", path.c_str(), attr.c_str());
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
+	    ap_double_t out;
+	    if ( out.bind( output_prop ) ) {
+		output_handles.push_back( out );
 	    } else {
 		printf("WARNING: requested bad output path: %s\n",
 		       output_prop.c_str());
@@ -123,6 +106,14 @@ AuraPIDVel::AuraPIDVel( string config_path ):
 	// create with default value
 	config_node.setDouble( "alpha", 0.1 );
     }
+    config_props.Kp.bind( config_node, "Kp" );
+    config_props.Ti.bind( config_node, "Ti" );
+    config_props.Td.bind( config_node, "Td" );
+    config_props.alpha.bind( config_node, "alpha" );
+    config_props.beta.bind( config_node, "beta" );
+    config_props.gamma.bind( config_node, "gamma" );
+    config_props.u_min.bind( config_node, "u_min" );
+    config_props.u_max.bind( config_node, "u_max" );
 }
 
 
@@ -130,6 +121,19 @@ void AuraPIDVel::reset() {
 }
 
 
+void AuraPIDVel::compile( ap_program_t &prog ) {
+    APComponent::compile( prog );
+    prog.attach( config_props.Kp );
+    prog.attach( config_props.Ti );
+    prog.attach( config_props.Td );
+    prog.attach( config_props.alpha );
+    prog.attach( config_props.beta );
+    prog.attach( config_props.gamma );
+    prog.attach( config_props.u_min );
+    prog.attach( config_props.u_max );
+}
+
+
 /*
  * Roy Vegard Ovesen:
  *
@@ -201,32 +205,32 @@ void AuraPIDVel::update( double dt ) {
 
     // test if all of the provided enable flags are true
     enabled = true;
-    for ( unsigned int i = 0; i < enables_node.size(); i++ ) {
-        if ( !enables_node[i].getBool(enables_attr[i].c_str()) ) {
+    for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+        if ( !enable_handles[i].get() ) {
             enabled = false;
             break;
         }
     }
 
-    bool debug = component_node.getBool("debug");
+    bool debug = debug_handle.get();
 
     if ( Ts > 0.0) {
         if ( debug ) printf("Updating %s Ts = %.2f", get_name().c_str(), Ts );
 
         double y_n = 0.0;
-	y_n = input_node.getDouble(input_attr.c_str());
+	y_n = input_handle.get();
 
         double r_n = 0.0;
 	if ( ref_value != "" ) {
-	    r_n = atof(ref_value.c_str());
+	    r_n = ref_const;
 	} else {
-            r_n = ref_node.getDouble(ref_attr.c_str());
+            r_n = ref_handle.get();
 	}
                       
         if ( debug ) printf("  input = %.3f ref = %.3f\n", y_n, r_n );
 
         // Calculates proportional error:
-        ep_n = config_node.getDouble("beta") * (r_n - y_n);
+        ep_n = config_props.beta.get() * (r_n - y_n);
         if ( debug ) {
 	    printf( "  ep_n = %.3f", ep_n);
 	    printf( "  ep_n_1 = %.3f", ep_n_1);
@@ -237,13 +241,13 @@ void AuraPIDVel::update( double dt ) {
         if ( debug ) printf( " e_n = %.3f", e_n);
 
         // Calculates derivate error:
-        ed_n = config_node.getDouble("gamma") * r_n - y_n;
+        ed_n = config_props.gamma.get() * r_n - y_n;
         if ( debug ) printf(" ed_n = %.3f", ed_n);
 
-	double Td = config_node.getDouble("Td");
+	double Td = config_props.Td.get();
         if ( Td > 0.0 ) {
             // Calculates filter time:
-            Tf = config_node.getDouble("alpha") * Td;
+            Tf = config_props.alpha.get() * Td;
             if ( debug ) printf(" Tf = %.3f", Tf);
 
             // Filters the derivate error:
@@ -255,8 +259,8 @@ void AuraPIDVel::update( double dt ) {
         }
 
         // Calculates the incremental output:
-	double Ti = config_node.getDouble("Ti");
-	double Kp = config_node.getDouble("Kp");
+	double Ti = config_props.Ti.get();
+	double Kp = config_props.Kp.get();
         if ( Ti > 0.0 ) {
             delta_u_n = Kp * ( (ep_n - ep_n_1)
                                + ((Ts/Ti) * e_n)
@@ -272,8 +276,8 @@ void AuraPIDVel::update( double dt ) {
         }
 
         // Integrator anti-windup logic:
-	double u_min = config_node.getDouble("u_min");
-	double u_max = config_node.getDouble("u_max");
+	double u_min = config_props.u_min.get();
+	double u_max = config_props.u_max.get();
         if ( delta_u_n > (u_max - u_n_1) ) {
             delta_u_n = u_max - u_n_1;
             if ( debug ) printf(" max saturation\n");
@@ -295,18 +299,18 @@ void AuraPIDVel::update( double dt ) {
 
     if ( enabled ) {
 	// Copy the result to the output node(s)
-	for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-	    output_node[i].setDouble( output_attr[i].c_str(), u_n );
+	for ( unsigned int i = 0; i < output_handles.size(); i++ ) {
+	    output_handles[i].set( u_n );
 	}
-    } else if ( output_node.size() > 0 ) {
+    } else if ( output_handles.size() > 0 ) {
 	// Mirror the output value while we are not enabled so there
 	// is less of a continuity break when this module is enabled
 
 	// pull output value from the corresponding property tree value
-	u_n = output_node[0].getDouble(output_attr[0].c_str());
+	u_n = output_handles[0].get();
 	// and clip
-	double u_min = config_node.getDouble("u_min");
-	double u_max = config_node.getDouble("u_max");
+	double u_min = config_props.u_min.get();
+	double u_max = config_props.u_max.get();
  	if ( u_n < u_min ) { u_n = u_min; }
 	if ( u_n > u_max ) { u_n = u_max; }
 	u_n_1 = u_n;
@@ -38,6 +38,12 @@ private:
     double u_n_1;               // u[n-1]   (output)
     double desiredTs;            // desired sampling interval (sec)
     double elapsedTime;          // elapsed time (sec)
+    double ref_const;            // reference/value if given
+
+    // tunable config values (read every update)
+    struct {
+        ap_double_t Kp, Ti, Td, alpha, beta, gamma, u_min, u_max;
+    } config_props;
     
 public:
 
@@ -47,6 +53,7 @@ public:
 
     void reset();
     void update( double dt );
+    void compile( ap_program_t &prog );
 };
 
 
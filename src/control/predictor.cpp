@@ -30,7 +30,6 @@ AuraPredictor::AuraPredictor ( string config_path ):
     filter_gain( 0.0 ),
     ivalue( 0.0 )
 {
-    size_t pos;
 
     component_node = pyGetNode(config_path);
     vector <string> children;
@@ -43,13 +42,9 @@ AuraPredictor::AuraPredictor ( string config_path ):
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string enable_prop = node.getString(children[i].c_str());
             printf("  %s\n", enable_prop.c_str());
-	    pos = enable_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = enable_prop.substr(0, pos);
-		string attr = enable_prop.substr(pos+1);
-		pyPropertyNode en_node = pyGetNode( path, true );
-		enables_node.push_back( en_node );
-		enables_attr.push_back( attr );
+	    ap_bool_t en;
+	    if ( en.bind( enable_prop ) ) {
+		enable_handles.push_back( en );
 	    } else {
 		printf("WARNING: requested bad enable path: %s\n",
 		       enable_prop.c_str());
@@ -63,12 +58,7 @@ AuraPredictor::AuraPredictor ( string config_path ):
     // input
     node = component_node.getChild("input", true);
     string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	input_node = pyGetNode( path, true );
-    }
+    input_handle.bind( input_prop );
 
     if ( component_node.hasChild("seconds") ) {
 	seconds = component_node.getDouble("seconds");
@@ -83,13 +73,9 @@ AuraPredictor::AuraPredictor ( string config_path ):
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
+	    ap_double_t out;
+	    if ( out.bind( output_prop ) ) {
+		output_handles.push_back( out );
 	    } else {
 		printf("WARNING: requested bad output path: %s\n",
 		       output_prop.c_str());
@@ -121,14 +107,14 @@ void AuraPredictor::update( double dt ) {
 
     // test if all of the provided enable flags are true
     enabled = true;
-    for ( unsigned int i = 0; i < enables_node.size(); i++ ) {
-        if ( !enables_node[i].getBool(enables_attr[i].c_str()) ) {
+    for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+        if ( !enable_handles[i].get() ) {
             enabled = false;
             break;
         }
     }
 
-    ivalue = input_node.getDouble(input_attr.c_str());
+    ivalue = input_handle.get();
 
     if ( enabled ) {
         // first time initialize average
@@ -148,8 +134,8 @@ void AuraPredictor::update( double dt ) {
             double output = ivalue + (1.0 - filter_gain) * (average * seconds) + filter_gain * (current * seconds);
 
 	    // Copy the result to the output node(s)
-	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output );
+	    for ( unsigned int i = 0; i < output_handles.size(); i++ ) {
+		output_handles[i].set( output );
 	    }
         }
         last_value = ivalue;
@@ -25,9 +25,9 @@
 
 AuraSummer::AuraSummer ( string config_path )
 {
-    size_t pos;
 
     component_node = pyGetNode(config_path);
+    debug_handle.bind( component_node, "debug" );
     vector <string> children;
     
     // enable
@@ -38,13 +38,9 @@ AuraSummer::AuraSummer ( string config_path )
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string enable_prop = node.getString(children[i].c_str());
             printf("  %s\n", enable_prop.c_str());
-	    pos = enable_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = enable_prop.substr(0, pos);
-		string attr = enable_prop.substr(pos+1);
-		pyPropertyNode en_node = pyGetNode( path, true );
-		enables_node.push_back( en_node );
-		enables_attr.push_back( attr );
+	    ap_bool_t en;
+	    if ( en.bind( enable_prop ) ) {
+		enable_handles.push_back( en );
 	    } else {
 		printf("WARNING: requested bad enable path: %s\n",
 		       enable_prop.c_str());
@@ -61,13 +57,9 @@ AuraSummer::AuraSummer ( string config_path )
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string input_prop = node.getString(children[i].c_str());
-	    pos = input_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = input_prop.substr(0, pos);
-		string attr = input_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		input_node.push_back( onode );
-		input_attr.push_back( attr );
+	    ap_double_t in;
+	    if ( in.bind( input_prop ) ) {
+		input_handles.push_back( in );
 	    } else {
 		printf("WARNING: requested bad input path: %s\n",
 		       input_prop.c_str());
@@ -84,13 +76,9 @@ AuraSummer::AuraSummer ( string config_path )
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
+	    ap_double_t out;
+	    if ( out.bind( output_prop ) ) {
+		output_handles.push_back( out );
 	    } else {
 		printf("WARNING: requested bad output path: %s\n",
 		       output_prop.c_str());
@@ -103,42 +91,57 @@ AuraSummer::AuraSummer ( string config_path )
     
     // config
     config_node = component_node.getChild( "config", true );
+    if ( config_node.hasChild("u_min") ) {
+        u_min.bind( config_node, "u_min" );
+    }
+    if ( config_node.hasChild("u_max") ) {
+        u_max.bind( config_node, "u_max" );
+    }
 }
 
 void AuraSummer::reset() {
     // noop
 }
 
+void AuraSummer::compile( ap_program_t &prog ) {
+    APComponent::compile( prog );
+    for ( unsigned int i = 0; i < input_handles.size(); i++ ) {
+        prog.attach( input_handles[i] );
+    }
+    prog.attach( u_min );
+    prog.attach( u_max );
+}
+
 void AuraSummer::update( double dt ) {
     // test if all of the provided enable flags are true
     enabled = true;
-    for ( unsigned int i = 0; i < enables_node.size(); i++ ) {
-        if ( !enables_node[i].getBool(enables_attr[i].c_str()) ) {
+    for ( unsigned int i = 0; i < enable_handles.size(); i++ ) {
+        if ( !enable_handles[i].get() ) {
             enabled = false;
             break;
         }
     }
 
     if ( enabled ) {
-	bool debug = component_node.getBool("debug");
+	bool debug = debug_handle.get();
 	if ( debug ) printf("Updating %s\n", get_name().c_str());
 	double sum = 0.0;
-	for ( unsigned int i = 0; i < input_node.size(); i++ ) {
-	    double val = input_node[i].getDouble( input_attr[i].c_str() );
+	for ( unsigned int i = 0; i < input_handles.size(); i++ ) {
+	    double val = input_handles[i].get();
 	    sum += val;
-	    if (debug) printf("  %s = %.3f\n", input_attr[i].c_str(), val);
+	    if (debug) printf("  %s = %.3f\n", input_handles[i].get_name(), val);
 	}
-	if ( config_node.hasChild("u_min") ) {
-	    double u_min = config_node.getDouble("u_min");
-	    if ( sum < u_min ) { sum = u_min; }
+	if ( !u_min.isNull() ) {
+	    double min = u_min.get();
+	    if ( sum < min ) { sum = min; }
 	}
-	if ( config_node.hasChild("u_max") ) {
-	    double u_max = config_node.getDouble("u_max");
-	    if ( sum > u_max ) { sum = u_max; }
+	if ( !u_max.isNull() ) {
+	    double max = u_max.get();
+	    if ( sum > max ) { sum = max; }
 	}
 	if (debug) printf("  sum = %.3f\n", sum);
-	for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-	    output_node[i].setDouble( output_attr[i].c_str(), sum );
+	for ( unsigned int i = 0; i < output_handles.size(); i++ ) {
+	    output_handles[i].set( sum );
 	}
     }
 }
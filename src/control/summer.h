@@ -29,8 +29,10 @@ class AuraSummer : public APComponent {
 
 private:
     // support multiple input nodes
-    vector <pyPropertyNode> input_node;
-    vector <string> input_attr;
+    vector <ap_double_t> input_handles;
+
+    // optional output limits (unbound if not configured)
+    ap_double_t u_min, u_max;
 
     // debug flag
     bool debug_node;
@@ -42,4 +44,5 @@ public:
 
     void reset();
     void update( double dt );
+    void compile( ap_program_t &prog );
 };
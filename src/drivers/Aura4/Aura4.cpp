@@ -4,7 +4,7 @@
 //
 
 // TODO:
-// - (for now ok) straighten out what I'm doing with imu timestamp dance
+// - (ok) straighten out what I'm doing with imu timestamp dance
 // - (for now ok) straighten out what I'm doing with skipped frames
 // - (for now ok) gps age?
 // - (ok) send ekf config
@@ -18,6 +18,7 @@
 
 #include <stdarg.h>
 #include <stdlib.h>             // exit()
+#include <string.h>             // memcpy()
 
 #include <string>
 #include <sstream>
@@ -25,6 +26,7 @@ using std::string;
 using std::ostringstream;
 
 //#include "init/globals.h"
+#include "drivers/driver_reader.h"
 #include "util/props_helper.h"
 #include "util/timing.h"
 
@@ -58,6 +60,7 @@ void Aura4_t::init( pyPropertyNode *config ) {
     power_node = pyGetNode("/sensors/power", true);
     status_node = pyGetNode("/status", true);
     aura4_config = *config;
+    init_dispatch();
 
     printf("Aura4 driver init(): event logging broken!\n");
     printf("Aura4 driver init(): write imu calibration broken!\n");
@@ -175,6 +178,27 @@ void Aura4_t::init_gps( pyPropertyNode *config ) {
 void Aura4_t::init_imu( pyPropertyNode *config ) {
     string output_path = get_next_path("/sensors", "imu", true);
     imu_node = pyGetNode(output_path.c_str(), true);
+    imu_record.bind( imu_node );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, timestamp );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, imu_millis );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, imu_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, p_rad_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, q_rad_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, r_rad_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, ax_mps_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, ay_mps_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, az_mps_sec );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, hx );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, hy );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, hz );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, ax_raw );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, ay_raw );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, az_raw );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, hx_raw );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, hy_raw );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, hz_raw );
+    PROP_RECORD_FIELD( imu_record, imu_out_t, temp_C );
+    imu_record.expose( "record" );
 
     // FIXME:
     // if ( config->hasChild("calibration") ) {
@@ -201,8 +225,10 @@ void Aura4_t::init_actuators( pyPropertyNode *config ) {
     act_node = pyGetNode("/actuators", true);
 }
 
-bool Aura4_t::update_imu( message::imu_t *imu ) {
-    imu_timestamp = get_Time();
+bool Aura4_t::update_imu( const message::imu_view_t &imu ) {
+    // host time the packet was received (not when the main loop got
+    // around to it)
+    imu_timestamp = packet.arrival;
     
     // pulled from aura-sensors/src/imu.cpp
     const float _pi = 3.14159265358979323846;
@@ -220,203 +246,177 @@ bool Aura4_t::update_imu( message::imu_t *imu ) {
     const float magScale = 0.01;
     const float tempScale = 0.01;
 
-    float ax_raw = (float)imu->raw[0] * accelScale;
-    float ay_raw = (float)imu->raw[1] * accelScale;
-    float az_raw = (float)imu->raw[2] * accelScale;
-    float hx_raw = (float)imu->raw[3] * magScale;
-    float hy_raw = (float)imu->raw[4] * magScale;
-    float hz_raw = (float)imu->raw[5] * magScale;
-
-    float ax_cal = (float)imu->cal[0] * accelScale;
-    float ay_cal = (float)imu->cal[1] * accelScale;
-    float az_cal = (float)imu->cal[2] * accelScale;
-    float p_cal = (float)imu->cal[3] * gyroScale;
-    float q_cal = (float)imu->cal[4] * gyroScale;
-    float r_cal = (float)imu->cal[5] * gyroScale;
-    float hx_cal = (float)imu->cal[6] * magScale;
-    float hy_cal = (float)imu->cal[7] * magScale;
-    float hz_cal = (float)imu->cal[8] * magScale;
-
-    float temp_C = (float)imu->cal[9] * tempScale;
-
-    // timestamp dance: this is a little jig that I do to make a
-    // more consistent time stamp that still is in the host
-    // reference frame.  Assumes the Aura4 clock drifts relative to
-    // host clock.  Assumes the Aura4 imu stamp dt is very stable.
-    // Assumes the host system is not-real time and there may be
-    // momentary external disruptions to execution. The code
-    // estimates the error (difference) between Aura4 clock and
-    // host clock.  Then builds a real time linear fit of Aura4
-    // clock versus difference with the host.  This linear fit is
-    // used to estimate the current error (smoothly), add that to
-    // the Aura4 clock and derive a more regular/stable IMU time
-    // stamp (versus just sampling current host time.)
-	
-    // imu->micros &= 0xffffff; // 24 bits = 16.7 microseconds roll over
-    // imu->micros &= 0xffffff; // 24 bits = 16.7 microseconds roll over
-	
-    double imu_remote_sec = (double)imu->millis / 1000.0;
-    double diff = imu_timestamp - imu_remote_sec;
-    if ( last_imu_millis > imu->millis ) {
-        // FIXME: events->log("Aura4", "millis() rolled over\n");
-        imu_offset.reset();
-    }
-    imu_offset.update(imu_remote_sec, diff);
-    double fit_diff = imu_offset.get_value(imu_remote_sec);
-    // printf("fit_diff = %.6f  diff = %.6f  ts = %.6f\n",
-    //        fit_diff, diff, imu_remote_sec + fit_diff );
-
-    last_imu_millis = imu->millis;
-	
-    imu_node.setDouble( "timestamp", imu_remote_sec + fit_diff );
-    imu_node.setLong( "imu_millis", imu->millis );
-    imu_node.setDouble( "imu_sec", (double)imu->millis / 1000.0 );
-    imu_node.setDouble( "p_rad_sec", p_cal );
-    imu_node.setDouble( "q_rad_sec", q_cal );
-    imu_node.setDouble( "r_rad_sec", r_cal );
-    imu_node.setDouble( "ax_mps_sec", ax_cal );
-    imu_node.setDouble( "ay_mps_sec", ay_cal );
-    imu_node.setDouble( "az_mps_sec", az_cal );
-    imu_node.setDouble( "hx", hx_cal );
-    imu_node.setDouble( "hy", hy_cal );
-    imu_node.setDouble( "hz", hz_cal );
-    imu_node.setDouble( "ax_raw", ax_raw );
-    imu_node.setDouble( "ay_raw", ay_raw );
-    imu_node.setDouble( "az_raw", az_raw );
-    imu_node.setDouble( "hx_raw", hx_raw );
-    imu_node.setDouble( "hy_raw", hy_raw );
-    imu_node.setDouble( "hz_raw", hz_raw );
-    imu_node.setDouble( "temp_C", temp_C );
+    float ax_raw = (float)imu.raw(0) * accelScale;
+    float ay_raw = (float)imu.raw(1) * accelScale;
+    float az_raw = (float)imu.raw(2) * accelScale;
+    float hx_raw = (float)imu.raw(3) * magScale;
+    float hy_raw = (float)imu.raw(4) * magScale;
+    float hz_raw = (float)imu.raw(5) * magScale;
+
+    float ax_cal = (float)imu.cal(0) * accelScale;
+    float ay_cal = (float)imu.cal(1) * accelScale;
+    float az_cal = (float)imu.cal(2) * accelScale;
+    float p_cal = (float)imu.cal(3) * gyroScale;
+    float q_cal = (float)imu.cal(4) * gyroScale;
+    float r_cal = (float)imu.cal(5) * gyroScale;
+    float hx_cal = (float)imu.cal(6) * magScale;
+    float hy_cal = (float)imu.cal(7) * magScale;
+    float hz_cal = (float)imu.cal(8) * magScale;
+
+    float temp_C = (float)imu.cal(9) * tempScale;
+
+    // timestamp dance: the FMU millis() clock is regular but drifts
+    // relative to the host clock, the host receive time is in the
+    // right reference frame but carries a variable (always positive)
+    // transport and scheduling delay.  imu_clock fits host time
+    // versus FMU time (offset + drift, late packets gated out, 32 bit
+    // rollover and FMU resets handled) and maps each millis() stamp
+    // to a smooth host time stamp.
+    imu_out_t out;
+    out.timestamp = imu_clock.update(imu.millis(), imu_timestamp);
+    out.imu_millis = imu.millis();
+    out.imu_sec = (double)imu.millis() / 1000.0;
+    out.p_rad_sec = p_cal;
+    out.q_rad_sec = q_cal;
+    out.r_rad_sec = r_cal;
+    out.ax_mps_sec = ax_cal;
+    out.ay_mps_sec = ay_cal;
+    out.az_mps_sec = az_cal;
+    out.hx = hx_cal;
+    out.hy = hy_cal;
+    out.hz = hz_cal;
+    out.ax_raw = ax_raw;
+    out.ay_raw = ay_raw;
+    out.az_raw = az_raw;
+    out.hx_raw = hx_raw;
+    out.hy_raw = hy_raw;
+    out.hz_raw = hz_raw;
+    out.temp_C = temp_C;
+    imu_record.publish( out );
 
     return true;
 }
 
 
+// decode a payload through its message view and call the handler
+template <class V, bool (Aura4_t::*H)( const V & )>
+bool Aura4_t::dispatch_view( Aura4_t *self, const uint8_t *payload ) {
+    return (self->*H)( V(payload) );
+}
+
+// register the handler for one message type (the generated view
+// type provides the id and expected length)
+template <class V, bool (Aura4_t::*H)( const V & )>
+void Aura4_t::add_handler( const char *name ) {
+    dispatch_t &d = dispatch[V::id];
+    d.handler = dispatch_view<V, H>;
+    d.name = name;
+    d.len = V::len;
+}
+
+void Aura4_t::init_dispatch() {
+    add_handler<message::command_ack_view_t, &Aura4_t::update_ack>( "ack" );
+    add_handler<message::airdata_view_t, &Aura4_t::update_airdata>( "airdata" );
+    add_handler<message::ekf_view_t, &Aura4_t::update_ekf>( "ekf" );
+    add_handler<message::aura_nav_pvt_view_t, &Aura4_t::update_gps>( "gps" );
+    add_handler<message::imu_view_t, &Aura4_t::update_imu>( "imu" );
+    add_handler<message::pilot_view_t, &Aura4_t::update_pilot>( "pilot" );
+    add_handler<message::power_view_t, &Aura4_t::update_power>( "power" );
+    add_handler<message::status_view_t, &Aura4_t::update_status>( "status" );
+}
+
 bool Aura4_t::parse( uint8_t pkt_id, uint8_t pkt_len, uint8_t *payload ) {
-    bool new_data = false;
-
-    if ( pkt_id == message::command_ack_id ) {
-        message::command_ack_t ack;
-        ack.unpack(payload, pkt_len);
-	if ( pkt_len == ack.len ) {
-            last_ack_id = ack.command_id;
-	    last_ack_subid = ack.subcommand_id;
-            info("Received ACK = %d %d", ack.command_id, ack.subcommand_id);
-	} else {
-	    printf("Aura4: packet size mismatch in ACK\n");
-	}
-    } else if ( pkt_id == message::airdata_id ) {
-        message::airdata_t airdata;
-        airdata.unpack(payload, pkt_len);
-	if ( pkt_len == airdata.len ) {
-            update_airdata(&airdata);
-	    airdata_packet_counter++;
-	    aura4_node.setLong( "airdata_packet_count", airdata_packet_counter );
-	    new_data = true;
-	} else {
-            info("packet size mismatch in airdata packet");
-	}
-    } else if ( pkt_id == message::ekf_id ) {
-        message::ekf_t ekf;
-        ekf.unpack(payload, pkt_len);
-        if ( pkt_len == ekf.len ) {
-            update_ekf(&ekf);
-            ekf_packet_counter++;
-            aura4_node.setLong( "ekf_packet_count", ekf_packet_counter );
-            new_data = true;
-        } else {
-            info("packet size mismatch in ekf packet");
-        }
-    } else if ( pkt_id == message::aura_nav_pvt_id ) {
-        message::aura_nav_pvt_t nav_pvt;
-        nav_pvt.unpack(payload, pkt_len);
-	if ( pkt_len == nav_pvt.len ) {
-            update_gps(&nav_pvt);
-	    gps_packet_counter++;
-	    aura4_node.setLong( "gps_packet_count", gps_packet_counter );
-	    new_data = true;
-	} else {
-            info("packet size mismatch in gps packet");
-            info("got %d, expected %d", pkt_len, nav_pvt.len);
-	}
-    } else if ( pkt_id == message::imu_id ) {
-        message::imu_t imu;
-        imu.unpack(payload, pkt_len);
-	if ( pkt_len == imu.len ) {
-            update_imu(&imu);
-	    imu_packet_counter++;
-	    aura4_node.setLong( "imu_packet_count",
-                                imu_packet_counter );
-	    new_data = true;
-	} else {
-            info("packet size mismatch in imu packet");
-	}
-    } else if ( pkt_id == message::pilot_id ) {
-        message::pilot_t pilot;
-        pilot.unpack(payload, pkt_len);
-	if ( pkt_len == pilot.len ) {
-            update_pilot( &pilot );
-	    pilot_packet_counter++;
-	    aura4_node.setLong( "pilot_packet_count", pilot_packet_counter );
-	    new_data = true;
-	} else {
-            info("packet size mismatch in pilot input packet");
-	}
-    } else if ( pkt_id == message::power_id ) {
-        message::power_t power;
-        power.unpack(payload, pkt_len);
-	if ( pkt_len == power.len ) {
-
-            // we anticipate a 0.01 sec dt value
-            int_main_vcc_filt.update((float)power.int_main_v, 0.01);
-            ext_main_vcc_filt.update((float)power.ext_main_v, 0.01);
-            avionics_vcc_filt.update((float)power.avionics_v, 0.01);
-
-            power_node.setDouble( "main_vcc", int_main_vcc_filt.get_value() );
-            power_node.setDouble( "ext_main_vcc", ext_main_vcc_filt.get_value() );
-            power_node.setDouble( "avionics_vcc", avionics_vcc_filt.get_value() );
-
-            float cell_volt = int_main_vcc_filt.get_value() / (float)battery_cells;
-            float ext_cell_volt = ext_main_vcc_filt.get_value() / (float)battery_cells;
-            power_node.setDouble( "cell_vcc", cell_volt );
-            power_node.setDouble( "ext_cell_vcc", ext_cell_volt );
-            power_node.setDouble( "main_amps", (float)power.ext_main_amp);
-	} else {
-            info("packet size mismatch in power packet");
-	}
-    } else if ( pkt_id == message::status_id ) {
-        message::status_t msg;
-        msg.unpack(payload, pkt_len);
-	if ( pkt_len == msg.len ) {
-	    aura4_node.setLong( "serial_number", msg.serial_number );
-	    aura4_node.setLong( "firmware_rev", msg.firmware_rev );
-	    aura4_node.setLong( "master_hz", msg.master_hz );
-	    aura4_node.setLong( "baud_rate", msg.baud );
-	    aura4_node.setLong( "byte_rate_sec", msg.byte_rate );
-            status_node.setLong( "fmu_timer_misses", msg.timer_misses );
-
-            // FIXME:
-	    // if ( first_status_message ) {
-	    //     // log the data to events.txt
-	    //     first_status_message = false;
-	    //     char buf[128];
-	    //     snprintf( buf, 32, "Serial Number = %d", msg.serial_number );
-	    //     events->log("Aura4", buf );
-	    //     snprintf( buf, 32, "Firmware Revision = %d", msg.firmware_rev );
-	    //     events->log("Aura4", buf );
-	    //     snprintf( buf, 32, "Master Hz = %d", msg.master_hz );
-	    //     events->log("Aura4", buf );
-	    //     snprintf( buf, 32, "Baud Rate = %d", msg.baud );
-	    //     events->log("Aura4", buf );
-	    // }
-	} else {
-            info("packet size mismatch in status packet");
-	}
-    } else {
+    dispatch_t &d = dispatch[pkt_id];
+    if ( d.handler == NULL ) {
+        unknown_packets++;
+        parse_errors++;
         info("unknown packet id = %d", pkt_id);
+        return false;
+    }
+    if ( pkt_len != d.len ) {
+        d.errors++;
+        parse_errors++;
+        info("packet size mismatch in %s packet", d.name);
+        info("got %d, expected %d", pkt_len, d.len);
+        return false;
     }
+    d.count++;
+    return d.handler( this, payload );
+}
 
-    return new_data;
+// packet counters are kept natively and only published at a low rate
+void Aura4_t::publish_stats() {
+    for ( int i = 0; i < 256; i++ ) {
+        if ( dispatch[i].handler != NULL ) {
+            string name = dispatch[i].name;
+            aura4_node.setLong( (name + "_packet_count").c_str(),
+                                dispatch[i].count );
+            aura4_node.setLong( (name + "_packet_errors").c_str(),
+                                dispatch[i].errors );
+        }
+    }
+    aura4_node.setLong("unknown_packets", unknown_packets);
+    aura4_node.setLong("parse_errors", parse_errors);
+    aura4_node.setLong("skipped_frames", skipped_frames);
+    if ( reader ) {
+        aura4_node.setLong("reader_overruns", reader->get_overruns());
+    }
+    aura4_node.setBool("clock_synced", imu_clock.synced());
+    aura4_node.setDouble("clock_offset_sec", imu_clock.get_offset());
+    aura4_node.setDouble("clock_drift_ppm", imu_clock.get_drift_ppm());
+    aura4_node.setDouble("clock_jitter_ms", imu_clock.get_jitter() * 1000.0);
+    aura4_node.setLong("clock_outliers", imu_clock.get_outliers());
+    aura4_node.setLong("clock_resyncs", imu_clock.get_resyncs());
+}
+
+bool Aura4_t::update_ack( const message::command_ack_view_t &ack ) {
+    last_ack_id = ack.command_id();
+    last_ack_subid = ack.subcommand_id();
+    info("Received ACK = %d %d", ack.command_id(), ack.subcommand_id());
+    return false;
+}
+
+bool Aura4_t::update_power( const message::power_view_t &power ) {
+    // we anticipate a 0.01 sec dt value
+    int_main_vcc_filt.update((float)power.int_main_v(), 0.01);
+    ext_main_vcc_filt.update((float)power.ext_main_v(), 0.01);
+    avionics_vcc_filt.update((float)power.avionics_v(), 0.01);
+
+    power_node.setDouble( "main_vcc", int_main_vcc_filt.get_value() );
+    power_node.setDouble( "ext_main_vcc", ext_main_vcc_filt.get_value() );
+    power_node.setDouble( "avionics_vcc", avionics_vcc_filt.get_value() );
+
+    float cell_volt = int_main_vcc_filt.get_value() / (float)battery_cells;
+    float ext_cell_volt = ext_main_vcc_filt.get_value() / (float)battery_cells;
+    power_node.setDouble( "cell_vcc", cell_volt );
+    power_node.setDouble( "ext_cell_vcc", ext_cell_volt );
+    power_node.setDouble( "main_amps", (float)power.ext_main_amp());
+    return false;
+}
+
+bool Aura4_t::update_status( const message::status_view_t &msg ) {
+    aura4_node.setLong( "serial_number", msg.serial_number() );
+    aura4_node.setLong( "firmware_rev", msg.firmware_rev() );
+    aura4_node.setLong( "master_hz", msg.master_hz() );
+    aura4_node.setLong( "baud_rate", msg.baud() );
+    aura4_node.setLong( "byte_rate_sec", msg.byte_rate() );
+    status_node.setLong( "fmu_timer_misses", msg.timer_misses() );
+
+    // FIXME:
+    // if ( first_status_message ) {
+    //     // log the data to events.txt
+    //     first_status_message = false;
+    //     char buf[128];
+    //     snprintf( buf, 32, "Serial Number = %d", msg.serial_number );
+    //     events->log("Aura4", buf );
+    //     snprintf( buf, 32, "Firmware Revision = %d", msg.firmware_rev );
+    //     events->log("Aura4", buf );
+    //     snprintf( buf, 32, "Master Hz = %d", msg.master_hz );
+    //     events->log("Aura4", buf );
+    //     snprintf( buf, 32, "Baud Rate = %d", msg.baud );
+    //     events->log("Aura4", buf );
+    // }
+    return false;
 }
 
 
@@ -425,8 +425,8 @@ bool Aura4_t::wait_for_ack(uint8_t id) {
     double start_time = get_Time();
     last_ack_id = 0;
     while ( (last_ack_id != id) ) {
-	if ( serial.update() ) {
-            parse( serial.pkt_id, serial.pkt_len, serial.payload );
+	if ( next_packet() ) {
+            parse( packet.id, packet.len, packet.payload );
         }
 	if ( get_Time() > start_time + timeout ) {
             info("timeout waiting for ack...");
@@ -890,6 +890,35 @@ bool Aura4_t::send_config() {
     return true;
 }
 
+// Reader thread side: frame the next packet straight off the uart.
+bool Aura4_t::read_packet( driver_packet_t *pkt ) {
+    if ( !serial.update( 100 ) ) {
+        return false;
+    }
+    pkt->arrival = serial.rx_time;
+    pkt->id = serial.pkt_id;
+    pkt->len = serial.pkt_len;
+    memcpy( pkt->payload, serial.payload, serial.pkt_len );
+    return true;
+}
+
+// The next packet for the main thread, from the reader thread's
+// queue when one is running (the main thread then never reads the
+// uart itself), otherwise directly from the uart.
+bool Aura4_t::next_packet() {
+    if ( reader ) {
+        return reader->wait( &packet, 0.1 );
+    }
+    if ( !serial.update() ) {
+        return false;
+    }
+    packet.arrival = serial.rx_time;
+    packet.id = serial.pkt_id;
+    packet.len = serial.pkt_len;
+    memcpy( packet.payload, serial.payload, serial.pkt_len );
+    return true;
+}
+
 // Read Aura4 packets using IMU packet as the main timing reference.
 // Returns the dt from the IMU perspective, not the localhost
 // perspective.  This should generally be far more accurate and
@@ -907,12 +936,14 @@ float Aura4_t::read() {
     }
     
     while ( true ) {
-        if ( serial.update() ) {
-            parse( serial.pkt_id, serial.pkt_len, serial.payload );
-            if ( serial.pkt_id == message::imu_id ) {
-                if ( serial.bytes_available() < 256 ) {
-                    // a smaller value here means more skipping ahead and
-                    // less catching up.
+        if ( next_packet() ) {
+            parse( packet.id, packet.len, packet.payload );
+            if ( packet.id == message::imu_id ) {
+                // a smaller backlog here means more skipping ahead and
+                // less catching up.
+                bool caught_up = reader ? reader->pending() < 4
+                    : serial.bytes_available() < 256;
+                if ( caught_up ) {
                     break;
                 } else {
                     skipped_frames++;
@@ -922,8 +953,10 @@ float Aura4_t::read() {
     }
 
     // track communication errors from FMU
-    aura4_node.setLong("parse_errors", parse_errors);
-    aura4_node.setLong("skipped_frames", skipped_frames);
+    if ( imu_timestamp >= stats_time + 1.0 ) {
+        stats_time = imu_timestamp;
+        publish_stats();
+    }
 
     // relay optional zero gyros command back to FMU upon request
     string command = aura4_node.getString( "command" );
@@ -954,101 +987,101 @@ float Aura4_t::read() {
 }
 
 
-bool Aura4_t::update_ekf( message::ekf_t *ekf ) {
+bool Aura4_t::update_ekf( const message::ekf_view_t &ekf ) {
     const double R2D = 180 / M_PI;
     const double F2M = 0.3048;
     const double M2F = 1 / F2M;
     // do a little dance to estimate the ekf timestamp in seconds
     long int imu_millis = imu_node.getLong("imu_millis");
-    long int diff_millis = ekf->millis - imu_millis;
+    long int diff_millis = ekf.millis() - imu_millis;
     if ( diff_millis < 0 ) { diff_millis = 0; } // don't puke on wraparound
     double timestamp = imu_node.getDouble("timestamp")
         + (float)diff_millis / 1000.0;
     ekf_node.setDouble( "timestamp", timestamp );
-    ekf_node.setLong( "ekf_millis", ekf->millis );
-    ekf_node.setDouble( "latitude_deg", ekf->lat_rad * R2D );
-    ekf_node.setDouble( "longitude_deg", ekf->lon_rad * R2D );
-    ekf_node.setDouble( "altitude_m", ekf->altitude_m );
-    ekf_node.setDouble( "vn_ms", ekf->vn_ms );
-    ekf_node.setDouble( "ve_ms", ekf->ve_ms );
-    ekf_node.setDouble( "vd_ms", ekf->vd_ms );
-    ekf_node.setDouble( "phi_rad", ekf->phi_rad );
-    ekf_node.setDouble( "the_rad", ekf->the_rad );
-    ekf_node.setDouble( "psi_rad", ekf->psi_rad );
-    ekf_node.setDouble( "roll_deg", ekf->phi_rad * R2D );
-    ekf_node.setDouble( "pitch_deg", ekf->the_rad * R2D );
-    ekf_node.setDouble( "heading_deg", ekf->psi_rad * R2D );
-    ekf_node.setDouble( "p_bias", ekf->p_bias );
-    ekf_node.setDouble( "q_bias", ekf->q_bias );
-    ekf_node.setDouble( "r_bias", ekf->r_bias );
-    ekf_node.setDouble( "ax_bias", ekf->ax_bias );
-    ekf_node.setDouble( "ay_bias", ekf->ay_bias );
-    ekf_node.setDouble( "az_bias", ekf->az_bias );
-    ekf_node.setDouble( "max_pos_cov", ekf->max_pos_cov );
-    ekf_node.setDouble( "max_vel_cov", ekf->max_vel_cov );
-    ekf_node.setDouble( "max_att_cov", ekf->max_att_cov );
-    ekf_node.setLong("status", ekf->status );
+    ekf_node.setLong( "ekf_millis", ekf.millis() );
+    ekf_node.setDouble( "latitude_deg", ekf.lat_rad() * R2D );
+    ekf_node.setDouble( "longitude_deg", ekf.lon_rad() * R2D );
+    ekf_node.setDouble( "altitude_m", ekf.altitude_m() );
+    ekf_node.setDouble( "vn_ms", ekf.vn_ms() );
+    ekf_node.setDouble( "ve_ms", ekf.ve_ms() );
+    ekf_node.setDouble( "vd_ms", ekf.vd_ms() );
+    ekf_node.setDouble( "phi_rad", ekf.phi_rad() );
+    ekf_node.setDouble( "the_rad", ekf.the_rad() );
+    ekf_node.setDouble( "psi_rad", ekf.psi_rad() );
+    ekf_node.setDouble( "roll_deg", ekf.phi_rad() * R2D );
+    ekf_node.setDouble( "pitch_deg", ekf.the_rad() * R2D );
+    ekf_node.setDouble( "heading_deg", ekf.psi_rad() * R2D );
+    ekf_node.setDouble( "p_bias", ekf.p_bias() );
+    ekf_node.setDouble( "q_bias", ekf.q_bias() );
+    ekf_node.setDouble( "r_bias", ekf.r_bias() );
+    ekf_node.setDouble( "ax_bias", ekf.ax_bias() );
+    ekf_node.setDouble( "ay_bias", ekf.ay_bias() );
+    ekf_node.setDouble( "az_bias", ekf.az_bias() );
+    ekf_node.setDouble( "max_pos_cov", ekf.max_pos_cov() );
+    ekf_node.setDouble( "max_vel_cov", ekf.max_vel_cov() );
+    ekf_node.setDouble( "max_att_cov", ekf.max_att_cov() );
+    ekf_node.setLong("status", ekf.status() );
     
     /*FIXME:move the following to filter_mgr?*/
-    ekf_node.setDouble( "altitude_ft", ekf->altitude_m * M2F );
+    ekf_node.setDouble( "altitude_ft", ekf.altitude_m() * M2F );
     ekf_node.setDouble( "groundtrack_deg",
-                        90 - atan2(ekf->vn_ms, ekf->ve_ms) * R2D );
-    double gs_ms = sqrt(ekf->vn_ms * ekf->vn_ms + ekf->ve_ms * ekf->ve_ms);
+                        90 - atan2(ekf.vn_ms(), ekf.ve_ms()) * R2D );
+    double gs_ms = sqrt(ekf.vn_ms() * ekf.vn_ms() + ekf.ve_ms() * ekf.ve_ms());
     ekf_node.setDouble( "groundspeed_ms", gs_ms );
     ekf_node.setDouble( "groundspeed_kt", gs_ms * SG_MPS_TO_KT );
-    ekf_node.setDouble( "vertical_speed_fps", -ekf->vd_ms * M2F );
+    ekf_node.setDouble( "vertical_speed_fps", -ekf.vd_ms() * M2F );
     return true;
 }
 
-bool Aura4_t::update_gps( message::aura_nav_pvt_t *nav_pvt ) {
+bool Aura4_t::update_gps( const message::aura_nav_pvt_view_t &nav_pvt ) {
     gps_node.setDouble( "timestamp", get_Time() );
-    gps_node.setLong( "year", nav_pvt->year );
-    gps_node.setLong( "month", nav_pvt->month );
-    gps_node.setLong( "day", nav_pvt->day );
-    gps_node.setLong( "hour", nav_pvt->hour );
-    gps_node.setLong( "min", nav_pvt->min );
-    gps_node.setLong( "sec", nav_pvt->sec );
-    gps_node.setDouble( "latitude_deg", nav_pvt->lat / 10000000.0 );
-    gps_node.setDouble( "longitude_deg", nav_pvt->lon / 10000000.0 );
-    gps_node.setDouble( "altitude_m", nav_pvt->hMSL / 1000.0 );
-    gps_node.setDouble( "horiz_accuracy_m", nav_pvt->hAcc / 1000.0 );
-    gps_node.setDouble( "vert_accuracy_m", nav_pvt->vAcc / 1000.0 );
-    gps_node.setDouble( "vn_ms", nav_pvt->velN / 1000.0 );
-    gps_node.setDouble( "ve_ms", nav_pvt->velE / 1000.0 );
-    gps_node.setDouble( "vd_ms", nav_pvt->velD / 1000.0 );
-    gps_node.setLong( "satellites", nav_pvt->numSV);
-    gps_node.setDouble( "pdop", nav_pvt->pDOP / 100.0 );
-    gps_node.setLong( "fixType", nav_pvt->fixType );
+    gps_node.setLong( "year", nav_pvt.year() );
+    gps_node.setLong( "month", nav_pvt.month() );
+    gps_node.setLong( "day", nav_pvt.day() );
+    gps_node.setLong( "hour", nav_pvt.hour() );
+    gps_node.setLong( "min", nav_pvt.min() );
+    gps_node.setLong( "sec", nav_pvt.sec() );
+    gps_node.setDouble( "latitude_deg", nav_pvt.lat() / 10000000.0 );
+    gps_node.setDouble( "longitude_deg", nav_pvt.lon() / 10000000.0 );
+    gps_node.setDouble( "altitude_m", nav_pvt.hMSL() / 1000.0 );
+    gps_node.setDouble( "horiz_accuracy_m", nav_pvt.hAcc() / 1000.0 );
+    gps_node.setDouble( "vert_accuracy_m", nav_pvt.vAcc() / 1000.0 );
+    gps_node.setDouble( "vn_ms", nav_pvt.velN() / 1000.0 );
+    gps_node.setDouble( "ve_ms", nav_pvt.velE() / 1000.0 );
+    gps_node.setDouble( "vd_ms", nav_pvt.velD() / 1000.0 );
+    gps_node.setLong( "satellites", nav_pvt.numSV());
+    gps_node.setDouble( "pdop", nav_pvt.pDOP() / 100.0 );
+    gps_node.setLong( "fixType", nav_pvt.fixType() );
     // backwards compatibility
-    if ( nav_pvt->fixType == 0 ) {
+    if ( nav_pvt.fixType() == 0 ) {
         gps_node.setLong( "status", 0 );
-    } else if ( nav_pvt->fixType == 1 || nav_pvt->fixType == 2 ) {
+    } else if ( nav_pvt.fixType() == 1 || nav_pvt.fixType() == 2 ) {
         gps_node.setLong( "status", 1 );
-    } else if ( nav_pvt->fixType == 3 ) {
+    } else if ( nav_pvt.fixType() == 3 ) {
         gps_node.setLong( "status", 2 );
     }
     struct tm gps_time;
-    gps_time.tm_sec = nav_pvt->sec;
-    gps_time.tm_min = nav_pvt->min;
-    gps_time.tm_hour = nav_pvt->hour;
-    gps_time.tm_mday = nav_pvt->day;
-    gps_time.tm_mon = nav_pvt->month - 1;
-    gps_time.tm_year = nav_pvt->year - 1900;
+    gps_time.tm_sec = nav_pvt.sec();
+    gps_time.tm_min = nav_pvt.min();
+    gps_time.tm_hour = nav_pvt.hour();
+    gps_time.tm_mday = nav_pvt.day();
+    gps_time.tm_mon = nav_pvt.month() - 1;
+    gps_time.tm_year = nav_pvt.year() - 1900;
     double unix_sec = (double)mktime( &gps_time ) - timezone;
-    unix_sec += nav_pvt->nano / 1000000000.0;
+    unix_sec += nav_pvt.nano() / 1000000000.0;
     gps_node.setDouble( "unix_time_sec", unix_sec );
     return true;
 }
 
 
-bool Aura4_t::update_airdata( message::airdata_t *airdata ) {
+bool Aura4_t::update_airdata( const message::airdata_view_t &airdata ) {
     bool fresh_data = false;
 
-    float pitot_butter = pitot_filter.update(airdata->ext_diff_press_pa);
+    float pitot_butter = pitot_filter.update(airdata.ext_diff_press_pa());
         
     if ( ! airspeed_inited ) {
         if ( airspeed_zero_start_time > 0.0 ) {
-            pitot_sum += airdata->ext_diff_press_pa;
+            pitot_sum += airdata.ext_diff_press_pa();
             pitot_count++;
             pitot_offset = pitot_sum / (double)pitot_count;
             /* printf("a1 raw=%.1f filt=%.1f a1 off=%.1f a1 sum=%.1f a1 count=%d\n",
@@ -1098,15 +1131,15 @@ bool Aura4_t::update_airdata( message::airdata_t *airdata ) {
     float airspeed_kt = airspeed_mps * SG_MPS_TO_KT;
     airdata_node.setDouble( "airspeed_mps", airspeed_mps );
     airdata_node.setDouble( "airspeed_kt", airspeed_kt );
-    airdata_node.setDouble( "temp_C", airdata->ext_temp_C );
+    airdata_node.setDouble( "temp_C", airdata.ext_temp_C() );
 
     // publish sensor values
-    airdata_node.setDouble( "pressure_mbar", airdata->baro_press_pa / 100.0 );
-    airdata_node.setDouble( "bme_temp_C", airdata->baro_temp_C );
-    airdata_node.setDouble( "humidity", airdata->baro_hum );
-    airdata_node.setDouble( "diff_pressure_pa", airdata->ext_diff_press_pa );
-    airdata_node.setDouble( "ext_static_press_pa", airdata->ext_static_press_pa );
-    airdata_node.setLong( "error_count", airdata->error_count );
+    airdata_node.setDouble( "pressure_mbar", airdata.baro_press_pa() / 100.0 );
+    airdata_node.setDouble( "bme_temp_C", airdata.baro_temp_C() );
+    airdata_node.setDouble( "humidity", airdata.baro_hum() );
+    airdata_node.setDouble( "diff_pressure_pa", airdata.ext_diff_press_pa() );
+    airdata_node.setDouble( "ext_static_press_pa", airdata.ext_static_press_pa() );
+    airdata_node.setLong( "error_count", airdata.error_count() );
 
     fresh_data = true;
 
@@ -1123,35 +1156,35 @@ void Aura4_t::airdata_zero_airspeed() {
 }
 
 
-bool Aura4_t::update_pilot( message::pilot_t *pilot ) {
+bool Aura4_t::update_pilot( const message::pilot_view_t &pilot ) {
     float val;
 
     pilot_node.setDouble( "timestamp", get_Time() );
 
     for ( int i = 0; i < message::sbus_channels; i++ ) {
-	val = pilot->channel[i];
+	val = pilot.channel(i);
 	pilot_node.setDouble( pilot_mapping[i].c_str(), val );
 	pilot_node.setDouble( "channel", i, val );
     }
 
     // sbus ch17 (channel[16])
-    if ( pilot->flags & 0x01 ) {
+    if ( pilot.flags() & 0x01 ) {
         pilot_node.setDouble( "channel", 16, 1.0 );
     } else {
         pilot_node.setDouble( "channel", 16, 0.0 );
     }
     // sbus ch18 (channel[17])
-    if ( pilot->flags & (1 << 1) ) {
+    if ( pilot.flags() & (1 << 1) ) {
         pilot_node.setDouble( "channel", 17, 1.0 );
     } else {
         pilot_node.setDouble( "channel", 17, 0.0 );
     }
-    if ( pilot->flags & (1 << 2) ) {
+    if ( pilot.flags() & (1 << 2) ) {
         pilot_node.setBool( "frame_lost", true );
     } else {
         pilot_node.setBool( "frame_lost", false );
     }
-    if ( pilot->flags & (1 << 3) ) {
+    if ( pilot.flags() & (1 << 3) ) {
         pilot_node.setBool( "fail_safe", true );
     } else {
         pilot_node.setBool( "fail_safe", false );
@@ -1164,15 +1197,15 @@ bool Aura4_t::update_pilot( message::pilot_t *pilot ) {
 void Aura4_t::write() {
     // send actuator commands to Aura4 servo subsystem
     if ( message::ap_channels == 6 ) {
-        message::command_inceptors_t act;
-        act.channel[0] = act_node.getDouble("throttle");
-        act.channel[1] = act_node.getDouble("aileron");
-        act.channel[2] = act_node.getDouble("elevator");
-        act.channel[3] = act_node.getDouble("rudder");
-        act.channel[4] = act_node.getDouble("flaps");
-        act.channel[5] = act_node.getDouble("gear");
-        act.pack();
-        serial.write_packet( act.id, act.payload, act.len );
+        uint8_t payload[message::command_inceptors_builder_t::len];
+        message::command_inceptors_builder_t act(payload);
+        act.channel( 0, act_node.getDouble("throttle") );
+        act.channel( 1, act_node.getDouble("aileron") );
+        act.channel( 2, act_node.getDouble("elevator") );
+        act.channel( 3, act_node.getDouble("rudder") );
+        act.channel( 4, act_node.getDouble("flaps") );
+        act.channel( 5, act_node.getDouble("gear") );
+        serial.write_packet( act.id, payload, act.len );
     }
 }
 
@@ -13,8 +13,9 @@ using namespace Eigen;
 #include "drivers/driver.h"
 #include "include/globaldefs.h" /* fixme, get rid of? */
 #include "util/butter.h"
-#include "util/linearfit.h"
+#include "util/clock_sync.h"
 #include "util/lowpass.h"
+#include "util/props_record.h"
 #include "util/serial_link.h"
 
 #include "aura4_messages.h"
@@ -31,6 +32,10 @@ public:
     void write();
     void close();
     void command(const char *cmd);
+    bool has_packet_reader() { return true; }
+    bool read_packet( driver_packet_t *pkt );
+    int get_fd() { return reader ? -1 : serial.get_fd(); }
+    bool input_buffered() { return serial.bytes_buffered() > 0; }
 
 private:
     pyPropertyNode aura4_config;
@@ -43,20 +48,43 @@ private:
     pyPropertyNode power_node;
     pyPropertyNode act_node;
     pyPropertyNode status_node;
+
+    // imu values published as one record per imu packet (see
+    // init_imu())
+    struct imu_out_t {
+        double timestamp;
+        uint32_t imu_millis;
+        double imu_sec;
+        float p_rad_sec, q_rad_sec, r_rad_sec;
+        float ax_mps_sec, ay_mps_sec, az_mps_sec;
+        float hx, hy, hz;
+        float ax_raw, ay_raw, az_raw;
+        float hx_raw, hy_raw, hz_raw;
+        float temp_C;
+    };
+    prop_record_t imu_record;
     
     string device_name = "/dev/ttyS4";
     int baud = 500000;
     SerialLink serial;
+    driver_packet_t packet;     // the packet being parsed
     bool configuration_sent = false;
     int last_ack_id = 0;
     int last_ack_subid = 0;
     uint32_t parse_errors = 0;
     uint32_t skipped_frames = 0;
-    uint32_t airdata_packet_counter = 0;
-    uint32_t ekf_packet_counter = 0;
-    uint32_t gps_packet_counter = 0;
-    uint32_t imu_packet_counter = 0;
-    uint32_t pilot_packet_counter = 0;
+
+    // packet dispatch indexed by message id (see init_dispatch())
+    struct dispatch_t {
+        bool (*handler)( Aura4_t *self, const uint8_t *payload ) = NULL;
+        const char *name = "";
+        int len = 0;            // expected payload length
+        uint32_t count = 0;     // packets handled
+        uint32_t errors = 0;    // packets dropped for a bad length
+    };
+    dispatch_t dispatch[256];
+    uint32_t unknown_packets = 0;
+    double stats_time = 0.0;
 
     bool airspeed_inited = false;
     double airspeed_zero_start_time = 0.0;
@@ -71,8 +99,7 @@ private:
     LowPassFilter pitot_filt = LowPassFilter(0.2);
     
     double imu_timestamp = 0.0;
-    uint32_t last_imu_millis = 0;
-    LinearFitFilter imu_offset = LinearFitFilter(200.0, 0.01);
+    clock_sync_t imu_clock;     // FMU millis() -> host time
 
     string pilot_mapping[message::sbus_channels]; // channel->name mapping
     
@@ -94,7 +121,14 @@ private:
     void init_pilot( pyPropertyNode *config );
     void init_actuators( pyPropertyNode *config );
 
+    template <class V, bool (Aura4_t::*H)( const V & )>
+    static bool dispatch_view( Aura4_t *self, const uint8_t *payload );
+    template <class V, bool (Aura4_t::*H)( const V & )>
+    void add_handler( const char *name );
+    void init_dispatch();
+    bool next_packet();
     bool parse( uint8_t pkt_id, uint8_t pkt_len, uint8_t *payload );
+    void publish_stats();
     bool send_config();
     bool write_config_message(int id, uint8_t *payload, int len);
     bool write_command_zero_gyros();
@@ -102,11 +136,14 @@ private:
     bool write_command_reset_ekf();
     bool wait_for_ack(uint8_t id);
 
-    bool update_airdata( message::airdata_t *airdata );
-    bool update_ekf( message::ekf_t *ekf );
-    bool update_gps( message::aura_nav_pvt_t *nav_pvt );
-    bool update_imu( message::imu_t *imu );
-    bool update_pilot( message::pilot_t *pilot );
+    bool update_ack( const message::command_ack_view_t &ack );
+    bool update_airdata( const message::airdata_view_t &airdata );
+    bool update_ekf( const message::ekf_view_t &ekf );
+    bool update_gps( const message::aura_nav_pvt_view_t &nav_pvt );
+    bool update_imu( const message::imu_view_t &imu );
+    bool update_pilot( const message::pilot_view_t &pilot );
+    bool update_power( const message::power_view_t &power );
+    bool update_status( const message::status_view_t &msg );
     
     void airdata_zero_airspeed();
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>  // offsetof()
 #include <stdint.h>  // uint8_t, et. al.
 #include <string.h>  // memcpy()
 
@@ -98,6 +99,30 @@ struct command_ack_t {
     }
 };
 
+// Read-only view of a received command_ack message (no copy)
+struct command_ack_view_t {
+    static const uint8_t id = 10;
+    static const int len = 2;
+    const uint8_t *_p;
+    command_ack_view_t(const uint8_t *payload): _p(payload) {}
+    uint8_t command_id() const { uint8_t _v; memcpy(&_v, _p + 0, 1); return _v; }
+    uint8_t subcommand_id() const { uint8_t _v; memcpy(&_v, _p + 1, 1); return _v; }
+};
+
+// In-place builder for an outgoing command_ack message (writes len bytes)
+struct command_ack_builder_t {
+    static const uint8_t id = 10;
+    static const int len = 2;
+    uint8_t *_p;
+    command_ack_builder_t(uint8_t *payload): _p(payload) {}
+    void command_id(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 0, &_x, 1); }
+    void subcommand_id(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 1, &_x, 1); }
+};
+
+static_assert(sizeof(command_ack_t::_compact_t) == 2, "command_ack size");
+static_assert(offsetof(command_ack_t::_compact_t, command_id) == 0, "command_ack.command_id offset");
+static_assert(offsetof(command_ack_t::_compact_t, subcommand_id) == 1, "command_ack.subcommand_id offset");
+
 // Message: config_airdata (id: 11)
 struct config_airdata_t {
     // public fields
@@ -152,6 +177,36 @@ struct config_airdata_t {
     }
 };
 
+// Read-only view of a received config_airdata message (no copy)
+struct config_airdata_view_t {
+    static const uint8_t id = 11;
+    static const int len = 4;
+    const uint8_t *_p;
+    config_airdata_view_t(const uint8_t *payload): _p(payload) {}
+    uint8_t barometer() const { uint8_t _v; memcpy(&_v, _p + 0, 1); return _v; }
+    uint8_t pitot() const { uint8_t _v; memcpy(&_v, _p + 1, 1); return _v; }
+    uint8_t swift_baro_addr() const { uint8_t _v; memcpy(&_v, _p + 2, 1); return _v; }
+    uint8_t swift_pitot_addr() const { uint8_t _v; memcpy(&_v, _p + 3, 1); return _v; }
+};
+
+// In-place builder for an outgoing config_airdata message (writes len bytes)
+struct config_airdata_builder_t {
+    static const uint8_t id = 11;
+    static const int len = 4;
+    uint8_t *_p;
+    config_airdata_builder_t(uint8_t *payload): _p(payload) {}
+    void barometer(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 0, &_x, 1); }
+    void pitot(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 1, &_x, 1); }
+    void swift_baro_addr(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 2, &_x, 1); }
+    void swift_pitot_addr(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 3, &_x, 1); }
+};
+
+static_assert(sizeof(config_airdata_t::_compact_t) == 4, "config_airdata size");
+static_assert(offsetof(config_airdata_t::_compact_t, barometer) == 0, "config_airdata.barometer offset");
+static_assert(offsetof(config_airdata_t::_compact_t, pitot) == 1, "config_airdata.pitot offset");
+static_assert(offsetof(config_airdata_t::_compact_t, swift_baro_addr) == 2, "config_airdata.swift_baro_addr offset");
+static_assert(offsetof(config_airdata_t::_compact_t, swift_pitot_addr) == 3, "config_airdata.swift_pitot_addr offset");
+
 // Message: config_board (id: 12)
 struct config_board_t {
     // public fields
@@ -198,6 +253,30 @@ struct config_board_t {
     }
 };
 
+// Read-only view of a received config_board message (no copy)
+struct config_board_view_t {
+    static const uint8_t id = 12;
+    static const int len = 2;
+    const uint8_t *_p;
+    config_board_view_t(const uint8_t *payload): _p(payload) {}
+    uint8_t board() const { uint8_t _v; memcpy(&_v, _p + 0, 1); return _v; }
+    uint8_t led_pin() const { uint8_t _v; memcpy(&_v, _p + 1, 1); return _v; }
+};
+
+// In-place builder for an outgoing config_board message (writes len bytes)
+struct config_board_builder_t {
+    static const uint8_t id = 12;
+    static const int len = 2;
+    uint8_t *_p;
+    config_board_builder_t(uint8_t *payload): _p(payload) {}
+    void board(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 0, &_x, 1); }
+    void led_pin(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 1, &_x, 1); }
+};
+
+static_assert(sizeof(config_board_t::_compact_t) == 2, "config_board size");
+static_assert(offsetof(config_board_t::_compact_t, board) == 0, "config_board.board offset");
+static_assert(offsetof(config_board_t::_compact_t, led_pin) == 1, "config_board.led_pin offset");
+
 // Message: config_ekf (id: 13)
 struct config_ekf_t {
     // public fields
@@ -284,6 +363,60 @@ struct config_ekf_t {
     }
 };
 
+// Read-only view of a received config_ekf message (no copy)
+struct config_ekf_view_t {
+    static const uint8_t id = 13;
+    static const int len = 45;
+    const uint8_t *_p;
+    config_ekf_view_t(const uint8_t *payload): _p(payload) {}
+    enum_nav select() const { uint8_t _v; memcpy(&_v, _p + 0, 1); return (enum_nav)_v; }
+    float sig_w_accel() const { float _v; memcpy(&_v, _p + 1, 4); return _v; }
+    float sig_w_gyro() const { float _v; memcpy(&_v, _p + 5, 4); return _v; }
+    float sig_a_d() const { float _v; memcpy(&_v, _p + 9, 4); return _v; }
+    float tau_a() const { float _v; memcpy(&_v, _p + 13, 4); return _v; }
+    float sig_g_d() const { float _v; memcpy(&_v, _p + 17, 4); return _v; }
+    float tau_g() const { float _v; memcpy(&_v, _p + 21, 4); return _v; }
+    float sig_gps_p_ne() const { float _v; memcpy(&_v, _p + 25, 4); return _v; }
+    float sig_gps_p_d() const { float _v; memcpy(&_v, _p + 29, 4); return _v; }
+    float sig_gps_v_ne() const { float _v; memcpy(&_v, _p + 33, 4); return _v; }
+    float sig_gps_v_d() const { float _v; memcpy(&_v, _p + 37, 4); return _v; }
+    float sig_mag() const { float _v; memcpy(&_v, _p + 41, 4); return _v; }
+};
+
+// In-place builder for an outgoing config_ekf message (writes len bytes)
+struct config_ekf_builder_t {
+    static const uint8_t id = 13;
+    static const int len = 45;
+    uint8_t *_p;
+    config_ekf_builder_t(uint8_t *payload): _p(payload) {}
+    void select(enum_nav _v) { uint8_t _x = (uint8_t)_v; memcpy(_p + 0, &_x, 1); }
+    void sig_w_accel(float _v) { float _x = _v; memcpy(_p + 1, &_x, 4); }
+    void sig_w_gyro(float _v) { float _x = _v; memcpy(_p + 5, &_x, 4); }
+    void sig_a_d(float _v) { float _x = _v; memcpy(_p + 9, &_x, 4); }
+    void tau_a(float _v) { float _x = _v; memcpy(_p + 13, &_x, 4); }
+    void sig_g_d(float _v) { float _x = _v; memcpy(_p + 17, &_x, 4); }
+    void tau_g(float _v) { float _x = _v; memcpy(_p + 21, &_x, 4); }
+    void sig_gps_p_ne(float _v) { float _x = _v; memcpy(_p + 25, &_x, 4); }
+    void sig_gps_p_d(float _v) { float _x = _v; memcpy(_p + 29, &_x, 4); }
+    void sig_gps_v_ne(float _v) { float _x = _v; memcpy(_p + 33, &_x, 4); }
+    void sig_gps_v_d(float _v) { float _x = _v; memcpy(_p + 37, &_x, 4); }
+    void sig_mag(float _v) { float _x = _v; memcpy(_p + 41, &_x, 4); }
+};
+
+static_assert(sizeof(config_ekf_t::_compact_t) == 45, "config_ekf size");
+static_assert(offsetof(config_ekf_t::_compact_t, select) == 0, "config_ekf.select offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_w_accel) == 1, "config_ekf.sig_w_accel offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_w_gyro) == 5, "config_ekf.sig_w_gyro offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_a_d) == 9, "config_ekf.sig_a_d offset");
+static_assert(offsetof(config_ekf_t::_compact_t, tau_a) == 13, "config_ekf.tau_a offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_g_d) == 17, "config_ekf.sig_g_d offset");
+static_assert(offsetof(config_ekf_t::_compact_t, tau_g) == 21, "config_ekf.tau_g offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_gps_p_ne) == 25, "config_ekf.sig_gps_p_ne offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_gps_p_d) == 29, "config_ekf.sig_gps_p_d offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_gps_v_ne) == 33, "config_ekf.sig_gps_v_ne offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_gps_v_d) == 37, "config_ekf.sig_gps_v_d offset");
+static_assert(offsetof(config_ekf_t::_compact_t, sig_mag) == 41, "config_ekf.sig_mag offset");
+
 // Message: config_imu (id: 14)
 struct config_imu_t {
     // public fields
@@ -346,6 +479,42 @@ struct config_imu_t {
     }
 };
 
+// Read-only view of a received config_imu message (no copy)
+struct config_imu_view_t {
+    static const uint8_t id = 14;
+    static const int len = 126;
+    const uint8_t *_p;
+    config_imu_view_t(const uint8_t *payload): _p(payload) {}
+    uint8_t interface() const { uint8_t _v; memcpy(&_v, _p + 0, 1); return _v; }
+    uint8_t pin_or_address() const { uint8_t _v; memcpy(&_v, _p + 1, 1); return _v; }
+    float strapdown_calib(int _i) const { float _v; memcpy(&_v, _p + 2 + _i*4, 4); return _v; }
+    float accel_scale(int _i) const { float _v; memcpy(&_v, _p + 38 + _i*4, 4); return _v; }
+    float accel_translate(int _i) const { float _v; memcpy(&_v, _p + 50 + _i*4, 4); return _v; }
+    float mag_affine(int _i) const { float _v; memcpy(&_v, _p + 62 + _i*4, 4); return _v; }
+};
+
+// In-place builder for an outgoing config_imu message (writes len bytes)
+struct config_imu_builder_t {
+    static const uint8_t id = 14;
+    static const int len = 126;
+    uint8_t *_p;
+    config_imu_builder_t(uint8_t *payload): _p(payload) {}
+    void interface(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 0, &_x, 1); }
+    void pin_or_address(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 1, &_x, 1); }
+    void strapdown_calib(int _i, float _v) { float _x = _v; memcpy(_p + 2 + _i*4, &_x, 4); }
+    void accel_scale(int _i, float _v) { float _x = _v; memcpy(_p + 38 + _i*4, &_x, 4); }
+    void accel_translate(int _i, float _v) { float _x = _v; memcpy(_p + 50 + _i*4, &_x, 4); }
+    void mag_affine(int _i, float _v) { float _x = _v; memcpy(_p + 62 + _i*4, &_x, 4); }
+};
+
+static_assert(sizeof(config_imu_t::_compact_t) == 126, "config_imu size");
+static_assert(offsetof(config_imu_t::_compact_t, interface) == 0, "config_imu.interface offset");
+static_assert(offsetof(config_imu_t::_compact_t, pin_or_address) == 1, "config_imu.pin_or_address offset");
+static_assert(offsetof(config_imu_t::_compact_t, strapdown_calib) == 2, "config_imu.strapdown_calib offset");
+static_assert(offsetof(config_imu_t::_compact_t, accel_scale) == 38, "config_imu.accel_scale offset");
+static_assert(offsetof(config_imu_t::_compact_t, accel_translate) == 50, "config_imu.accel_translate offset");
+static_assert(offsetof(config_imu_t::_compact_t, mag_affine) == 62, "config_imu.mag_affine offset");
+
 // Message: config_mixer (id: 15)
 struct config_mixer_t {
     // public fields
@@ -456,6 +625,78 @@ struct config_mixer_t {
     }
 };
 
+// Read-only view of a received config_mixer message (no copy)
+struct config_mixer_view_t {
+    static const uint8_t id = 15;
+    static const int len = 51;
+    const uint8_t *_p;
+    config_mixer_view_t(const uint8_t *payload): _p(payload) {}
+    bool mix_autocoord() const { bool _v; memcpy(&_v, _p + 0, 1); return _v; }
+    bool mix_throttle_trim() const { bool _v; memcpy(&_v, _p + 1, 1); return _v; }
+    bool mix_flap_trim() const { bool _v; memcpy(&_v, _p + 2, 1); return _v; }
+    bool mix_elevon() const { bool _v; memcpy(&_v, _p + 3, 1); return _v; }
+    bool mix_flaperon() const { bool _v; memcpy(&_v, _p + 4, 1); return _v; }
+    bool mix_vtail() const { bool _v; memcpy(&_v, _p + 5, 1); return _v; }
+    bool mix_diff_thrust() const { bool _v; memcpy(&_v, _p + 6, 1); return _v; }
+    float mix_Gac() const { float _v; memcpy(&_v, _p + 7, 4); return _v; }
+    float mix_Get() const { float _v; memcpy(&_v, _p + 11, 4); return _v; }
+    float mix_Gef() const { float _v; memcpy(&_v, _p + 15, 4); return _v; }
+    float mix_Gea() const { float _v; memcpy(&_v, _p + 19, 4); return _v; }
+    float mix_Gee() const { float _v; memcpy(&_v, _p + 23, 4); return _v; }
+    float mix_Gfa() const { float _v; memcpy(&_v, _p + 27, 4); return _v; }
+    float mix_Gff() const { float _v; memcpy(&_v, _p + 31, 4); return _v; }
+    float mix_Gve() const { float _v; memcpy(&_v, _p + 35, 4); return _v; }
+    float mix_Gvr() const { float _v; memcpy(&_v, _p + 39, 4); return _v; }
+    float mix_Gtt() const { float _v; memcpy(&_v, _p + 43, 4); return _v; }
+    float mix_Gtr() const { float _v; memcpy(&_v, _p + 47, 4); return _v; }
+};
+
+// In-place builder for an outgoing config_mixer message (writes len bytes)
+struct config_mixer_builder_t {
+    static const uint8_t id = 15;
+    static const int len = 51;
+    uint8_t *_p;
+    config_mixer_builder_t(uint8_t *payload): _p(payload) {}
+    void mix_autocoord(bool _v) { bool _x = _v; memcpy(_p + 0, &_x, 1); }
+    void mix_throttle_trim(bool _v) { bool _x = _v; memcpy(_p + 1, &_x, 1); }
+    void mix_flap_trim(bool _v) { bool _x = _v; memcpy(_p + 2, &_x, 1); }
+    void mix_elevon(bool _v) { bool _x = _v; memcpy(_p + 3, &_x, 1); }
+    void mix_flaperon(bool _v) { bool _x = _v; memcpy(_p + 4, &_x, 1); }
+    void mix_vtail(bool _v) { bool _x = _v; memcpy(_p + 5, &_x, 1); }
+    void mix_diff_thrust(bool _v) { bool _x = _v; memcpy(_p + 6, &_x, 1); }
+    void mix_Gac(float _v) { float _x = _v; memcpy(_p + 7, &_x, 4); }
+    void mix_Get(float _v) { float _x = _v; memcpy(_p + 11, &_x, 4); }
+    void mix_Gef(float _v) { float _x = _v; memcpy(_p + 15, &_x, 4); }
+    void mix_Gea(float _v) { float _x = _v; memcpy(_p + 19, &_x, 4); }
+    void mix_Gee(float _v) { float _x = _v; memcpy(_p + 23, &_x, 4); }
+    void mix_Gfa(float _v) { float _x = _v; memcpy(_p + 27, &_x, 4); }
+    void mix_Gff(float _v) { float _x = _v; memcpy(_p + 31, &_x, 4); }
+    void mix_Gve(float _v) { float _x = _v; memcpy(_p + 35, &_x, 4); }
+    void mix_Gvr(float _v) { float _x = _v; memcpy(_p + 39, &_x, 4); }
+    void mix_Gtt(float _v) { float _x = _v; memcpy(_p + 43, &_x, 4); }
+    void mix_Gtr(float _v) { float _x = _v; memcpy(_p + 47, &_x, 4); }
+};
+
+static_assert(sizeof(config_mixer_t::_compact_t) == 51, "config_mixer size");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_autocoord) == 0, "config_mixer.mix_autocoord offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_throttle_trim) == 1, "config_mixer.mix_throttle_trim offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_flap_trim) == 2, "config_mixer.mix_flap_trim offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_elevon) == 3, "config_mixer.mix_elevon offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_flaperon) == 4, "config_mixer.mix_flaperon offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_vtail) == 5, "config_mixer.mix_vtail offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_diff_thrust) == 6, "config_mixer.mix_diff_thrust offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gac) == 7, "config_mixer.mix_Gac offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Get) == 11, "config_mixer.mix_Get offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gef) == 15, "config_mixer.mix_Gef offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gea) == 19, "config_mixer.mix_Gea offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gee) == 23, "config_mixer.mix_Gee offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gfa) == 27, "config_mixer.mix_Gfa offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gff) == 31, "config_mixer.mix_Gff offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gve) == 35, "config_mixer.mix_Gve offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gvr) == 39, "config_mixer.mix_Gvr offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gtt) == 43, "config_mixer.mix_Gtt offset");
+static_assert(offsetof(config_mixer_t::_compact_t, mix_Gtr) == 47, "config_mixer.mix_Gtr offset");
+
 // Message: config_mixer_matrix (id: 16)
 struct config_mixer_matrix_t {
     // public fields
@@ -498,6 +739,27 @@ struct config_mixer_matrix_t {
     }
 };
 
+// Read-only view of a received config_mixer_matrix message (no copy)
+struct config_mixer_matrix_view_t {
+    static const uint8_t id = 16;
+    static const int len = 128;
+    const uint8_t *_p;
+    config_mixer_matrix_view_t(const uint8_t *payload): _p(payload) {}
+    float matrix(int _i) const { int16_t _v; memcpy(&_v, _p + 0 + _i*2, 2); return _v / (float)16384; }
+};
+
+// In-place builder for an outgoing config_mixer_matrix message (writes len bytes)
+struct config_mixer_matrix_builder_t {
+    static const uint8_t id = 16;
+    static const int len = 128;
+    uint8_t *_p;
+    config_mixer_matrix_builder_t(uint8_t *payload): _p(payload) {}
+    void matrix(int _i, float _v) { int16_t _x = intround(_v * 16384); memcpy(_p + 0 + _i*2, &_x, 2); }
+};
+
+static_assert(sizeof(config_mixer_matrix_t::_compact_t) == 128, "config_mixer_matrix size");
+static_assert(offsetof(config_mixer_matrix_t::_compact_t, matrix) == 0, "config_mixer_matrix.matrix offset");
+
 // Message: config_power (id: 17)
 struct config_power_t {
     // public fields
@@ -540,6 +802,27 @@ struct config_power_t {
     }
 };
 
+// Read-only view of a received config_power message (no copy)
+struct config_power_view_t {
+    static const uint8_t id = 17;
+    static const int len = 1;
+    const uint8_t *_p;
+    config_power_view_t(const uint8_t *payload): _p(payload) {}
+    bool have_attopilot() const { bool _v; memcpy(&_v, _p + 0, 1); return _v; }
+};
+
+// In-place builder for an outgoing config_power message (writes len bytes)
+struct config_power_builder_t {
+    static const uint8_t id = 17;
+    static const int len = 1;
+    uint8_t *_p;
+    config_power_builder_t(uint8_t *payload): _p(payload) {}
+    void have_attopilot(bool _v) { bool _x = _v; memcpy(_p + 0, &_x, 1); }
+};
+
+static_assert(sizeof(config_power_t::_compact_t) == 1, "config_power size");
+static_assert(offsetof(config_power_t::_compact_t, have_attopilot) == 0, "config_power.have_attopilot offset");
+
 // Message: config_pwm (id: 18)
 struct config_pwm_t {
     // public fields
@@ -586,6 +869,30 @@ struct config_pwm_t {
     }
 };
 
+// Read-only view of a received config_pwm message (no copy)
+struct config_pwm_view_t {
+    static const uint8_t id = 18;
+    static const int len = 34;
+    const uint8_t *_p;
+    config_pwm_view_t(const uint8_t *payload): _p(payload) {}
+    uint16_t pwm_hz() const { uint16_t _v; memcpy(&_v, _p + 0, 2); return _v; }
+    float act_gain(int _i) const { float _v; memcpy(&_v, _p + 2 + _i*4, 4); return _v; }
+};
+
+// In-place builder for an outgoing config_pwm message (writes len bytes)
+struct config_pwm_builder_t {
+    static const uint8_t id = 18;
+    static const int len = 34;
+    uint8_t *_p;
+    config_pwm_builder_t(uint8_t *payload): _p(payload) {}
+    void pwm_hz(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 0, &_x, 2); }
+    void act_gain(int _i, float _v) { float _x = _v; memcpy(_p + 2 + _i*4, &_x, 4); }
+};
+
+static_assert(sizeof(config_pwm_t::_compact_t) == 34, "config_pwm size");
+static_assert(offsetof(config_pwm_t::_compact_t, pwm_hz) == 0, "config_pwm.pwm_hz offset");
+static_assert(offsetof(config_pwm_t::_compact_t, act_gain) == 2, "config_pwm.act_gain offset");
+
 // Message: config_stability_damping (id: 19)
 struct config_stability_damping_t {
     // public fields
@@ -656,6 +963,48 @@ struct config_stability_damping_t {
     }
 };
 
+// Read-only view of a received config_stability_damping message (no copy)
+struct config_stability_damping_view_t {
+    static const uint8_t id = 19;
+    static const int len = 20;
+    const uint8_t *_p;
+    config_stability_damping_view_t(const uint8_t *payload): _p(payload) {}
+    bool sas_rollaxis() const { bool _v; memcpy(&_v, _p + 0, 1); return _v; }
+    bool sas_pitchaxis() const { bool _v; memcpy(&_v, _p + 1, 1); return _v; }
+    bool sas_yawaxis() const { bool _v; memcpy(&_v, _p + 2, 1); return _v; }
+    bool sas_tune() const { bool _v; memcpy(&_v, _p + 3, 1); return _v; }
+    float sas_rollgain() const { float _v; memcpy(&_v, _p + 4, 4); return _v; }
+    float sas_pitchgain() const { float _v; memcpy(&_v, _p + 8, 4); return _v; }
+    float sas_yawgain() const { float _v; memcpy(&_v, _p + 12, 4); return _v; }
+    float sas_max_gain() const { float _v; memcpy(&_v, _p + 16, 4); return _v; }
+};
+
+// In-place builder for an outgoing config_stability_damping message (writes len bytes)
+struct config_stability_damping_builder_t {
+    static const uint8_t id = 19;
+    static const int len = 20;
+    uint8_t *_p;
+    config_stability_damping_builder_t(uint8_t *payload): _p(payload) {}
+    void sas_rollaxis(bool _v) { bool _x = _v; memcpy(_p + 0, &_x, 1); }
+    void sas_pitchaxis(bool _v) { bool _x = _v; memcpy(_p + 1, &_x, 1); }
+    void sas_yawaxis(bool _v) { bool _x = _v; memcpy(_p + 2, &_x, 1); }
+    void sas_tune(bool _v) { bool _x = _v; memcpy(_p + 3, &_x, 1); }
+    void sas_rollgain(float _v) { float _x = _v; memcpy(_p + 4, &_x, 4); }
+    void sas_pitchgain(float _v) { float _x = _v; memcpy(_p + 8, &_x, 4); }
+    void sas_yawgain(float _v) { float _x = _v; memcpy(_p + 12, &_x, 4); }
+    void sas_max_gain(float _v) { float _x = _v; memcpy(_p + 16, &_x, 4); }
+};
+
+static_assert(sizeof(config_stability_damping_t::_compact_t) == 20, "config_stability_damping size");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_rollaxis) == 0, "config_stability_damping.sas_rollaxis offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_pitchaxis) == 1, "config_stability_damping.sas_pitchaxis offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_yawaxis) == 2, "config_stability_damping.sas_yawaxis offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_tune) == 3, "config_stability_damping.sas_tune offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_rollgain) == 4, "config_stability_damping.sas_rollgain offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_pitchgain) == 8, "config_stability_damping.sas_pitchgain offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_yawgain) == 12, "config_stability_damping.sas_yawgain offset");
+static_assert(offsetof(config_stability_damping_t::_compact_t, sas_max_gain) == 16, "config_stability_damping.sas_max_gain offset");
+
 // Message: command_inceptors (id: 20)
 struct command_inceptors_t {
     // public fields
@@ -698,6 +1047,27 @@ struct command_inceptors_t {
     }
 };
 
+// Read-only view of a received command_inceptors message (no copy)
+struct command_inceptors_view_t {
+    static const uint8_t id = 20;
+    static const int len = 12;
+    const uint8_t *_p;
+    command_inceptors_view_t(const uint8_t *payload): _p(payload) {}
+    float channel(int _i) const { int16_t _v; memcpy(&_v, _p + 0 + _i*2, 2); return _v / (float)16384; }
+};
+
+// In-place builder for an outgoing command_inceptors message (writes len bytes)
+struct command_inceptors_builder_t {
+    static const uint8_t id = 20;
+    static const int len = 12;
+    uint8_t *_p;
+    command_inceptors_builder_t(uint8_t *payload): _p(payload) {}
+    void channel(int _i, float _v) { int16_t _x = intround(_v * 16384); memcpy(_p + 0 + _i*2, &_x, 2); }
+};
+
+static_assert(sizeof(command_inceptors_t::_compact_t) == 12, "command_inceptors size");
+static_assert(offsetof(command_inceptors_t::_compact_t, channel) == 0, "command_inceptors.channel offset");
+
 // Message: command_zero_gyros (id: 21)
 struct command_zero_gyros_t {
     // public fields
@@ -733,6 +1103,24 @@ struct command_zero_gyros_t {
     }
 };
 
+// Read-only view of a received command_zero_gyros message (no copy)
+struct command_zero_gyros_view_t {
+    static const uint8_t id = 21;
+    static const int len = 1;
+    const uint8_t *_p;
+    command_zero_gyros_view_t(const uint8_t *payload): _p(payload) {}
+};
+
+// In-place builder for an outgoing command_zero_gyros message (writes len bytes)
+struct command_zero_gyros_builder_t {
+    static const uint8_t id = 21;
+    static const int len = 1;
+    uint8_t *_p;
+    command_zero_gyros_builder_t(uint8_t *payload): _p(payload) {}
+};
+
+static_assert(sizeof(command_zero_gyros_t::_compact_t) == 1, "command_zero_gyros size");
+
 // Message: command_reset_ekf (id: 22)
 struct command_reset_ekf_t {
     // public fields
@@ -768,6 +1156,24 @@ struct command_reset_ekf_t {
     }
 };
 
+// Read-only view of a received command_reset_ekf message (no copy)
+struct command_reset_ekf_view_t {
+    static const uint8_t id = 22;
+    static const int len = 1;
+    const uint8_t *_p;
+    command_reset_ekf_view_t(const uint8_t *payload): _p(payload) {}
+};
+
+// In-place builder for an outgoing command_reset_ekf message (writes len bytes)
+struct command_reset_ekf_builder_t {
+    static const uint8_t id = 22;
+    static const int len = 1;
+    uint8_t *_p;
+    command_reset_ekf_builder_t(uint8_t *payload): _p(payload) {}
+};
+
+static_assert(sizeof(command_reset_ekf_t::_compact_t) == 1, "command_reset_ekf size");
+
 // Message: command_cycle_inceptors (id: 23)
 struct command_cycle_inceptors_t {
     // public fields
@@ -803,6 +1209,24 @@ struct command_cycle_inceptors_t {
     }
 };
 
+// Read-only view of a received command_cycle_inceptors message (no copy)
+struct command_cycle_inceptors_view_t {
+    static const uint8_t id = 23;
+    static const int len = 1;
+    const uint8_t *_p;
+    command_cycle_inceptors_view_t(const uint8_t *payload): _p(payload) {}
+};
+
+// In-place builder for an outgoing command_cycle_inceptors message (writes len bytes)
+struct command_cycle_inceptors_builder_t {
+    static const uint8_t id = 23;
+    static const int len = 1;
+    uint8_t *_p;
+    command_cycle_inceptors_builder_t(uint8_t *payload): _p(payload) {}
+};
+
+static_assert(sizeof(command_cycle_inceptors_t::_compact_t) == 1, "command_cycle_inceptors size");
+
 // Message: pilot (id: 24)
 struct pilot_t {
     // public fields
@@ -849,6 +1273,30 @@ struct pilot_t {
     }
 };
 
+// Read-only view of a received pilot message (no copy)
+struct pilot_view_t {
+    static const uint8_t id = 24;
+    static const int len = 33;
+    const uint8_t *_p;
+    pilot_view_t(const uint8_t *payload): _p(payload) {}
+    float channel(int _i) const { int16_t _v; memcpy(&_v, _p + 0 + _i*2, 2); return _v / (float)16384; }
+    uint8_t flags() const { uint8_t _v; memcpy(&_v, _p + 32, 1); return _v; }
+};
+
+// In-place builder for an outgoing pilot message (writes len bytes)
+struct pilot_builder_t {
+    static const uint8_t id = 24;
+    static const int len = 33;
+    uint8_t *_p;
+    pilot_builder_t(uint8_t *payload): _p(payload) {}
+    void channel(int _i, float _v) { int16_t _x = intround(_v * 16384); memcpy(_p + 0 + _i*2, &_x, 2); }
+    void flags(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 32, &_x, 1); }
+};
+
+static_assert(sizeof(pilot_t::_compact_t) == 33, "pilot size");
+static_assert(offsetof(pilot_t::_compact_t, channel) == 0, "pilot.channel offset");
+static_assert(offsetof(pilot_t::_compact_t, flags) == 32, "pilot.flags offset");
+
 // Message: imu (id: 25)
 struct imu_t {
     // public fields
@@ -899,6 +1347,33 @@ struct imu_t {
     }
 };
 
+// Read-only view of a received imu message (no copy)
+struct imu_view_t {
+    static const uint8_t id = 25;
+    static const int len = 36;
+    const uint8_t *_p;
+    imu_view_t(const uint8_t *payload): _p(payload) {}
+    uint32_t millis() const { uint32_t _v; memcpy(&_v, _p + 0, 4); return _v; }
+    int16_t raw(int _i) const { int16_t _v; memcpy(&_v, _p + 4 + _i*2, 2); return _v; }
+    int16_t cal(int _i) const { int16_t _v; memcpy(&_v, _p + 16 + _i*2, 2); return _v; }
+};
+
+// In-place builder for an outgoing imu message (writes len bytes)
+struct imu_builder_t {
+    static const uint8_t id = 25;
+    static const int len = 36;
+    uint8_t *_p;
+    imu_builder_t(uint8_t *payload): _p(payload) {}
+    void millis(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 0, &_x, 4); }
+    void raw(int _i, int16_t _v) { int16_t _x = _v; memcpy(_p + 4 + _i*2, &_x, 2); }
+    void cal(int _i, int16_t _v) { int16_t _x = _v; memcpy(_p + 16 + _i*2, &_x, 2); }
+};
+
+static_assert(sizeof(imu_t::_compact_t) == 36, "imu size");
+static_assert(offsetof(imu_t::_compact_t, millis) == 0, "imu.millis offset");
+static_assert(offsetof(imu_t::_compact_t, raw) == 4, "imu.raw offset");
+static_assert(offsetof(imu_t::_compact_t, cal) == 16, "imu.cal offset");
+
 // Message: aura_nav_pvt (id: 26)
 struct aura_nav_pvt_t {
     // public fields
@@ -1065,6 +1540,120 @@ struct aura_nav_pvt_t {
     }
 };
 
+// Read-only view of a received aura_nav_pvt message (no copy)
+struct aura_nav_pvt_view_t {
+    static const uint8_t id = 26;
+    static const int len = 92;
+    const uint8_t *_p;
+    aura_nav_pvt_view_t(const uint8_t *payload): _p(payload) {}
+    uint32_t iTOW() const { uint32_t _v; memcpy(&_v, _p + 0, 4); return _v; }
+    int16_t year() const { int16_t _v; memcpy(&_v, _p + 4, 2); return _v; }
+    uint8_t month() const { uint8_t _v; memcpy(&_v, _p + 6, 1); return _v; }
+    uint8_t day() const { uint8_t _v; memcpy(&_v, _p + 7, 1); return _v; }
+    uint8_t hour() const { uint8_t _v; memcpy(&_v, _p + 8, 1); return _v; }
+    uint8_t min() const { uint8_t _v; memcpy(&_v, _p + 9, 1); return _v; }
+    uint8_t sec() const { uint8_t _v; memcpy(&_v, _p + 10, 1); return _v; }
+    uint8_t valid() const { uint8_t _v; memcpy(&_v, _p + 11, 1); return _v; }
+    uint32_t tAcc() const { uint32_t _v; memcpy(&_v, _p + 12, 4); return _v; }
+    int32_t nano() const { int32_t _v; memcpy(&_v, _p + 16, 4); return _v; }
+    uint8_t fixType() const { uint8_t _v; memcpy(&_v, _p + 20, 1); return _v; }
+    uint8_t flags() const { uint8_t _v; memcpy(&_v, _p + 21, 1); return _v; }
+    uint8_t flags2() const { uint8_t _v; memcpy(&_v, _p + 22, 1); return _v; }
+    uint8_t numSV() const { uint8_t _v; memcpy(&_v, _p + 23, 1); return _v; }
+    int32_t lon() const { int32_t _v; memcpy(&_v, _p + 24, 4); return _v; }
+    int32_t lat() const { int32_t _v; memcpy(&_v, _p + 28, 4); return _v; }
+    int32_t height() const { int32_t _v; memcpy(&_v, _p + 32, 4); return _v; }
+    int32_t hMSL() const { int32_t _v; memcpy(&_v, _p + 36, 4); return _v; }
+    uint32_t hAcc() const { uint32_t _v; memcpy(&_v, _p + 40, 4); return _v; }
+    uint32_t vAcc() const { uint32_t _v; memcpy(&_v, _p + 44, 4); return _v; }
+    int32_t velN() const { int32_t _v; memcpy(&_v, _p + 48, 4); return _v; }
+    int32_t velE() const { int32_t _v; memcpy(&_v, _p + 52, 4); return _v; }
+    int32_t velD() const { int32_t _v; memcpy(&_v, _p + 56, 4); return _v; }
+    uint32_t gSpeed() const { uint32_t _v; memcpy(&_v, _p + 60, 4); return _v; }
+    int32_t heading() const { int32_t _v; memcpy(&_v, _p + 64, 4); return _v; }
+    uint32_t sAcc() const { uint32_t _v; memcpy(&_v, _p + 68, 4); return _v; }
+    uint32_t headingAcc() const { uint32_t _v; memcpy(&_v, _p + 72, 4); return _v; }
+    uint16_t pDOP() const { uint16_t _v; memcpy(&_v, _p + 76, 2); return _v; }
+    uint8_t reserved(int _i) const { uint8_t _v; memcpy(&_v, _p + 78 + _i*1, 1); return _v; }
+    int32_t headVeh() const { int32_t _v; memcpy(&_v, _p + 84, 4); return _v; }
+    int16_t magDec() const { int16_t _v; memcpy(&_v, _p + 88, 2); return _v; }
+    uint16_t magAcc() const { uint16_t _v; memcpy(&_v, _p + 90, 2); return _v; }
+};
+
+// In-place builder for an outgoing aura_nav_pvt message (writes len bytes)
+struct aura_nav_pvt_builder_t {
+    static const uint8_t id = 26;
+    static const int len = 92;
+    uint8_t *_p;
+    aura_nav_pvt_builder_t(uint8_t *payload): _p(payload) {}
+    void iTOW(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 0, &_x, 4); }
+    void year(int16_t _v) { int16_t _x = _v; memcpy(_p + 4, &_x, 2); }
+    void month(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 6, &_x, 1); }
+    void day(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 7, &_x, 1); }
+    void hour(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 8, &_x, 1); }
+    void min(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 9, &_x, 1); }
+    void sec(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 10, &_x, 1); }
+    void valid(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 11, &_x, 1); }
+    void tAcc(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 12, &_x, 4); }
+    void nano(int32_t _v) { int32_t _x = _v; memcpy(_p + 16, &_x, 4); }
+    void fixType(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 20, &_x, 1); }
+    void flags(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 21, &_x, 1); }
+    void flags2(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 22, &_x, 1); }
+    void numSV(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 23, &_x, 1); }
+    void lon(int32_t _v) { int32_t _x = _v; memcpy(_p + 24, &_x, 4); }
+    void lat(int32_t _v) { int32_t _x = _v; memcpy(_p + 28, &_x, 4); }
+    void height(int32_t _v) { int32_t _x = _v; memcpy(_p + 32, &_x, 4); }
+    void hMSL(int32_t _v) { int32_t _x = _v; memcpy(_p + 36, &_x, 4); }
+    void hAcc(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 40, &_x, 4); }
+    void vAcc(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 44, &_x, 4); }
+    void velN(int32_t _v) { int32_t _x = _v; memcpy(_p + 48, &_x, 4); }
+    void velE(int32_t _v) { int32_t _x = _v; memcpy(_p + 52, &_x, 4); }
+    void velD(int32_t _v) { int32_t _x = _v; memcpy(_p + 56, &_x, 4); }
+    void gSpeed(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 60, &_x, 4); }
+    void heading(int32_t _v) { int32_t _x = _v; memcpy(_p + 64, &_x, 4); }
+    void sAcc(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 68, &_x, 4); }
+    void headingAcc(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 72, &_x, 4); }
+    void pDOP(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 76, &_x, 2); }
+    void reserved(int _i, uint8_t _v) { uint8_t _x = _v; memcpy(_p + 78 + _i*1, &_x, 1); }
+    void headVeh(int32_t _v) { int32_t _x = _v; memcpy(_p + 84, &_x, 4); }
+    void magDec(int16_t _v) { int16_t _x = _v; memcpy(_p + 88, &_x, 2); }
+    void magAcc(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 90, &_x, 2); }
+};
+
+static_assert(sizeof(aura_nav_pvt_t::_compact_t) == 92, "aura_nav_pvt size");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, iTOW) == 0, "aura_nav_pvt.iTOW offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, year) == 4, "aura_nav_pvt.year offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, month) == 6, "aura_nav_pvt.month offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, day) == 7, "aura_nav_pvt.day offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, hour) == 8, "aura_nav_pvt.hour offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, min) == 9, "aura_nav_pvt.min offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, sec) == 10, "aura_nav_pvt.sec offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, valid) == 11, "aura_nav_pvt.valid offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, tAcc) == 12, "aura_nav_pvt.tAcc offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, nano) == 16, "aura_nav_pvt.nano offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, fixType) == 20, "aura_nav_pvt.fixType offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, flags) == 21, "aura_nav_pvt.flags offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, flags2) == 22, "aura_nav_pvt.flags2 offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, numSV) == 23, "aura_nav_pvt.numSV offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, lon) == 24, "aura_nav_pvt.lon offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, lat) == 28, "aura_nav_pvt.lat offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, height) == 32, "aura_nav_pvt.height offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, hMSL) == 36, "aura_nav_pvt.hMSL offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, hAcc) == 40, "aura_nav_pvt.hAcc offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, vAcc) == 44, "aura_nav_pvt.vAcc offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, velN) == 48, "aura_nav_pvt.velN offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, velE) == 52, "aura_nav_pvt.velE offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, velD) == 56, "aura_nav_pvt.velD offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, gSpeed) == 60, "aura_nav_pvt.gSpeed offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, heading) == 64, "aura_nav_pvt.heading offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, sAcc) == 68, "aura_nav_pvt.sAcc offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, headingAcc) == 72, "aura_nav_pvt.headingAcc offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, pDOP) == 76, "aura_nav_pvt.pDOP offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, reserved) == 78, "aura_nav_pvt.reserved offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, headVeh) == 84, "aura_nav_pvt.headVeh offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, magDec) == 88, "aura_nav_pvt.magDec offset");
+static_assert(offsetof(aura_nav_pvt_t::_compact_t, magAcc) == 90, "aura_nav_pvt.magAcc offset");
+
 // Message: airdata (id: 27)
 struct airdata_t {
     // public fields
@@ -1131,6 +1720,45 @@ struct airdata_t {
     }
 };
 
+// Read-only view of a received airdata message (no copy)
+struct airdata_view_t {
+    static const uint8_t id = 27;
+    static const int len = 26;
+    const uint8_t *_p;
+    airdata_view_t(const uint8_t *payload): _p(payload) {}
+    float baro_press_pa() const { float _v; memcpy(&_v, _p + 0, 4); return _v; }
+    float baro_temp_C() const { float _v; memcpy(&_v, _p + 4, 4); return _v; }
+    float baro_hum() const { float _v; memcpy(&_v, _p + 8, 4); return _v; }
+    float ext_diff_press_pa() const { float _v; memcpy(&_v, _p + 12, 4); return _v; }
+    float ext_static_press_pa() const { float _v; memcpy(&_v, _p + 16, 4); return _v; }
+    float ext_temp_C() const { float _v; memcpy(&_v, _p + 20, 4); return _v; }
+    uint16_t error_count() const { uint16_t _v; memcpy(&_v, _p + 24, 2); return _v; }
+};
+
+// In-place builder for an outgoing airdata message (writes len bytes)
+struct airdata_builder_t {
+    static const uint8_t id = 27;
+    static const int len = 26;
+    uint8_t *_p;
+    airdata_builder_t(uint8_t *payload): _p(payload) {}
+    void baro_press_pa(float _v) { float _x = _v; memcpy(_p + 0, &_x, 4); }
+    void baro_temp_C(float _v) { float _x = _v; memcpy(_p + 4, &_x, 4); }
+    void baro_hum(float _v) { float _x = _v; memcpy(_p + 8, &_x, 4); }
+    void ext_diff_press_pa(float _v) { float _x = _v; memcpy(_p + 12, &_x, 4); }
+    void ext_static_press_pa(float _v) { float _x = _v; memcpy(_p + 16, &_x, 4); }
+    void ext_temp_C(float _v) { float _x = _v; memcpy(_p + 20, &_x, 4); }
+    void error_count(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 24, &_x, 2); }
+};
+
+static_assert(sizeof(airdata_t::_compact_t) == 26, "airdata size");
+static_assert(offsetof(airdata_t::_compact_t, baro_press_pa) == 0, "airdata.baro_press_pa offset");
+static_assert(offsetof(airdata_t::_compact_t, baro_temp_C) == 4, "airdata.baro_temp_C offset");
+static_assert(offsetof(airdata_t::_compact_t, baro_hum) == 8, "airdata.baro_hum offset");
+static_assert(offsetof(airdata_t::_compact_t, ext_diff_press_pa) == 12, "airdata.ext_diff_press_pa offset");
+static_assert(offsetof(airdata_t::_compact_t, ext_static_press_pa) == 16, "airdata.ext_static_press_pa offset");
+static_assert(offsetof(airdata_t::_compact_t, ext_temp_C) == 20, "airdata.ext_temp_C offset");
+static_assert(offsetof(airdata_t::_compact_t, error_count) == 24, "airdata.error_count offset");
+
 // Message: power (id: 28)
 struct power_t {
     // public fields
@@ -1185,6 +1813,36 @@ struct power_t {
     }
 };
 
+// Read-only view of a received power message (no copy)
+struct power_view_t {
+    static const uint8_t id = 28;
+    static const int len = 8;
+    const uint8_t *_p;
+    power_view_t(const uint8_t *payload): _p(payload) {}
+    float int_main_v() const { uint16_t _v; memcpy(&_v, _p + 0, 2); return _v / (float)100; }
+    float avionics_v() const { uint16_t _v; memcpy(&_v, _p + 2, 2); return _v / (float)100; }
+    float ext_main_v() const { uint16_t _v; memcpy(&_v, _p + 4, 2); return _v / (float)100; }
+    float ext_main_amp() const { uint16_t _v; memcpy(&_v, _p + 6, 2); return _v / (float)100; }
+};
+
+// In-place builder for an outgoing power message (writes len bytes)
+struct power_builder_t {
+    static const uint8_t id = 28;
+    static const int len = 8;
+    uint8_t *_p;
+    power_builder_t(uint8_t *payload): _p(payload) {}
+    void int_main_v(float _v) { uint16_t _x = uintround(_v * 100); memcpy(_p + 0, &_x, 2); }
+    void avionics_v(float _v) { uint16_t _x = uintround(_v * 100); memcpy(_p + 2, &_x, 2); }
+    void ext_main_v(float _v) { uint16_t _x = uintround(_v * 100); memcpy(_p + 4, &_x, 2); }
+    void ext_main_amp(float _v) { uint16_t _x = uintround(_v * 100); memcpy(_p + 6, &_x, 2); }
+};
+
+static_assert(sizeof(power_t::_compact_t) == 8, "power size");
+static_assert(offsetof(power_t::_compact_t, int_main_v) == 0, "power.int_main_v offset");
+static_assert(offsetof(power_t::_compact_t, avionics_v) == 2, "power.avionics_v offset");
+static_assert(offsetof(power_t::_compact_t, ext_main_v) == 4, "power.ext_main_v offset");
+static_assert(offsetof(power_t::_compact_t, ext_main_amp) == 6, "power.ext_main_amp offset");
+
 // Message: status (id: 29)
 struct status_t {
     // public fields
@@ -1247,6 +1905,42 @@ struct status_t {
     }
 };
 
+// Read-only view of a received status message (no copy)
+struct status_view_t {
+    static const uint8_t id = 29;
+    static const int len = 14;
+    const uint8_t *_p;
+    status_view_t(const uint8_t *payload): _p(payload) {}
+    uint16_t serial_number() const { uint16_t _v; memcpy(&_v, _p + 0, 2); return _v; }
+    uint16_t firmware_rev() const { uint16_t _v; memcpy(&_v, _p + 2, 2); return _v; }
+    uint16_t master_hz() const { uint16_t _v; memcpy(&_v, _p + 4, 2); return _v; }
+    uint32_t baud() const { uint32_t _v; memcpy(&_v, _p + 6, 4); return _v; }
+    uint16_t byte_rate() const { uint16_t _v; memcpy(&_v, _p + 10, 2); return _v; }
+    uint16_t timer_misses() const { uint16_t _v; memcpy(&_v, _p + 12, 2); return _v; }
+};
+
+// In-place builder for an outgoing status message (writes len bytes)
+struct status_builder_t {
+    static const uint8_t id = 29;
+    static const int len = 14;
+    uint8_t *_p;
+    status_builder_t(uint8_t *payload): _p(payload) {}
+    void serial_number(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 0, &_x, 2); }
+    void firmware_rev(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 2, &_x, 2); }
+    void master_hz(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 4, &_x, 2); }
+    void baud(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 6, &_x, 4); }
+    void byte_rate(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 10, &_x, 2); }
+    void timer_misses(uint16_t _v) { uint16_t _x = _v; memcpy(_p + 12, &_x, 2); }
+};
+
+static_assert(sizeof(status_t::_compact_t) == 14, "status size");
+static_assert(offsetof(status_t::_compact_t, serial_number) == 0, "status.serial_number offset");
+static_assert(offsetof(status_t::_compact_t, firmware_rev) == 2, "status.firmware_rev offset");
+static_assert(offsetof(status_t::_compact_t, master_hz) == 4, "status.master_hz offset");
+static_assert(offsetof(status_t::_compact_t, baud) == 6, "status.baud offset");
+static_assert(offsetof(status_t::_compact_t, byte_rate) == 10, "status.byte_rate offset");
+static_assert(offsetof(status_t::_compact_t, timer_misses) == 12, "status.timer_misses offset");
+
 // Message: ekf (id: 30)
 struct ekf_t {
     // public fields
@@ -1365,4 +2059,82 @@ struct ekf_t {
     }
 };
 
+// Read-only view of a received ekf message (no copy)
+struct ekf_view_t {
+    static const uint8_t id = 30;
+    static const int len = 79;
+    const uint8_t *_p;
+    ekf_view_t(const uint8_t *payload): _p(payload) {}
+    uint32_t millis() const { uint32_t _v; memcpy(&_v, _p + 0, 4); return _v; }
+    double lat_rad() const { double _v; memcpy(&_v, _p + 4, 8); return _v; }
+    double lon_rad() const { double _v; memcpy(&_v, _p + 12, 8); return _v; }
+    float altitude_m() const { float _v; memcpy(&_v, _p + 20, 4); return _v; }
+    float vn_ms() const { float _v; memcpy(&_v, _p + 24, 4); return _v; }
+    float ve_ms() const { float _v; memcpy(&_v, _p + 28, 4); return _v; }
+    float vd_ms() const { float _v; memcpy(&_v, _p + 32, 4); return _v; }
+    float phi_rad() const { float _v; memcpy(&_v, _p + 36, 4); return _v; }
+    float the_rad() const { float _v; memcpy(&_v, _p + 40, 4); return _v; }
+    float psi_rad() const { float _v; memcpy(&_v, _p + 44, 4); return _v; }
+    float p_bias() const { float _v; memcpy(&_v, _p + 48, 4); return _v; }
+    float q_bias() const { float _v; memcpy(&_v, _p + 52, 4); return _v; }
+    float r_bias() const { float _v; memcpy(&_v, _p + 56, 4); return _v; }
+    float ax_bias() const { float _v; memcpy(&_v, _p + 60, 4); return _v; }
+    float ay_bias() const { float _v; memcpy(&_v, _p + 64, 4); return _v; }
+    float az_bias() const { float _v; memcpy(&_v, _p + 68, 4); return _v; }
+    float max_pos_cov() const { uint16_t _v; memcpy(&_v, _p + 72, 2); return _v / (float)100; }
+    float max_vel_cov() const { uint16_t _v; memcpy(&_v, _p + 74, 2); return _v / (float)1000; }
+    float max_att_cov() const { uint16_t _v; memcpy(&_v, _p + 76, 2); return _v / (float)10000; }
+    uint8_t status() const { uint8_t _v; memcpy(&_v, _p + 78, 1); return _v; }
+};
+
+// In-place builder for an outgoing ekf message (writes len bytes)
+struct ekf_builder_t {
+    static const uint8_t id = 30;
+    static const int len = 79;
+    uint8_t *_p;
+    ekf_builder_t(uint8_t *payload): _p(payload) {}
+    void millis(uint32_t _v) { uint32_t _x = _v; memcpy(_p + 0, &_x, 4); }
+    void lat_rad(double _v) { double _x = _v; memcpy(_p + 4, &_x, 8); }
+    void lon_rad(double _v) { double _x = _v; memcpy(_p + 12, &_x, 8); }
+    void altitude_m(float _v) { float _x = _v; memcpy(_p + 20, &_x, 4); }
+    void vn_ms(float _v) { float _x = _v; memcpy(_p + 24, &_x, 4); }
+    void ve_ms(float _v) { float _x = _v; memcpy(_p + 28, &_x, 4); }
+    void vd_ms(float _v) { float _x = _v; memcpy(_p + 32, &_x, 4); }
+    void phi_rad(float _v) { float _x = _v; memcpy(_p + 36, &_x, 4); }
+    void the_rad(float _v) { float _x = _v; memcpy(_p + 40, &_x, 4); }
+    void psi_rad(float _v) { float _x = _v; memcpy(_p + 44, &_x, 4); }
+    void p_bias(float _v) { float _x = _v; memcpy(_p + 48, &_x, 4); }
+    void q_bias(float _v) { float _x = _v; memcpy(_p + 52, &_x, 4); }
+    void r_bias(float _v) { float _x = _v; memcpy(_p + 56, &_x, 4); }
+    void ax_bias(float _v) { float _x = _v; memcpy(_p + 60, &_x, 4); }
+    void ay_bias(float _v) { float _x = _v; memcpy(_p + 64, &_x, 4); }
+    void az_bias(float _v) { float _x = _v; memcpy(_p + 68, &_x, 4); }
+    void max_pos_cov(float _v) { uint16_t _x = uintround(_v * 100); memcpy(_p + 72, &_x, 2); }
+    void max_vel_cov(float _v) { uint16_t _x = uintround(_v * 1000); memcpy(_p + 74, &_x, 2); }
+    void max_att_cov(float _v) { uint16_t _x = uintround(_v * 10000); memcpy(_p + 76, &_x, 2); }
+    void status(uint8_t _v) { uint8_t _x = _v; memcpy(_p + 78, &_x, 1); }
+};
+
+static_assert(sizeof(ekf_t::_compact_t) == 79, "ekf size");
+static_assert(offsetof(ekf_t::_compact_t, millis) == 0, "ekf.millis offset");
+static_assert(offsetof(ekf_t::_compact_t, lat_rad) == 4, "ekf.lat_rad offset");
+static_assert(offsetof(ekf_t::_compact_t, lon_rad) == 12, "ekf.lon_rad offset");
+static_assert(offsetof(ekf_t::_compact_t, altitude_m) == 20, "ekf.altitude_m offset");
+static_assert(offsetof(ekf_t::_compact_t, vn_ms) == 24, "ekf.vn_ms offset");
+static_assert(offsetof(ekf_t::_compact_t, ve_ms) == 28, "ekf.ve_ms offset");
+static_assert(offsetof(ekf_t::_compact_t, vd_ms) == 32, "ekf.vd_ms offset");
+static_assert(offsetof(ekf_t::_compact_t, phi_rad) == 36, "ekf.phi_rad offset");
+static_assert(offsetof(ekf_t::_compact_t, the_rad) == 40, "ekf.the_rad offset");
+static_assert(offsetof(ekf_t::_compact_t, psi_rad) == 44, "ekf.psi_rad offset");
+static_assert(offsetof(ekf_t::_compact_t, p_bias) == 48, "ekf.p_bias offset");
+static_assert(offsetof(ekf_t::_compact_t, q_bias) == 52, "ekf.q_bias offset");
+static_assert(offsetof(ekf_t::_compact_t, r_bias) == 56, "ekf.r_bias offset");
+static_assert(offsetof(ekf_t::_compact_t, ax_bias) == 60, "ekf.ax_bias offset");
+static_assert(offsetof(ekf_t::_compact_t, ay_bias) == 64, "ekf.ay_bias offset");
+static_assert(offsetof(ekf_t::_compact_t, az_bias) == 68, "ekf.az_bias offset");
+static_assert(offsetof(ekf_t::_compact_t, max_pos_cov) == 72, "ekf.max_pos_cov offset");
+static_assert(offsetof(ekf_t::_compact_t, max_vel_cov) == 74, "ekf.max_vel_cov offset");
+static_assert(offsetof(ekf_t::_compact_t, max_att_cov) == 76, "ekf.max_att_cov offset");
+static_assert(offsetof(ekf_t::_compact_t, status) == 78, "ekf.status offset");
+
 } // namespace message
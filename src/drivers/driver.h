@@ -2,13 +2,25 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #include <pyprops.h>
 
+class driver_reader_t;
+
+// one framed input packet (see driver_reader.h)
+struct driver_packet_t {
+    double arrival;             // get_Time() when the packet was received
+    int id;
+    int len;
+    uint8_t payload[256];
+};
+
 class driver_t {
 public:
     driver_t() {}
     virtual ~driver_t() {}
-    
+
     virtual void init( pyPropertyNode *config ) = 0;
     virtual float read() = 0;
     virtual void process() = 0;
@@ -16,5 +28,27 @@ public:
     virtual void close() = 0;
     virtual void command(const char *cmd) = 0;
 
+    // Event loop support (see driver_mgr_t::read()).  get_fd() is
+    // the descriptor that becomes readable when the driver has new
+    // input; read() is then only called when it is (-1 = no fd, read
+    // every frame.)  input_buffered() reports input already pulled
+    // into user space that the fd won't signal again.  A driver that
+    // closes and reopens its fd after init() bumps fd_generation so a
+    // reopen that reuses the same fd number is registered again.
+    virtual int get_fd() { return -1; }
+    virtual bool input_buffered() { return false; }
+    unsigned int fd_generation = 0;
+
+    // Optional threaded input.  A driver that supports it frames the
+    // next packet from its device in read_packet(), which runs on a
+    // separate reader thread: it must not touch the property tree (or
+    // anything else python) and must return within ~100ms when no
+    // data arrives.  read() then drains reader instead of the device.
+    // read_packet() may set pkt->arrival to a more precise receive
+    // time (left at 0 the reader stamps it when the packet is framed.)
+    virtual bool has_packet_reader() { return false; }
+    virtual bool read_packet( driver_packet_t *pkt ) { return false; }
+    driver_reader_t *reader = NULL;
+
     bool verbose = false;
 };
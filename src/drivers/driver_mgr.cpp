@@ -1,6 +1,10 @@
 #include <pybind11/pybind11.h>
 namespace py = pybind11;
 
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
 #include <string>
 #include <sstream>
 using std::string;
@@ -15,8 +19,14 @@ using std::ostringstream;
 #include "drivers/gps_gpsd.h"
 #include "drivers/ublox8.h"
 #include "drivers/ublox9.h"
+#include "util/timing.h"
+#include "driver_reader.h"
 #include "driver_mgr.h"
 
+// a driver with an fd still gets a read() call at least this often
+// (seconds) for housekeeping like reconnects and timeouts
+static const double service_interval = 1.0;
+
 driver_mgr_t::driver_mgr_t() {
     drivers.clear();
 }
@@ -38,51 +48,153 @@ void driver_mgr_t::init() {
         child << "drivers[" << i << "]";
         printf("Initializing device: %s\n", child.str().c_str());
 	pyPropertyNode driver_node = config_node.getChild(child.str().c_str());
+        driver_t *d = NULL;
+        string name;
         if ( driver_node.hasChild("Aura4") ) {
-            pyPropertyNode section_node = driver_node.getChild("Aura4");
-            driver_t *d = new Aura4_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "Aura4";
+            d = new Aura4_t();
         } else if ( driver_node.hasChild("fgfs") ) {
-            pyPropertyNode section_node = driver_node.getChild("fgfs");
-            driver_t *d = new fgfs_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "fgfs";
+            d = new fgfs_t();
         } else if ( driver_node.hasChild("lightware") ) {
-            pyPropertyNode section_node = driver_node.getChild("lightware");
-            driver_t *d = new lightware_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "lightware";
+            d = new lightware_t();
         } else if ( driver_node.hasChild("maestro") ) {
-            pyPropertyNode section_node = driver_node.getChild("maestro");
-            driver_t *d = new maestro_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "maestro";
+            d = new maestro_t();
         } else if ( driver_node.hasChild("ublox8") ) {
-            pyPropertyNode section_node = driver_node.getChild("ublox8");
-            driver_t *d = new ublox8_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "ublox8";
+            d = new ublox8_t();
         } else if ( driver_node.hasChild("gpsd") ) {
-            pyPropertyNode section_node = driver_node.getChild("gpsd");
-            driver_t *d = new gpsd_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "gpsd";
+            d = new gpsd_t();
         } else if ( driver_node.hasChild("ublox9") ) {
-            pyPropertyNode section_node = driver_node.getChild("ublox9");
-            driver_t *d = new ublox9_t();
-            d->init(&section_node);
-            drivers.push_back(d);
+            name = "ublox9";
+            d = new ublox9_t();
+        }
+        if ( d == NULL ) {
+            continue;
         }
+        pyPropertyNode section_node = driver_node.getChild(name.c_str());
+        d->init(&section_node);
+        if ( section_node.getBool("reader_thread") ) {
+            if ( d->has_packet_reader() ) {
+                printf("  starting reader thread\n");
+                d->reader = new driver_reader_t(d);
+                d->reader->start();
+            } else {
+                printf("  no reader thread support for this driver\n");
+            }
+        }
+        drivers.push_back(d);
+    }
+
+    epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+    if ( epoll_fd < 0 ) {
+        perror("epoll_create1()");
+    }
+    fds.assign( drivers.size(), -1 );
+    hangup_fds.assign( drivers.size(), -1 );
+    fd_gens.assign( drivers.size(), 0 );
+    last_service.assign( drivers.size(), 0.0 );
+    for ( unsigned int i = 0; i < drivers.size(); i++ ) {
+        update_fd(i);
     }
 }
 
+// keep the epoll registration in sync with the driver's current fd
+// (drivers may reconnect or start a reader thread after init)
+void driver_mgr_t::update_fd( unsigned int i ) {
+    int fd = drivers[i]->get_fd();
+    bool reopened = drivers[i]->fd_generation != fd_gens[i];
+    fd_gens[i] = drivers[i]->fd_generation;
+    if ( reopened || fd != hangup_fds[i] ) {
+        // a different fd (or the same number reopened) starts clean
+        hangup_fds[i] = -1;
+    }
+    if ( fd == hangup_fds[i] || epoll_fd < 0 ) {
+        // a dead fd would wake us forever, read it every frame instead
+        fd = -1;
+    }
+    if ( fd == fds[i] && !reopened ) {
+        return;
+    }
+    if ( fds[i] >= 0 ) {
+        // closing the old file already dropped it from the set
+        if ( epoll_ctl( epoll_fd, EPOLL_CTL_DEL, fds[i], NULL ) < 0
+             && errno != ENOENT && errno != EBADF ) {
+            perror("epoll_ctl(DEL)");
+        }
+    }
+    fds[i] = -1;
+    if ( fd >= 0 ) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        int result = epoll_ctl( epoll_fd, EPOLL_CTL_ADD, fd, &ev );
+        if ( result < 0 && errno == EEXIST ) {
+            result = epoll_ctl( epoll_fd, EPOLL_CTL_MOD, fd, &ev );
+        }
+        if ( result == 0 ) {
+            fds[i] = fd;
+        } else {
+            perror("epoll_ctl()");
+        }
+    }
+}
+
+void driver_mgr_t::service( unsigned int i ) {
+    drivers[i]->read();
+    last_service[i] = get_Time();
+    update_fd(i);
+}
+
+// read the secondary drivers with pending input, returns true when
+// the master driver's fd is readable
+bool driver_mgr_t::service_events( int timeout_ms ) {
+    const int max_events = 16;
+    struct epoll_event events[max_events];
+    int n = epoll_wait( epoll_fd, events, max_events, timeout_ms );
+    bool master_ready = false;
+    for ( int j = 0; j < n; j++ ) {
+        unsigned int i = events[j].data.u32;
+        if ( events[j].events & (EPOLLERR | EPOLLHUP) ) {
+            hangup_fds[i] = fds[i];
+        }
+        if ( i == 0 ) {
+            master_ready = true;
+            update_fd(i);
+        } else {
+            service(i);
+        }
+    }
+    return master_ready;
+}
+
+// The first driver is the master: its input paces the main loop.
+// Wait for it, reading the other drivers as their input arrives so
+// they never add blocking latency to the frame, then let the master
+// read the frame.  Drivers without an fd are read every frame.
 float driver_mgr_t::read() {
-    float master_dt = 0.0;
-    for ( unsigned int i = 0; i < drivers.size(); i++ ) {
-        float dt = drivers[i]->read();
-        if (i == 0) {
-            master_dt = dt;
+    if ( drivers.size() == 0 ) {
+        return 0.0;
+    }
+    if ( fds[0] >= 0 ) {
+        while ( !drivers[0]->input_buffered() && !service_events( 100 ) ) {
+            // keep waiting
+        }
+    }
+    float master_dt = drivers[0]->read();
+    update_fd(0);
+
+    // pick up anything that arrived meanwhile
+    if ( epoll_fd >= 0 ) {
+        service_events( 0 );
+    }
+    double cur_time = get_Time();
+    for ( unsigned int i = 1; i < drivers.size(); i++ ) {
+        if ( fds[i] < 0 || cur_time > last_service[i] + service_interval ) {
+            service(i);
         }
     }
     return master_dt;
@@ -102,8 +214,17 @@ void driver_mgr_t::write() {
 
 void driver_mgr_t::close() {
     for ( unsigned int i = 0; i < drivers.size(); i++ ) {
+        // stop reading before the device goes away
+        if ( drivers[i]->reader != NULL ) {
+            delete drivers[i]->reader;
+            drivers[i]->reader = NULL;
+        }
         drivers[i]->close();
     }
+    if ( epoll_fd >= 0 ) {
+        ::close( epoll_fd );
+        epoll_fd = -1;
+    }
 }
 
 void driver_mgr_t::send_commands() {
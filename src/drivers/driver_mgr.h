@@ -24,4 +24,14 @@ public:
 private:
     pyPropertyNode sensors_node;
     vector<driver_t *> drivers;
+
+    // one epoll set for every driver's input fd
+    int epoll_fd = -1;
+    vector<int> fds;            // fd registered per driver (-1 = none)
+    vector<int> hangup_fds;     // fd that reported an error/hangup
+    vector<unsigned int> fd_gens; // driver fd_generation when registered
+    vector<double> last_service; // last read() per driver
+    void update_fd( unsigned int i );
+    void service( unsigned int i );
+    bool service_events( int timeout_ms );
 };
@@ -0,0 +1,51 @@
+// driver_reader.cpp - per-driver input thread
+
+#include <unistd.h>             // usleep()
+
+#include "util/timing.h"
+
+#include "driver_reader.h"
+
+void driver_reader_t::start() {
+    if ( running ) {
+        return;
+    }
+    // stamp from the same clock the main thread uses (the first call
+    // latches the clock origin, so make sure that happens here)
+    get_Time();
+    running = true;
+    thread = std::thread( &driver_reader_t::run, this );
+}
+
+void driver_reader_t::stop() {
+    running = false;
+    if ( thread.joinable() ) {
+        thread.join();
+    }
+}
+
+void driver_reader_t::run() {
+    driver_packet_t pkt;
+    while ( running ) {
+        pkt.arrival = 0.0;
+        if ( driver->read_packet( &pkt ) ) {
+            if ( pkt.arrival == 0.0 ) {
+                pkt.arrival = get_Time();
+            }
+            if ( !queue.push( pkt ) ) {
+                overruns++;
+            }
+        }
+    }
+}
+
+bool driver_reader_t::wait( driver_packet_t *pkt, double timeout ) {
+    double start_time = get_Time();
+    while ( !queue.pop( pkt ) ) {
+        if ( get_Time() > start_time + timeout ) {
+            return false;
+        }
+        usleep( 200 );
+    }
+    return true;
+}
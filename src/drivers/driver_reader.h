@@ -0,0 +1,48 @@
+// driver_reader.h - per-driver input thread
+//
+// The main loop can stall for a while (python garbage collection,
+// logging, a slow task) and a device that keeps streaming meanwhile
+// overruns the kernel uart/socket buffer.  A reader keeps one
+// thread blocked on the device: it calls the driver's read_packet(),
+// stamps each framed packet with its arrival time and pushes it into
+// a lock free queue that the driver's read() drains on the main
+// thread (where all parsing and property tree access still happens.)
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "util/spsc_queue.h"
+
+#include "driver.h"
+
+class driver_reader_t {
+
+public:
+
+    driver_reader_t( driver_t *d ): driver(d) {}
+    ~driver_reader_t() { stop(); }
+
+    void start();
+    void stop();
+
+    // main thread side: next packet, false if none is queued
+    bool pop( driver_packet_t *pkt ) { return queue.pop( pkt ); }
+    // main thread side: wait up to timeout seconds for a packet
+    bool wait( driver_packet_t *pkt, double timeout );
+    // packets queued and not yet popped
+    unsigned int pending() { return queue.size(); }
+    // packets dropped because the queue was full
+    uint32_t get_overruns() { return overruns.load(); }
+
+private:
+
+    driver_t *driver;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint32_t> overruns{0};
+    spsc_queue_t<driver_packet_t, 256> queue;
+
+    void run();
+};
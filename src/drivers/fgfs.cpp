@@ -5,13 +5,18 @@
 
 #include <pyprops.h>
 
+#include <poll.h>		// poll()
 #include <stdlib.h>		// drand48()
+#include <string.h>		// memcpy()
 #include <sys/ioctl.h>
+#include <sys/socket.h>		// MSG_DONTWAIT, recvmsg()
+#include <sys/uio.h>		// struct iovec
 
 #include <iostream>
 using std::cout;
 using std::endl;
 
+#include "drivers/driver_reader.h"
 #include "filters/nav_common/coremag.h"
 #include "filters/nav_common/nav_functions.h"
 #include "util/props_helper.h"
@@ -33,6 +38,54 @@ static void my_swap( uint8_t *buf, int index, int count )
     }
 }
 
+// Kernel receive timestamps (non lock-step mode): with SO_TIMESTAMPNS
+// each datagram carries the CLOCK_REALTIME time the kernel queued it,
+// converted here to the get_Time() base by its age.  A packet that
+// waited in the socket buffer (busy main loop, drained backlog) keeps
+// the time it actually arrived.
+static void enable_rx_stamps( netSocket &sock ) {
+    int on = 1;
+    if ( setsockopt( sock.getHandle(), SOL_SOCKET, SO_TIMESTAMPNS,
+                     &on, sizeof(on) ) < 0 ) {
+        perror("setsockopt(SO_TIMESTAMPNS)");
+    }
+}
+
+// recv() that also returns the packet's receive time (get_Time()
+// base, or now if the kernel didn't stamp it)
+static int recv_stamped( netSocket &sock, void *buffer, int size, int flags,
+                         double *stamp ) {
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = size;
+    char control[CMSG_SPACE(sizeof(struct timespec))];
+    struct msghdr msg;
+    memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    int len = recvmsg( sock.getHandle(), &msg, flags );
+    double now = get_Time();
+    *stamp = now;
+    if ( len < 0 ) {
+        return len;
+    }
+    for ( struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c != NULL;
+          c = CMSG_NXTHDR(&msg, c) ) {
+        if ( c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS ) {
+            struct timespec ts;
+            memcpy( &ts, CMSG_DATA(c), sizeof(ts) );
+            double age = get_RealTime() - (ts.tv_sec + 1.0e-9 * ts.tv_nsec);
+            // ignore the stamp across a wall clock step
+            if ( age >= 0.0 && age < 1.0 ) {
+                *stamp = now - age;
+            }
+        }
+    }
+    return len;
+}
+
 void fgfs_t::info( const char *format, ... ) {
     if ( verbose ) {
         printf("fgfs: ");
@@ -111,6 +164,9 @@ void fgfs_t::init_gps( pyPropertyNode *config ) {
 
     // don't block waiting for input
     sock_gps.setBlocking( false );
+    if ( !lockstep ) {
+        enable_rx_stamps( sock_gps );
+    }
 }
 
 void fgfs_t::init_imu( pyPropertyNode *config ) {
@@ -138,6 +194,9 @@ void fgfs_t::init_imu( pyPropertyNode *config ) {
     // don't block waiting for input
     sock_imu.setBlocking( false );
 #endif
+    if ( !lockstep ) {
+        enable_rx_stamps( sock_imu );
+    }
 }
 
 void fgfs_t::init( pyPropertyNode *config ) {
@@ -149,6 +208,9 @@ void fgfs_t::init( pyPropertyNode *config ) {
     route_node = pyGetNode("/task/route", true);    
     targets_node = pyGetNode("/autopilot/targets", true);
     
+    if ( config->hasChild("lockstep") ) {
+        lockstep = config->getBool("lockstep");
+    }
     if ( config->hasChild("actuators") ) {
         pyPropertyNode act_config = config->getChild("actuators");
         init_act(&act_config);
@@ -173,173 +235,206 @@ void fgfs_t::init( pyPropertyNode *config ) {
 }
 
 bool fgfs_t::update_gps() {
-    const int fgfs_gps_size = 40;
     uint8_t packet_buf[fgfs_gps_size];
 
     bool fresh_data = false;
+    double stamp;
 
-    int result;
-    while ( (result = sock_gps.recv(packet_buf, fgfs_gps_size, 0))
-	    == fgfs_gps_size )
-    {
-	fresh_data = true;
-
-	if ( ulIsLittleEndian ) {
-	    my_swap( packet_buf, 0, 8 );
-	    my_swap( packet_buf, 8, 8 );
-	    my_swap( packet_buf, 16, 8 );
-	    my_swap( packet_buf, 24, 4 );
-	    my_swap( packet_buf, 28, 4 );
-	    my_swap( packet_buf, 32, 4 );
-	    my_swap( packet_buf, 36, 4 );
-	}
-
-	uint8_t *buf = packet_buf;
-	double time = *(double *)buf; buf += 8;
-	double lat = *(double *)buf; buf += 8;
-	double lon = *(double *)buf; buf += 8;
-	float alt = *(float *)buf; buf += 4;
-	float vn = *(float *)buf; buf += 4;
-	float ve = *(float *)buf; buf += 4;
-	float vd = *(float *)buf; buf += 4;
-
-        if ( false ) {
-            // add some random white noise
-            double vel_noise = 0.1;
-            double vel_offset = vel_noise * 0.5;
-            vn += drand48()*vel_noise - vel_offset;
-            ve += drand48()*vel_noise - vel_offset;
-            vd += drand48()*vel_noise - vel_offset;
-        }
-        
-        // compute ideal magnetic vector in ned frame
-        long int jd = now_to_julian_days();
-        double field[6];
-        calc_magvar( lat*D2R, lon*D2R, alt / 1000.0, jd, field );
-        mag_ned(0) = field[3];
-        mag_ned(1) = field[4];
-        mag_ned(2) = field[5];
-        mag_ned.normalize();
-        // cout << "mag vector (ned): " << mag_ned(0) << " " << mag_ned(1) << " " << mag_ned(2) << endl;
-        
-	gps_node.setDouble( "timestamp", get_Time() );
-	gps_node.setDouble( "latitude_deg", lat );
-	gps_node.setDouble( "longitude_deg", lon );
-	gps_node.setDouble( "altitude_m", alt );
-	gps_node.setDouble( "vn_ms", vn );
-	gps_node.setDouble( "ve_ms", ve );
-	gps_node.setDouble( "vd_ms", vd );
-	gps_node.setLong( "satellites", 8 ); // fake a solid number
-	gps_node.setDouble( "unix_time_sec", time );
-	gps_node.setLong( "status", 2 ); // valid fix
+    while ( recv_stamped(sock_gps, packet_buf, fgfs_gps_size, 0, &stamp)
+            == fgfs_gps_size ) {
+        fresh_data = true;
+        parse_gps( packet_buf, stamp );
     }
 
     return fresh_data;
 }
 
+void fgfs_t::parse_gps( uint8_t *packet_buf, double stamp ) {
+    if ( ulIsLittleEndian ) {
+        my_swap( packet_buf, 0, 8 );
+        my_swap( packet_buf, 8, 8 );
+        my_swap( packet_buf, 16, 8 );
+        my_swap( packet_buf, 24, 4 );
+        my_swap( packet_buf, 28, 4 );
+        my_swap( packet_buf, 32, 4 );
+        my_swap( packet_buf, 36, 4 );
+    }
+
+    uint8_t *buf = packet_buf;
+    double time = *(double *)buf; buf += 8;
+    double lat = *(double *)buf; buf += 8;
+    double lon = *(double *)buf; buf += 8;
+    float alt = *(float *)buf; buf += 4;
+    float vn = *(float *)buf; buf += 4;
+    float ve = *(float *)buf; buf += 4;
+    float vd = *(float *)buf; buf += 4;
+
+    if ( false ) {
+        // add some random white noise
+        double vel_noise = 0.1;
+        double vel_offset = vel_noise * 0.5;
+        vn += drand48()*vel_noise - vel_offset;
+        ve += drand48()*vel_noise - vel_offset;
+        vd += drand48()*vel_noise - vel_offset;
+    }
+    
+    // compute ideal magnetic vector in ned frame
+    long int jd = now_to_julian_days();
+    double field[6];
+    calc_magvar( lat*D2R, lon*D2R, alt / 1000.0, jd, field );
+    mag_ned(0) = field[3];
+    mag_ned(1) = field[4];
+    mag_ned(2) = field[5];
+    mag_ned.normalize();
+    // cout << "mag vector (ned): " << mag_ned(0) << " " << mag_ned(1) << " " << mag_ned(2) << endl;
+    
+    gps_node.setDouble( "timestamp", stamp );
+    gps_node.setDouble( "latitude_deg", lat );
+    gps_node.setDouble( "longitude_deg", lon );
+    gps_node.setDouble( "altitude_m", alt );
+    gps_node.setDouble( "vn_ms", vn );
+    gps_node.setDouble( "ve_ms", ve );
+    gps_node.setDouble( "vd_ms", vd );
+    gps_node.setLong( "satellites", 8 ); // fake a solid number
+    gps_node.setDouble( "unix_time_sec", time );
+    gps_node.setLong( "status", 2 ); // valid fix
+}
+
 bool fgfs_t::update_imu() {
-    const int fgfs_imu_size = 52;
     uint8_t packet_buf[fgfs_imu_size];
 
-    bool fresh_data = false;
+    double stamp;
 
-    int result;
-    if ( (result = sock_imu.recv(packet_buf, fgfs_imu_size, 0))
-	    == fgfs_imu_size )
-    {
-	fresh_data = true;
-
-	if ( ulIsLittleEndian ) {
-	    my_swap( packet_buf, 0, 8 );
-	    my_swap( packet_buf, 8, 4 );
-	    my_swap( packet_buf, 12, 4 );
-	    my_swap( packet_buf, 16, 4 );
-	    my_swap( packet_buf, 20, 4 );
-	    my_swap( packet_buf, 24, 4 );
-	    my_swap( packet_buf, 28, 4 );
-	    my_swap( packet_buf, 32, 4 );
-	    my_swap( packet_buf, 36, 4 );
-	    my_swap( packet_buf, 40, 4 );
-	    my_swap( packet_buf, 44, 4 );
-	    my_swap( packet_buf, 48, 4 );
-	}
-
-	uint8_t *buf = packet_buf;
-	/*double time = *(double *)buf;*/ buf += 8;
-	float p = *(float *)buf; buf += 4;
-	float q = *(float *)buf; buf += 4;
-	float r = *(float *)buf; buf += 4;
-	float ax = *(float *)buf; buf += 4;
-	float ay = *(float *)buf; buf += 4;
-	float az = *(float *)buf; buf += 4;
-	float airspeed = *(float *)buf; buf += 4;
-	float pressure = *(float *)buf; buf += 4;
-	float roll_truth = *(float *)buf; buf += 4;
-	float pitch_truth = *(float *)buf; buf += 4;
-	float yaw_truth = *(float *)buf; buf += 4;
-
-        // simulate an off kilter imu mounting
-        Vector3f gv = Vector3f(p, q, r);
-        Vector3f av = Vector3f(ax, ay, az);
-        float a_deg = imu_node.getDouble("bank_bias_deg");
-        float a_rad = a_deg * D2R;
-        float sina = sin(a_rad);
-        float cosa = cos(a_rad);
-        Matrix3f R;
-        R << 1.0,   0.0,  0.0,
-             0.0, cosa,  sina,
-             0.0, -sina, cosa;
-        Vector3f ngv = R * gv;
-        Vector3f nav = R * av;
-        //cout << av << endl << nav << endl << endl;
-
-        // generate fake magnetometer readings
-        q_N2B = eul2quat(roll_truth * D2R, pitch_truth * D2R, yaw_truth * D2R);
-        // rotate ideal mag vector into body frame (then normalized)
-        Vector3f mag_body = q_N2B.inverse() * mag_ned;
-        mag_body.normalize();
-        // cout << "mag vector (body): " << mag_body(0) << " " << mag_body(1) << " " << mag_body(2) << endl;
-
-	double cur_time = get_Time();
-	imu_node.setDouble( "timestamp", cur_time );
-	imu_node.setDouble( "p_rad_sec", ngv(0) );
-	imu_node.setDouble( "q_rad_sec", ngv(1) );
-	imu_node.setDouble( "r_rad_sec", ngv(2) );
-	imu_node.setDouble( "ax_mps_sec", nav(0) );
-	imu_node.setDouble( "ay_mps_sec", nav(1) );
-	imu_node.setDouble( "az_mps_sec", nav(2) );
-	imu_node.setDouble( "ax_nocal", nav(0) );
-	imu_node.setDouble( "ay_nocal", nav(1) );
-	imu_node.setDouble( "az_nocal", nav(2) );
-	imu_node.setDouble( "hx", mag_body(0) );
-	imu_node.setDouble( "hy", mag_body(1) );
-	imu_node.setDouble( "hz", mag_body(2) );
-	imu_node.setDouble( "hx_nocal", mag_body(0) );
-	imu_node.setDouble( "hy_nocal", mag_body(1) );
-	imu_node.setDouble( "hz_nocal", mag_body(2) );
-	imu_node.setDouble( "roll_truth", roll_truth );
-	imu_node.setDouble( "pitch_truth", pitch_truth );
-	imu_node.setDouble( "yaw_truth", yaw_truth );
-
-        airdata_node.setDouble( "timestamp", cur_time );
-        airdata_node.setDouble( "airspeed_kt", airspeed );
-        const double inhg2mbar = 33.8638866667;
-        airdata_node.setDouble( "pressure_mbar", pressure * inhg2mbar );
-
-        // fake volt/amp values here for no better place to do it
-        static double last_time = cur_time;
-        static double mah = 0.0;
-        double thr = act_node.getDouble("throttle");
-        power_node.setDouble("main_vcc", 16.0 - thr);
-        power_node.setDouble("cell_vcc", (16.0 - thr) / battery_cells);
-        power_node.setDouble("main_amps", thr * 12.0);
-        double dt = cur_time - last_time;
-        mah += thr*75.0 * (1000.0/3600.0) * dt;
-        last_time = cur_time;
-        power_node.setDouble( "total_mah", mah );
+    if ( recv_stamped(sock_imu, packet_buf, fgfs_imu_size, 0, &stamp)
+         == fgfs_imu_size ) {
+        parse_imu( packet_buf, stamp );
+        return true;
     }
 
-    return fresh_data;
+    return false;
+}
+
+void fgfs_t::parse_imu( uint8_t *packet_buf, double stamp ) {
+    if ( ulIsLittleEndian ) {
+        my_swap( packet_buf, 0, 8 );
+        my_swap( packet_buf, 8, 4 );
+        my_swap( packet_buf, 12, 4 );
+        my_swap( packet_buf, 16, 4 );
+        my_swap( packet_buf, 20, 4 );
+        my_swap( packet_buf, 24, 4 );
+        my_swap( packet_buf, 28, 4 );
+        my_swap( packet_buf, 32, 4 );
+        my_swap( packet_buf, 36, 4 );
+        my_swap( packet_buf, 40, 4 );
+        my_swap( packet_buf, 44, 4 );
+        my_swap( packet_buf, 48, 4 );
+    }
+
+    uint8_t *buf = packet_buf;
+    /*double time = *(double *)buf;*/ buf += 8;
+    float p = *(float *)buf; buf += 4;
+    float q = *(float *)buf; buf += 4;
+    float r = *(float *)buf; buf += 4;
+    float ax = *(float *)buf; buf += 4;
+    float ay = *(float *)buf; buf += 4;
+    float az = *(float *)buf; buf += 4;
+    float airspeed = *(float *)buf; buf += 4;
+    float pressure = *(float *)buf; buf += 4;
+    float roll_truth = *(float *)buf; buf += 4;
+    float pitch_truth = *(float *)buf; buf += 4;
+    float yaw_truth = *(float *)buf; buf += 4;
+
+    // simulate an off kilter imu mounting
+    Vector3f gv = Vector3f(p, q, r);
+    Vector3f av = Vector3f(ax, ay, az);
+    float a_deg = imu_node.getDouble("bank_bias_deg");
+    float a_rad = a_deg * D2R;
+    float sina = sin(a_rad);
+    float cosa = cos(a_rad);
+    Matrix3f R;
+    R << 1.0,   0.0,  0.0,
+         0.0, cosa,  sina,
+         0.0, -sina, cosa;
+    Vector3f ngv = R * gv;
+    Vector3f nav = R * av;
+    //cout << av << endl << nav << endl << endl;
+
+    // generate fake magnetometer readings
+    q_N2B = eul2quat(roll_truth * D2R, pitch_truth * D2R, yaw_truth * D2R);
+    // rotate ideal mag vector into body frame (then normalized)
+    Vector3f mag_body = q_N2B.inverse() * mag_ned;
+    mag_body.normalize();
+    // cout << "mag vector (body): " << mag_body(0) << " " << mag_body(1) << " " << mag_body(2) << endl;
+
+    double cur_time = stamp;
+    imu_node.setDouble( "timestamp", cur_time );
+    imu_node.setDouble( "p_rad_sec", ngv(0) );
+    imu_node.setDouble( "q_rad_sec", ngv(1) );
+    imu_node.setDouble( "r_rad_sec", ngv(2) );
+    imu_node.setDouble( "ax_mps_sec", nav(0) );
+    imu_node.setDouble( "ay_mps_sec", nav(1) );
+    imu_node.setDouble( "az_mps_sec", nav(2) );
+    imu_node.setDouble( "ax_nocal", nav(0) );
+    imu_node.setDouble( "ay_nocal", nav(1) );
+    imu_node.setDouble( "az_nocal", nav(2) );
+    imu_node.setDouble( "hx", mag_body(0) );
+    imu_node.setDouble( "hy", mag_body(1) );
+    imu_node.setDouble( "hz", mag_body(2) );
+    imu_node.setDouble( "hx_nocal", mag_body(0) );
+    imu_node.setDouble( "hy_nocal", mag_body(1) );
+    imu_node.setDouble( "hz_nocal", mag_body(2) );
+    imu_node.setDouble( "roll_truth", roll_truth );
+    imu_node.setDouble( "pitch_truth", pitch_truth );
+    imu_node.setDouble( "yaw_truth", yaw_truth );
+
+    airdata_node.setDouble( "timestamp", cur_time );
+    airdata_node.setDouble( "airspeed_kt", airspeed );
+    const double inhg2mbar = 33.8638866667;
+    airdata_node.setDouble( "pressure_mbar", pressure * inhg2mbar );
+
+    // fake volt/amp values here for no better place to do it
+    static double last_time = cur_time;
+    static double mah = 0.0;
+    double thr = act_node.getDouble("throttle");
+    power_node.setDouble("main_vcc", 16.0 - thr);
+    power_node.setDouble("cell_vcc", (16.0 - thr) / battery_cells);
+    power_node.setDouble("main_amps", thr * 12.0);
+    double dt = cur_time - last_time;
+    mah += thr*75.0 * (1000.0/3600.0) * dt;
+    last_time = cur_time;
+    power_node.setDouble( "total_mah", mah );
+}
+
+// Reader thread side: the next gps or imu packet, whichever socket
+// has one first.
+bool fgfs_t::read_packet( driver_packet_t *pkt ) {
+    struct pollfd fds[2];
+    fds[0].fd = sock_gps.getHandle();
+    fds[1].fd = sock_imu.getHandle();
+    fds[0].events = fds[1].events = POLLIN;
+    fds[0].revents = fds[1].revents = 0;
+    if ( poll( fds, 2, 100 ) <= 0 ) {
+        return false;
+    }
+    // gps first so a fix is applied ahead of the imu packet that
+    // arrived with it
+    if ( fds[0].revents & POLLIN ) {
+        if ( recv_stamped( sock_gps, pkt->payload, fgfs_gps_size,
+                           MSG_DONTWAIT, &pkt->arrival ) == fgfs_gps_size ) {
+            pkt->id = gps_packet_id;
+            pkt->len = fgfs_gps_size;
+            return true;
+        }
+    }
+    if ( fds[1].revents & POLLIN ) {
+        if ( recv_stamped( sock_imu, pkt->payload, fgfs_imu_size,
+                           MSG_DONTWAIT, &pkt->arrival ) == fgfs_imu_size ) {
+            pkt->id = imu_packet_id;
+            pkt->len = fgfs_imu_size;
+            return true;
+        }
+    }
+    return false;
 }
 
 // Read fgfs packets using IMU packet as the main timing reference.
@@ -351,7 +446,28 @@ float fgfs_t::read() {
     // buffer is empty.  The IMU packet (combined with being caught up
     // reading the buffer is our signal to run an interation of the
     // main loop.
+    if ( lockstep ) {
+        return read_lockstep();
+    }
     double last_time = imu_node.getDouble( "timestamp" );
+    if ( reader ) {
+        // same, but from the reader thread's queue
+        driver_packet_t pkt;
+        while ( true ) {
+            if ( !reader->wait( &pkt, 0.1 ) ) {
+                continue;
+            }
+            if ( pkt.id == gps_packet_id ) {
+                parse_gps( pkt.payload, pkt.arrival );
+            } else if ( pkt.id == imu_packet_id ) {
+                parse_imu( pkt.payload, pkt.arrival );
+                if ( !reader->pending() ) {
+                    break;
+                }
+            }
+        }
+        return imu_node.getDouble( "timestamp" ) - last_time;
+    }
     int bytes_available = 0;
     update_gps();
     while ( true ) {
@@ -368,6 +484,58 @@ float fgfs_t::read() {
     return cur_time - last_time;
 }
 
+// Lock-step read: block until the next sim frame arrives and step on
+// exactly that frame.  The frame time is the sim time at the front of
+// the imu packet, not the local clock, so dt is the sim step no matter
+// how fast the sim runs.
+float fgfs_t::read_lockstep() {
+    double last_time = imu_node.getDouble( "timestamp" );
+    uint8_t packet_buf[fgfs_imu_lockstep_size];
+    while ( true ) {
+        struct pollfd pfd;
+        pfd.fd = sock_imu.getHandle();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if ( poll( &pfd, 1, 1000 ) <= 0 ) {
+            info("waiting for sim frame %u", lockstep_frame + 1);
+            continue;
+        }
+        if ( sock_imu.recv( packet_buf, fgfs_imu_lockstep_size, MSG_DONTWAIT )
+             != fgfs_imu_lockstep_size ) {
+            continue;
+        }
+        uint8_t *f = packet_buf + fgfs_imu_size;
+        uint32_t frame = ((uint32_t)f[0] << 24) | (f[1] << 16) | (f[2] << 8) | f[3];
+        if ( lockstep_started && frame == lockstep_frame ) {
+            // the sim resent the frame we just stepped (our reply was
+            // lost or late): answer again without stepping
+            send_act();
+            continue;
+        }
+        lockstep_started = true;
+        lockstep_frame = frame;
+        break;
+    }
+
+    uint8_t time_buf[8];
+    memcpy( time_buf, packet_buf, 8 );
+    if ( ulIsLittleEndian ) {
+        my_swap( time_buf, 0, 8 );
+    }
+    double sim_time;
+    memcpy( &sim_time, time_buf, 8 );
+
+    // the sim sends this frame's gps packet (if any) ahead of the imu
+    // packet
+    uint8_t gps_buf[fgfs_gps_size];
+    while ( sock_gps.recv( gps_buf, fgfs_gps_size, MSG_DONTWAIT ) == fgfs_gps_size ) {
+        parse_gps( gps_buf, sim_time );
+    }
+    parse_imu( packet_buf, sim_time );
+
+    return sim_time - last_time;
+}
+
 void fgfs_t::write() {
     const double F2M = 0.3048;
     const double M2F = 1 / F2M;
@@ -376,8 +544,7 @@ void fgfs_t::write() {
     // are sending data back to FG in this module so it makes some
     // sense to include autopilot targets.)
 
-    const int fgfs_act_size = 76;
-    uint8_t packet_buf[fgfs_act_size];
+    uint8_t *packet_buf = act_packet;
     uint8_t *buf = packet_buf;
 
     double time = act_node.getDouble("timestamp");
@@ -466,8 +633,25 @@ void fgfs_t::write() {
 	my_swap( packet_buf, 72, 4 );
     }
 
-    int result = sock_act.send( packet_buf, fgfs_act_size, 0 );
-    if ( result != fgfs_act_size ) {
+    act_packet_len = fgfs_act_size;
+    if ( lockstep ) {
+        // tag the reply with the frame it answers
+        buf[0] = lockstep_frame >> 24;
+        buf[1] = lockstep_frame >> 16;
+        buf[2] = lockstep_frame >> 8;
+        buf[3] = lockstep_frame;
+        act_packet_len = fgfs_act_lockstep_size;
+    }
+
+    send_act();
+}
+
+void fgfs_t::send_act() {
+    if ( act_packet_len == 0 ) {
+        return;
+    }
+    int result = sock_act.send( act_packet, act_packet_len, 0 );
+    if ( result != act_packet_len ) {
 	info("unable to write full actuator packet.");
     }
 }
@@ -24,7 +24,10 @@ public:
     void write();
     void close();
     void command( const char *cmd ) {}
-    
+    bool has_packet_reader() { return !lockstep; }
+    bool read_packet( driver_packet_t *pkt );
+    int get_fd() { return reader ? -1 : sock_imu.getHandle(); }
+
 private:
     pyPropertyNode act_node;
     pyPropertyNode airdata_node;
@@ -45,6 +48,24 @@ private:
     Matrix3f C_N2B;
     
     int battery_cells = 4;
+
+    static const int fgfs_gps_size = 40;
+    static const int fgfs_imu_size = 52;
+    static const int fgfs_act_size = 76;
+    enum { gps_packet_id = 0, imu_packet_id = 1 };
+
+    // Lock-step mode: the sim sends one frame (gps then imu packet,
+    // the imu packet with a frame number appended) and waits for the
+    // actuator reply tagged with the same frame number before
+    // stepping again.  Sensors are stamped with sim time so the whole
+    // stack runs as fast as the sim can step.
+    static const int fgfs_imu_lockstep_size = fgfs_imu_size + 4;
+    static const int fgfs_act_lockstep_size = fgfs_act_size + 4;
+    bool lockstep = false;
+    uint32_t lockstep_frame = 0;
+    bool lockstep_started = false;
+    uint8_t act_packet[fgfs_act_lockstep_size];
+    int act_packet_len = 0;
     
     void info( const char* format, ... );
     void hard_error( const char*format, ... );
@@ -55,4 +76,8 @@ private:
     void init_imu( pyPropertyNode *config );
     bool update_gps();
     bool update_imu();
+    float read_lockstep();
+    void send_act();
+    void parse_gps( uint8_t *packet_buf, double stamp );
+    void parse_imu( uint8_t *packet_buf, double stamp );
 };
@@ -29,6 +29,7 @@ using std::string;
 void gps_helper_t::init() {
     pyPropsInit();
     gps_node = pyGetNode("/sensors/gps", true);
+    imu_node = pyGetNode("/sensors/imu", true);
     // init master gps timestamp to one year ago
     gps_node.setDouble("timestamp", -31557600.0);
 }
@@ -57,8 +58,11 @@ void gps_helper_t::compute_magvar() {
     gps_node.setDouble( "magvar_deg", magvar_rad * SG_RADIANS_TO_DEGREES );
 }
 
+// age relative to the current frame (imu) time, the same clock the
+// sensor timestamps come from, so this also holds when a lock-step
+// sim is driving the frame clock faster than real time
 double gps_helper_t::gps_age() {
-    return get_Time() - gps_node.getDouble("timestamp");
+    return imu_node.getDouble("timestamp") - gps_node.getDouble("timestamp");
 }
 
 void gps_helper_t::update(bool verbose) {
@@ -17,6 +17,7 @@ public:
     
 private:
     pyPropertyNode gps_node;
+    pyPropertyNode imu_node;
     int gps_state = 0;
     double gps_acq_time = 0.0;
     double last_time = 0.0;
@@ -1,5 +1,5 @@
 #include "math.h"
-#include "rapidjson/document.h"
+#include "string.h"
 #include "time.h"
 #include "util/sg_path.h"
 
@@ -37,6 +37,7 @@ void gpsd_t::connect() {
     gpsd_sock.setBlocking( false );
 
     socket_connected = true;
+    fd_generation++;
 
     send_init();
 
@@ -84,84 +85,139 @@ void gpsd_t::init( pyPropertyNode *config ) {
     ephem_node = raw_node.getChild("ephemeris", true);
 }
 
-bool gpsd_t::parse_message(const string message) {
-    //printf("parse: %s\n", message.c_str());
-    rapidjson::Document d;
-    d.Parse(message.c_str());
-    if ( !d.HasMember("class") ) {
-        return false;
+// gpsd writes compact json with "class" as the first member, so the
+// class can be picked out of the raw text without a full parse.
+// Returns the class name length (0 if not found) and sets *name.
+static int json_class( const char *msg, const char **name ) {
+    const char *p = strstr( msg, "\"class\":\"" );
+    if ( p == NULL ) {
+        return 0;
     }
-    string msg_class = d["class"].GetString();
-    if ( msg_class == "VERSION" ) {
-        printf("gpsd: %s\n", message.c_str());
-    } else if ( msg_class == "TPV" ) {
-        // time, pos, vel
-        if ( d.HasMember("time") ) {
-            string time_str = d["time"].GetString();
-            struct tm t;
-            char* ptr = strptime(time_str.c_str(), "%Y-%m-%dT%H:%M:%S", &t);
-            // printf("hour: %d min: %d sec: %d\n", t.tm_hour, t.tm_min, t.tm_sec);
-            if ( ptr == nullptr ) {
-                printf("gpsd: unable to parse time string = %s\n",
-                       time_str.c_str());
-            } else {
-                double t2 = timegm(&t); // UTC
-                if ( *ptr ) {
-                    double fraction = atof(ptr);
-                    // printf("fraction: %f\n", fraction);
-                    t2 += fraction;
-                }
-                gps_node.setDouble( "unix_time_sec", t2 );
-                gps_node.setDouble( "timestamp", get_Time() );
-                // printf("%s %f\n", time_str.c_str(), t2);
-            }
-        }
-        if ( d.HasMember("leapseconds") ) {
-            leapseconds = d["leapseconds"].GetDouble();
-            gps_node.setDouble( "leapseconds", leapseconds );
-        }
-        if ( d.HasMember("lat") ) {
-            gps_node.setDouble( "latitude_deg", d["lat"].GetDouble() );
-        }
-        if ( d.HasMember("lon") ) {
-            gps_node.setDouble( "longitude_deg", d["lon"].GetDouble() );
-        }
-        if ( d.HasMember("alt") ) {
-            gps_node.setDouble( "altitude_m", d["alt"].GetFloat() );
-        }
-        float course_deg = 0.0;
-        if ( d.HasMember("track") ) {
-            course_deg = d["track"].GetFloat();
-        }
-        float speed_mps = 0.0;
-        if ( d.HasMember("speed") ) {
-            speed_mps = d["speed"].GetFloat();
+    p += 9;
+    const char *end = strchr( p, '"' );
+    if ( end == NULL ) {
+        return 0;
+    }
+    *name = p;
+    return end - p;
+}
+
+// Find the value of "key" in a flat (TPV style) json object without
+// building a document.  Returns a pointer to the first character of
+// the value or NULL if the key isn't present.
+static const char *json_field( const char *msg, const char *key ) {
+    size_t n = strlen( key );
+    for ( const char *p = strstr( msg, key ); p != NULL; p = strstr( p + 1, key ) ) {
+        if ( p > msg && p[-1] == '"' && p[n] == '"' && p[n+1] == ':' ) {
+            return p + n + 2;
         }
-        float angle_rad = (90.0 - course_deg) * M_PI/180.0;
-        gps_node.setDouble( "vn_ms", sin(angle_rad) * speed_mps );
-        gps_node.setDouble( "ve_ms", cos(angle_rad) * speed_mps );
-        if ( d.HasMember("climb") ) {
-            gps_node.setDouble( "vd_ms", -d["climb"].GetFloat() );
+    }
+    return NULL;
+}
+
+// fast path: time, pos, vel
+bool gpsd_t::parse_tpv( const char *message ) {
+    const char *val;
+    if ( (val = json_field(message, "time")) != NULL && *val == '"' ) {
+        struct tm t;
+        const char *ptr = strptime(val + 1, "%Y-%m-%dT%H:%M:%S", &t);
+        // printf("hour: %d min: %d sec: %d\n", t.tm_hour, t.tm_min, t.tm_sec);
+        if ( ptr == nullptr ) {
+            printf("gpsd: unable to parse time string = %.32s\n", val + 1);
+        } else {
+            double t2 = timegm(&t); // UTC
+            if ( *ptr == '.' ) {
+                double fraction = atof(ptr);
+                // printf("fraction: %f\n", fraction);
+                t2 += fraction;
+            }
+            gps_node.setDouble( "unix_time_sec", t2 );
+            gps_node.setDouble( "timestamp", get_Time() );
         }
-        if ( d.HasMember("mode") ) {
-            gps_node.setLong( "fixType", d["mode"].GetInt() );
+    }
+    if ( (val = json_field(message, "leapseconds")) != NULL ) {
+        leapseconds = atof(val);
+        gps_node.setDouble( "leapseconds", leapseconds );
+    }
+    if ( (val = json_field(message, "lat")) != NULL ) {
+        gps_node.setDouble( "latitude_deg", atof(val) );
+    }
+    if ( (val = json_field(message, "lon")) != NULL ) {
+        gps_node.setDouble( "longitude_deg", atof(val) );
+    }
+    if ( (val = json_field(message, "alt")) != NULL ) {
+        gps_node.setDouble( "altitude_m", atof(val) );
+    }
+    float course_deg = 0.0;
+    if ( (val = json_field(message, "track")) != NULL ) {
+        course_deg = atof(val);
+    }
+    float speed_mps = 0.0;
+    if ( (val = json_field(message, "speed")) != NULL ) {
+        speed_mps = atof(val);
+    }
+    float angle_rad = (90.0 - course_deg) * M_PI/180.0;
+    gps_node.setDouble( "vn_ms", sin(angle_rad) * speed_mps );
+    gps_node.setDouble( "ve_ms", cos(angle_rad) * speed_mps );
+    if ( (val = json_field(message, "climb")) != NULL ) {
+        gps_node.setDouble( "vd_ms", -atof(val) );
+    }
+    if ( (val = json_field(message, "mode")) != NULL ) {
+        gps_node.setLong( "fixType", atoi(val) );
+    }
+    return true;
+}
+
+// fast path: only the count of satellites used in the solution is
+// needed, so count the "used":true flags in the satellites array
+bool gpsd_t::parse_sky( const char *message ) {
+    const char *sats = json_field(message, "satellites");
+    if ( sats != NULL ) {
+        int num_sats = 0;
+        for ( const char *p = strstr(sats, "\"used\":true"); p != NULL;
+              p = strstr(p + 11, "\"used\":true") ) {
+            num_sats++;
         }
+        gps_node.setLong( "satellites", num_sats );
+    }
+    return true;
+}
+
+// message is a single nul terminated json object inside the receive
+// buffer.  It is parsed in place (the text is modified) so it must
+// not be used again afterwards.
+bool gpsd_t::parse_message( char *message ) {
+    //printf("parse: %s\n", message);
+    const char *name;
+    int len = json_class( message, &name );
+    if ( len == 0 ) {
+        return false;
+    }
+    string msg_class(name, len);
+    if ( msg_class == "TPV" ) {
+        return parse_tpv( message );
     } else if ( msg_class == "SKY" ) {
-        if ( d.HasMember("satellites") ) {
-            int num_sats = 0;
-            const rapidjson::Value& sats = d["satellites"];
-            if ( sats.IsArray() ) {
-                for (rapidjson::SizeType i = 0; i < sats.Size(); i++) {
-                    if ( sats[i].HasMember("used") ) {
-                        if ( sats[i]["used"].GetBool() ) {
-                            num_sats++;
-                        }
-                    }
-                }
-            }
-            gps_node.setLong( "satellites", num_sats );
-        }
-    } else if ( msg_class == "RAW" ) {
+        return parse_sky( message );
+    } else if ( msg_class == "VERSION" ) {
+        printf("gpsd: %s\n", message);
+        return true;
+    } else if ( msg_class != "RAW" && msg_class != "SUBFRAME" ) {
+        // skip classes we don't use before paying for a full parse
+        printf("gpsd: unhandled class = %s\n", msg_class.c_str());
+        printf("parse: %s\n", message);
+        return false;
+    }
+
+    // full (in-situ) parse with the reused allocators: the document
+    // values and parse stack live in preallocated pools that are
+    // recycled for each message.
+    json_pool.Clear();
+    json_stack.Clear();
+    json_doc_t d( &json_pool, sizeof(json_stack_buf), &json_stack );
+    if ( d.ParseInsitu( message ).HasParseError() || !d.IsObject() ) {
+        return false;
+    }
+    if ( msg_class == "RAW" ) {
         double receiver_timestamp = 0.0;
         if ( d.HasMember("time") ) {
             // FIXME: these values need to be kept separate because a double
@@ -181,10 +237,15 @@ bool gpsd_t::parse_message(const string message) {
                 // /* FIXME: */ double gps_seconds = receiver_timestamp - (315964800.0 + leapseconds);
                 // /* FIXME */ double gps_seconds = receiver_timestamp - 315964800.0;
                 double tow = fmod(gps_seconds, 604800);
-                printf("receiver timestamp: %.3f tow: %.3f\n", receiver_timestamp, tow);
+                if ( verbose ) {
+                    printf("receiver timestamp: %.3f tow: %.3f\n", receiver_timestamp, tow);
+                }
                 raw_node.setDouble("receiver_tow", tow);
-                MatrixXd gnss(12,8);
-                gnss.setZero();
+                // gather the usable measurements first, then compute
+                // all the satellite positions/clocks as one batch
+                GNSS_raw_measurement meas[GNSS_MAX_SATS] = {};
+                GNSSWeightVector cn0(GNSS_MAX_SATS);
+                int meas_svid[GNSS_MAX_SATS];
                 int mcount = 0;
                 for (rapidjson::SizeType i = 0; i < raw.Size(); i++) {
                     int gnssid = -1;
@@ -192,6 +253,7 @@ bool gpsd_t::parse_message(const string message) {
                     bool l1c = false;
                     double pr = 0.0;
                     double doppler = 0.0;
+                    double snr = 0.0;
                     string id_str = "";
                     if ( raw[i].HasMember("gnssid") ) {
                         gnssid = raw[i]["gnssid"].GetInt();
@@ -221,6 +283,9 @@ bool gpsd_t::parse_message(const string message) {
                     if ( raw[i].HasMember("doppler") ) {
                         doppler = raw[i]["doppler"].GetDouble();
                     }
+                    if ( raw[i].HasMember("snr") ) {
+                        snr = raw[i]["snr"].GetDouble();
+                    }
                     if ( gnssid == 0 ) {
                         pyPropertyNode ephem = ephem_node.getChild(id_str.c_str(), true);
                         if ( ! ephem.hasChild("frame1") ) {
@@ -232,7 +297,7 @@ bool gpsd_t::parse_message(const string message) {
                         if ( ! ephem.hasChild("frame3") ) {
                             ephem.setBool("frame3", false);
                         }
-                        if ( l1c ) {
+                        if ( l1c && mcount < GNSS_MAX_SATS ) {
                             if (clockBiasEst_m != clockBiasEst_m) {
                                 // catch nans
                                 clockBiasEst_m = 0.0;
@@ -243,15 +308,14 @@ bool gpsd_t::parse_message(const string message) {
                             pr -= clockBiasEst_m;
                             double sat_trans_tow = tow + clockBiasEst_m/c - pr/c;
                             // /*combine terms*/ double sat_trans_tow = tow - (2*clockBiasEst_m - pr)/c;
-                            
-                            VectorXd posvel = dump_sat_pos(svid, sat_trans_tow, pr, doppler, ephem);
-                            if ( posvel.size() == 8 ) {
-                                // cout << "gnss:" << gnss << endl;
-                                Vector3d me(-248211.09, -4500083.91, 4498382.30);
-                                Vector3d diff = me - posvel.segment<3>(2);
-                                double dist = sqrt(diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2]);
-                                printf("svid: %d pr %.2f geo %.2f diff: %.0f cbe: %.0f\n", svid, pr, dist, pr-dist, clockBiasEst_m);
-                                gnss.row(mcount) = posvel;
+
+                            GNSS_raw_measurement &m = meas[mcount];
+                            if ( load_ephem(ephem, m) ) {
+                                m.timestamp = sat_trans_tow;
+                                m.pseudorange = pr;
+                                m.doppler = doppler;
+                                cn0(mcount) = snr;
+                                meas_svid[mcount] = svid;
                                 mcount++;
                             }
                         }
@@ -278,25 +342,38 @@ bool gpsd_t::parse_message(const string message) {
                     node.setDouble("pseudorange", pr);
                     node.setDouble("doppler", doppler);
                 }
+                GNSSMeasMatrix gnss;
+                EphemerisData2PosVelClock(meas, mcount, gnss);
+                cn0.conservativeResize(mcount);
+                if ( verbose ) {
+                    for ( int j = 0; j < mcount; j++ ) {
+                        Vector3d ecef = gnss.block<1, 3>(j, 2).transpose();
+                        Vector3d lla = E2D(ecef);
+                        printf("sat %d lla: %.8f %.8f %.1f\n", meas_svid[j], lla[0]*180.0/M_PI, lla[1]*180.0/M_PI, lla[2]);
+                        Vector3d me(-248211.09, -4500083.91, 4498382.30);
+                        double dist = (me - ecef).norm();
+                        printf("svid: %d pr %.2f geo %.2f diff: %.0f cbe: %.0f\n", meas_svid[j], gnss(j, 0), dist, gnss(j, 0)-dist, clockBiasEst_m);
+                    }
+                }
                 if ( mcount >= 4 ) {
-                    MatrixXd final_gnss(mcount,8);
-                    final_gnss = gnss.block(0,0,mcount,8);
-                    cout << "final gnss:" << final_gnss << endl;
                     pEst_E_m = Vector3d(0, 0, 0);
                     vEst_E_mps = Vector3d(0, 0, 0);
                     double clockBias_m = 0;
                     double clockRateBias_mps = 0;
-                    GNSS_LS_pos_vel(final_gnss, pEst_E_m, vEst_E_mps, clockBias_m, clockRateBias_mps);
-                    clockBiasEst_m += clockBias_m;
-                    //clockBiasEst_m = clockBias_m;
-                    printf("pos ecef: %.2f %.2f %.2f  cb: %.1f cbe: %.0f\n",
-                           pEst_E_m[0], pEst_E_m[1], pEst_E_m[2], clockBias_m,
-                           clockBiasEst_m);
-                    Vector3d lla = E2D(pEst_E_m);
-                    printf("receiver pos lla: %.8f %.8f %.1f\n", lla[0]*180.0/M_PI, lla[1]*180.0/M_PI, lla[2]);
+                    if ( GNSS_LS_pos_vel(gnss, &cn0, pEst_E_m, vEst_E_mps, clockBias_m, clockRateBias_mps) ) {
+                        clockBiasEst_m += clockBias_m;
+                        //clockBiasEst_m = clockBias_m;
+                        if ( verbose ) {
+                            printf("pos ecef: %.2f %.2f %.2f  cb: %.1f cbe: %.0f\n",
+                                   pEst_E_m[0], pEst_E_m[1], pEst_E_m[2], clockBias_m,
+                                   clockBiasEst_m);
+                            Vector3d lla = E2D(pEst_E_m);
+                            printf("receiver pos lla: %.8f %.8f %.1f\n", lla[0]*180.0/M_PI, lla[1]*180.0/M_PI, lla[2]);
+                        }
+                    }
                     // Vector3d me(-248211.09, -4500083.91, 4498382.30);
-                    // GNSS_clock_bias(final_gnss, me);
-                } else {
+                    // GNSS_clock_bias(gnss, me);
+                } else if ( verbose ) {
                     printf("waiting for enough ephemeris and satellite data...\n");
                 }
             }
@@ -430,52 +507,63 @@ bool gpsd_t::parse_message(const string message) {
             writeJSON(jsonfile.str(), &ephem_node);
             ephem_write_time = t;
         }            
-    } else {
-        printf("gpsd: unhandled class = %s\n", msg_class.c_str());
-        printf("parse: %s\n", message.c_str());
     }
     return true;
 }
 
+// Frame complete json objects out of the receive buffer.  The brace
+// scan picks up where the previous call left off (json_scan, with the
+// nesting depth and string state carried over) so each byte is only
+// examined once no matter how the messages are split across recv()
+// calls.  Every complete object is handled, nul terminated in place.
 bool gpsd_t::process_buffer() {
-    if ( json_buffer.length() <= 2 ) {
-        return false;
-    }
-    //printf("buffer len: %lu\n", json_buffer.length());
-    int start = 0;
-    int end = 0;
-    //printf("gpsd buffer: %s\n", json_buffer.c_str());
-    int level = 0;
-    for ( unsigned int i = start; i < json_buffer.length(); i++ ) {
-        if ( json_buffer[i] == '{' ) {
-            //printf("  found '{' @ %d\n", i); 
-            if ( level == 0 ) {
-                start = i;
-            }
-            level++;
-        }
-        if ( json_buffer[i] == '}' ) {
-            //printf("  found '}' @ %d\n", i);
-            level--;
-            if ( level == 0 ) {
-                end = i;
-                parse_message(json_buffer.substr(start, end-start+1));
-                json_buffer.erase(0, end+1);
-                break;
+    bool parsed = false;
+    while ( json_scan < json_tail ) {
+        char c = json_buf[json_scan++];
+        if ( json_depth == 0 ) {
+            // between objects (newlines or junk)
+            if ( c == '{' ) {
+                json_head = json_scan - 1;
+                json_depth = 1;
+            } else {
+                json_head = json_scan;
+            }
+        } else if ( json_quote ) {
+            if ( json_escape ) {
+                json_escape = false;
+            } else if ( c == '\\' ) {
+                json_escape = true;
+            } else if ( c == '"' ) {
+                json_quote = false;
+            }
+        } else if ( c == '"' ) {
+            json_quote = true;
+        } else if ( c == '{' ) {
+            json_depth++;
+        } else if ( c == '}' ) {
+            json_depth--;
+            if ( json_depth == 0 ) {
+                char save = json_buf[json_scan];
+                json_buf[json_scan] = 0;
+                if ( parse_message( json_buf + json_head ) ) {
+                    parsed = true;
+                }
+                json_buf[json_scan] = save;
+                json_head = json_scan;
             }
         }
     }
-    // if ( level > 0 ) {
-    //     printf("gpsd: incomplete json: %s\n", json_buffer.c_str());
-    // }
-    
-    // try to ensure some sort of sanity so the buffer can't
-    // completely run away if something bad is happening.
-    if ( json_buffer.length() > 16384 ) {
-        json_buffer = "";
-        return true;
+    if ( json_depth == 0 ) {
+        // everything consumed, restart at the front of the buffer
+        json_head = json_tail = json_scan = 0;
     }
-    return false;
+    return parsed;
+}
+
+void gpsd_t::reset_buffer() {
+    json_head = json_tail = json_scan = 0;
+    json_depth = 0;
+    json_quote = json_escape = false;
 }
 
 float gpsd_t::read() {
@@ -485,21 +573,35 @@ float gpsd_t::read() {
 	connect();
     }
 
-    const int buf_size = 256;
-    char buf[buf_size];
     int result;
-    while ( (result = gpsd_sock.recv( buf, buf_size-1 )) > 0 ) {
-	buf[result] = 0;
-        json_buffer += buf;
+    while ( true ) {
+        // keep the partial object (if any) at the front of the buffer
+        if ( json_head > 0 ) {
+            memmove( json_buf, json_buf + json_head, json_tail - json_head );
+            json_tail -= json_head;
+            json_scan -= json_head;
+            json_head = 0;
+        }
+        // try to ensure some sort of sanity so the buffer can't
+        // completely run away if something bad is happening.
+        if ( json_tail >= JSON_BUF_SIZE ) {
+            reset_buffer();
+        }
+        result = gpsd_sock.recv( json_buf + json_tail, JSON_BUF_SIZE - json_tail );
+        if ( result <= 0 ) {
+            break;
+        }
+        json_tail += result;
+        process_buffer();
     }
     if ( errno != EAGAIN ) {
 	if ( verbose ) {
 	    perror("gpsd_sock.recv()");
 	}
 	socket_connected = false;
+        reset_buffer();
     }
 
-    process_buffer();
     
     // If more than 5 seconds has elapsed without seeing new data and
     // our last init attempt was more than 5 seconds ago, try
@@ -517,46 +619,28 @@ void gpsd_t::close() {
     socket_connected = false;
 }
 
-VectorXd gpsd_t::dump_sat_pos(int svid, double tow, double pr, double doppler,
-                              pyPropertyNode ephem) {
-    VectorXd posvel;
-    // if ( ephem.getBool("frame1") and ephem.getBool("frame2")
-    //      and ephem.getBool("frame3") ) {
-    //     posvel = EphemerisData2Satecef( tow, 0 /*TOW*/, 0 /*L2*/, 0 /*week no*/, 0 /*l2_flag*/, 0 /*sv_acc*/, 0 /*sv_health*/,
-    //                                     0 /*t_gd*/, 0 /*iodc*/, 0 /*t_oc*/, 0 /*a_f2*/, 0 /*a_f1*/, 0 /*a_f0*/,
-    //                                     0 /*iode*/, ephem.getDouble("Crs"), ephem.getDouble("deltan")*M_PI, ephem.getDouble("M0")*M_PI, ephem.getDouble("Cuc"), ephem.getDouble("e"), ephem.getDouble("Cus"),
-    //                                     ephem.getDouble("sqrtA"), ephem.getDouble("toe"), ephem.getDouble("Cic"), ephem.getDouble("Omega0")*M_PI, ephem.getDouble("Cis"), ephem.getDouble("i0")*M_PI, ephem.getDouble("Crc"),
-    //                                     ephem.getDouble("omega")*M_PI, ephem.getDouble("Omegad")*M_PI, ephem.getDouble("IDOT")*M_PI );
-    //     cout << "sat: " << svid << " pos/vel: " << posvel << endl;
-    // }
-    
-    if ( ephem.getBool("frame1") and ephem.getBool("frame2")
-         and ephem.getBool("frame3") ) {
-        GNSS_raw_measurement gnss;
-        gnss.timestamp = tow;
-        gnss.pseudorange = pr;
-        gnss.doppler = doppler;
-        gnss.Crs = ephem.getDouble("Crs");
-        gnss.deltan = ephem.getDouble("deltan")*M_PI;
-        gnss.M0 = ephem.getDouble("M0")*M_PI;
-        gnss.Cuc = ephem.getDouble("Cuc");
-        gnss.e = ephem.getDouble("e");
-        gnss.Cus = ephem.getDouble("Cus");
-        gnss.sqrtA = ephem.getDouble("sqrtA");
-        gnss.toe = ephem.getDouble("toe");
-        gnss.Cic = ephem.getDouble("Cic");
-        gnss.Omega0 = ephem.getDouble("Omega0")*M_PI;
-        gnss.Cis = ephem.getDouble("Cis");
-        gnss.i0 = ephem.getDouble("i0")*M_PI;
-        gnss.Crc = ephem.getDouble("Crc");
-        gnss.omega = ephem.getDouble("omega")*M_PI;
-        gnss.Omegad = ephem.getDouble("Omegad")*M_PI;
-        gnss.IDOT = ephem.getDouble("IDOT")*M_PI;
-        posvel = EphemerisData2PosVelClock(gnss);
-        // cout << "sat: " << svid << " pos/vel: " << posvel << endl;
-        Vector3d ecef = posvel.segment<3>(2);
-        Vector3d lla = E2D(ecef);
-        printf("sat %d lla: %.8f %.8f %.1f\n", svid, lla[0]*180.0/M_PI, lla[1]*180.0/M_PI, lla[2]);
-    }
-    return posvel;
+// fill in the orbit parameters from the stored ephemeris, returns
+// false until all three subframes have been received
+bool gpsd_t::load_ephem(pyPropertyNode ephem, GNSS_raw_measurement &gnss) {
+    if ( !(ephem.getBool("frame1") and ephem.getBool("frame2")
+           and ephem.getBool("frame3")) ) {
+        return false;
+    }
+    gnss.Crs = ephem.getDouble("Crs");
+    gnss.deltan = ephem.getDouble("deltan")*M_PI;
+    gnss.M0 = ephem.getDouble("M0")*M_PI;
+    gnss.Cuc = ephem.getDouble("Cuc");
+    gnss.e = ephem.getDouble("e");
+    gnss.Cus = ephem.getDouble("Cus");
+    gnss.sqrtA = ephem.getDouble("sqrtA");
+    gnss.toe = ephem.getDouble("toe");
+    gnss.Cic = ephem.getDouble("Cic");
+    gnss.Omega0 = ephem.getDouble("Omega0")*M_PI;
+    gnss.Cis = ephem.getDouble("Cis");
+    gnss.i0 = ephem.getDouble("i0")*M_PI;
+    gnss.Crc = ephem.getDouble("Crc");
+    gnss.omega = ephem.getDouble("omega")*M_PI;
+    gnss.Omegad = ephem.getDouble("Omegad")*M_PI;
+    gnss.IDOT = ephem.getDouble("IDOT")*M_PI;
+    return true;
 }
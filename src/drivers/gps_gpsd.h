@@ -12,16 +12,22 @@ using namespace Eigen;
 
 #include <pyprops.h>
 
+#include "rapidjson/document.h"
+
 #include "util/netSocket.h"
 #include "util/props_helper.h"
 #include "util/timing.h"
 
 #include "drivers/driver.h"
+#include "drivers/raw_sat.h"
 
 class gpsd_t: public driver_t {
     
 public:
-    gpsd_t() {
+    gpsd_t():
+        json_pool(json_pool_buf, sizeof(json_pool_buf)),
+        json_stack(json_stack_buf, sizeof(json_stack_buf))
+    {
         pEst_E_m = Vector3d(0, 0, 0);
         vEst_E_mps = Vector3d(0, 0, 0);
     }
@@ -32,6 +38,7 @@ public:
     void write() {}
     void close();
     void command( const char *cmd ) {}
+    int get_fd() { return socket_connected ? gpsd_sock.getHandle() : -1; }
 
 private:
     pyPropertyNode gps_node;
@@ -46,13 +53,36 @@ private:
     netSocket gpsd_sock;
     bool socket_connected = false;
     double last_init_time = 0.0;
-    string json_buffer = "";
+
+    // receive buffer, complete objects are framed and parsed in place
+    static const int JSON_BUF_SIZE = 16384;
+    char json_buf[JSON_BUF_SIZE + 1];
+    int json_head = 0;          // start of the current (partial) object
+    int json_scan = 0;          // next byte for the brace scan
+    int json_tail = 0;          // end of received bytes
+    int json_depth = 0;
+    bool json_quote = false;
+    bool json_escape = false;
+
+    // reused document storage for the messages that need a full parse
+    typedef rapidjson::GenericDocument<rapidjson::UTF8<>,
+                                       rapidjson::MemoryPoolAllocator<>,
+                                       rapidjson::MemoryPoolAllocator<> > json_doc_t;
+    // the allocators place their chunk header and the values (doubles,
+    // pointers) on 8 byte boundaries from the start of these buffers
+    alignas(8) char json_pool_buf[32768];
+    alignas(8) char json_stack_buf[4096];
+    rapidjson::MemoryPoolAllocator<> json_pool;
+    rapidjson::MemoryPoolAllocator<> json_stack;
+
     double ephem_write_time = 0;
     double leapseconds = 0;
     void connect();
     void send_init();
+    void reset_buffer();
     bool process_buffer();
-    bool parse_message(const string message);
-    VectorXd dump_sat_pos(int svid, double tow, double pr, double doppler,
-                          pyPropertyNode ephem);
+    bool parse_message( char *message );
+    bool parse_tpv( const char *message );
+    bool parse_sky( const char *message );
+    bool load_ephem(pyPropertyNode ephem, GNSS_raw_measurement &gnss);
 };
@@ -22,6 +22,7 @@ public:
     void write() {}
     void close();
     void command( const char *cmd ) {}
+    int get_fd() { return fd; }
 
 private:
     pyPropertyNode pos_node;
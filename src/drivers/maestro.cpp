@@ -1,6 +1,8 @@
 #include <fcntl.h>		// open()
 #include <termios.h>		// tcgetattr() et. al.
 
+#include <algorithm>
+
 #include "util/strutils.h"
 #include "maestro.h"
 
@@ -16,10 +18,63 @@ bool maestro_t::open( const char *device_name ) {
     return true;
 }
 
+void maestro_t::add_output( int ch, const string &source, bool symmetrical,
+                            float gain, int gain_input ) {
+    if ( ch < 0 || ch >= maestro_channels ) {
+        printf("maestro: channel %d out of range, ignored\n", ch);
+        return;
+    }
+    for ( unsigned int i = 0; i < outputs.size(); i++ ) {
+        if ( outputs[i].channel == ch ) {
+            printf("maestro: channel %d mapped twice, ignored\n", ch);
+            return;
+        }
+    }
+    output_t out;
+    out.channel = ch;
+    out.symmetrical = symmetrical;
+    out.gain = gain;
+    out.gain_input = gain_input;
+    if ( gain_input >= 0 ) {
+        out.gain_channels.bind( pilot_node, "channel" );
+    }
+    if ( source == "throttle" ) {
+        out.throttle = true;
+    } else if ( !out.source.bind( source ) ) {
+        printf("maestro: channel %d has no valid source: %s\n", ch,
+               source.c_str());
+        return;
+    }
+    outputs.push_back( out );
+    printf("maestro: ch[%d] = %s gain = %.2f%s\n", ch, source.c_str(), gain,
+           symmetrical ? "" : " (one sided)");
+}
+
+// the original fixed mapping (with the optional 6 element "gains"
+// array) when the config has no "channels" section
+void maestro_t::init_default_outputs( pyPropertyNode *config ) {
+    float gains[3] = {1.0, 1.0, 1.0};
+    if ( config->hasChild("gains") and config->getLen("gains") == 6 ) {
+        for ( int i = 0; i < 3; i++ ) {
+            gains[i] = config->getDouble("gains", i);
+        }
+    }
+    // hardcoded hack: throttle gain is the channel[4] switch position
+    // (replaces gains[0])
+    add_output( 0, "throttle", true, 1.0, 4 );
+    add_output( 1, "/actuators/aileron", true, gains[1], -1 );
+    add_output( 2, "/sensors/pilot_input/rudder", true, gains[2], -1 );
+}
+
 void maestro_t::init( pyPropertyNode *config ) {
     act_node = pyGetNode("/actuators", true);
     ap_node = pyGetNode("/autopilot", true);
     pilot_node = pyGetNode("/sensors/pilot_input", true);
+    act_throttle.bind( act_node, "throttle" );
+    pilot_throttle.bind( pilot_node, "throttle" );
+    pilot_throttle_safety.bind( pilot_node, "throttle_safety" );
+    pilot_fail_safe.bind( pilot_node, "fail_safe" );
+    ap_master_switch.bind( ap_node, "master_switch" );
     if ( config->hasChild("device") ) {
         string device = config->getString("device");
         if ( open(device.c_str()) ) {
@@ -30,60 +85,111 @@ void maestro_t::init( pyPropertyNode *config ) {
     } else {
         printf("no maestro device specified\n");
     }
-    if ( config->hasChild("gains") and config->getLen("gains") == 6 ) {
-        for ( int i = 0; i < maestro_channels; i++ ) {
-            gains[i] = config->getDouble("gains", i);
-            printf("maestro: ch[%d] gain = %.2f\n", i, gains[i]);
-        }
+    // the "set multiple targets" command is only understood by the
+    // Mini Maestro 12/18/24, the 6 channel Micro Maestro needs one
+    // "set target" command per channel
+    if ( config->hasChild("set_multiple_targets") ) {
+        set_multiple = config->getBool("set_multiple_targets");
     }
-}
 
-void maestro_t::write_channel(int ch, float norm, bool symmetrical) {
-    // honor gain (i.e. for servo reversing)
-    norm *= gains[ch];
-    
-    // target value is 1/4 us, so center (1500) would have a value of
-    // 6000 for a symmetrical channel
-    int target = 1500.0 * 4;
-    if ( symmetrical ) {
-        // rudder, etc.
-        target = (1500 + 500 * norm) * 4;
+    // channel map: "channels": [ { "channel": 0, "source":
+    // "/actuators/aileron", "symmetrical": true, "gain": 1.0,
+    // "gain_input": 4 }, ... ], source may also be "throttle"
+    int len = config->getLen("channels");
+    if ( len > 0 ) {
+        for ( int i = 0; i < len; i++ ) {
+            pyPropertyNode ch_node = config->getChild("channels", i);
+            float gain = 1.0;
+            if ( ch_node.hasChild("gain") ) {
+                gain = ch_node.getDouble("gain");
+            }
+            bool symmetrical = true;
+            if ( ch_node.hasChild("symmetrical") ) {
+                symmetrical = ch_node.getBool("symmetrical");
+            }
+            int gain_input = -1;
+            if ( ch_node.hasChild("gain_input") ) {
+                gain_input = ch_node.getLong("gain_input");
+            }
+            add_output( ch_node.getLong("channel"),
+                        ch_node.getString("source"), symmetrical, gain,
+                        gain_input );
+        }
     } else {
-        // throttle
-        target = (1000 + 1000 * norm) * 4;
+        init_default_outputs( config );
     }
-    uint8_t command[] = {0x84, ch, target & 0x7F, target >> 7 & 0x7F};
-    if ( ::write(fd, command, sizeof(command)) == -1) {
-        perror("maestro error writing");
+    std::sort( outputs.begin(), outputs.end(),
+               [](const output_t &a, const output_t &b) {
+                   return a.channel < b.channel;
+               } );
+}
+
+float maestro_t::get_throttle() {
+    float throttle = 0.0;
+    if ( pilot_throttle_safety.get() < -0.3 and !pilot_fail_safe.get() ) {
+        if ( ap_master_switch.get() ) {
+	    throttle = act_throttle.get();
+	} else {
+            throttle = pilot_throttle.get();
+	}
     }
+    return throttle;
 }
 
+// All channels go out in one write: a compact "set target" command
+// (0x84, channel, low/high 7 bit target) per channel, or with
+// set_multiple_targets (Mini Maestro only) a "set multiple targets"
+// command (0x9F, count, first channel, then the target pairs) per
+// run of consecutive channels.
 void maestro_t::write() {
+    if ( fd < 0 || outputs.empty() ) {
+        return;
+    }
+    uint8_t *buf = cmd_buf;
+    uint8_t *count = NULL;
+    int next_ch = -1;
+    for ( unsigned int i = 0; i < outputs.size(); i++ ) {
+        output_t &out = outputs[i];
+        float norm = out.throttle ? get_throttle() : out.source.get();
 
-    /*static int skip = 0;
-    if ( skip < 3 ) {
-	skip++;
-	return;
-    } else {
-	skip = 0;
-    }*/
+        // honor gain (i.e. for servo reversing)
+        float gain = out.gain;
+        if ( out.gain_input >= 0 ) {
+            gain *= out.gain_channels.get( out.gain_input );
+        }
+        norm *= gain;
 
-    float throttle = 0.0;
-    if ( pilot_node.getDouble("throttle_safety") < -0.3 and !pilot_node.getBool("fail_safe") ) {
-        if ( ap_node.getBool("master_switch") ) {
-	    throttle = act_node.getDouble("throttle");
-	} else {
-            throttle = pilot_node.getDouble("throttle");
-	}
+        // target value is 1/4 us, so center (1500) would have a
+        // value of 6000 for a symmetrical channel
+        int target;
+        if ( out.symmetrical ) {
+            // rudder, etc.
+            target = (1500 + 500 * norm) * 4;
+        } else {
+            // throttle
+            target = (1000 + 1000 * norm) * 4;
+        }
+
+        if ( !set_multiple ) {
+            *buf++ = 0x84;
+            *buf++ = out.channel;
+        } else if ( out.channel != next_ch ) {
+            // start a new run
+            *buf++ = 0x9F;
+            count = buf++;
+            *count = 0;
+            *buf++ = out.channel;
+        }
+        if ( count != NULL ) {
+            (*count)++;
+        }
+        *buf++ = target & 0x7F;
+        *buf++ = target >> 7 & 0x7F;
+        next_ch = out.channel + 1;
+    }
+    if ( ::write(fd, cmd_buf, buf - cmd_buf) == -1) {
+        perror("maestro error writing");
     }
-    // hardcoded hack: tie throttle gain to channel[4] switch position
-    gains[0] = pilot_node.getDouble("channel", 4);
-    write_channel(0, throttle, true);
-    write_channel(1, act_node.getDouble("aileron"), true);
-    write_channel(2, pilot_node.getDouble("rudder"), true);
-    // write_channel(3, act_node.getDouble("rudder"), true);
-    // write_channel(4, act_node.getDouble("flaps"), true);
-    // write_channel(5, act_node.getDouble("gear"), true);
 }
 
 void maestro_t::close() {
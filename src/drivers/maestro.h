@@ -6,7 +6,13 @@
 
 #include <pyprops.h>
 
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
 #include "drivers/driver.h"
+#include "util/props_handle.h"
 
 class maestro_t: public driver_t {
     
@@ -21,12 +27,35 @@ public:
     void command( const char *cmd ) {}
 
 private:
+    // One output channel, resolved once at init.  source is either a
+    // property path or "throttle" (the safety gated throttle.)
+    struct output_t {
+        int channel;
+        bool symmetrical;
+        float gain;
+        int gain_input = -1;    // pilot input channel that scales gain
+        bool throttle = false;
+        prop_handle_t<double> source;
+        prop_handle_t<double> gain_channels; // pilot_input/channel
+    };
+
     pyPropertyNode act_node;
     pyPropertyNode ap_node;
     pyPropertyNode pilot_node;
-    static const int maestro_channels = 6;
+    prop_handle_t<double> act_throttle;
+    prop_handle_t<double> pilot_throttle;
+    prop_handle_t<double> pilot_throttle_safety;
+    prop_handle_t<bool> pilot_fail_safe;
+    prop_handle_t<bool> ap_master_switch;
+
+    static const int maestro_channels = 24;
     int fd = -1;
-    float gains[maestro_channels] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+    bool set_multiple = false;  // 0x9F command (Mini Maestro 12/18/24)
+    vector<output_t> outputs;   // sorted by channel
+    uint8_t cmd_buf[maestro_channels * 4];
     bool open( const char *device_name );
-    void write_channel(int ch, float norm, bool symmetrical);
+    void add_output( int ch, const string &source, bool symmetrical,
+                     float gain, int gain_input );
+    void init_default_outputs( pyPropertyNode *config );
+    float get_throttle();
 };
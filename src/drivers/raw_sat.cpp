@@ -1,9 +1,5 @@
 #include "raw_sat.h"
 
-#include <iostream>
-using std::cout;
-using std::endl;
-
 // Constants
 const double EarthRadius = 6378137.0;        // earth semi-major axis radius (m)
 const double ECC2 = 0.0066943799901;         // major eccentricity squared
@@ -239,7 +235,7 @@ VectorXd oldEphemerisData2Satecef(float t,
 }
 
 // process raw measurement to give a 8 x 1 matrix (range, range rate, x,y,z,vx,vy,vz)
-VectorXd EphemerisData2PosVelClock(GNSS_raw_measurement gnss_raw_measurement)
+GNSSPosVelClock EphemerisData2PosVelClock(const GNSS_raw_measurement &gnss_raw_measurement)
 {
     // All the equations are based ON: https://www.gps.gov/technical/icwg/IS-GPS-200H.pdf
     // pg. 104-105, Also Grove  p335-338
@@ -393,7 +389,7 @@ VectorXd EphemerisData2PosVelClock(GNSS_raw_measurement gnss_raw_measurement)
            "URE %s Health %s", deltatr, deltatsv, ephm['Tgd'], ura2ure[ephm['ura']],
            health_str[ephm['hlth'] & 0x1f])) */
                       
-    VectorXd pos_vel_ecef_clock(8);
+    GNSSPosVelClock pos_vel_ecef_clock;
     double lambda = (2 * c) / 1575.4282e6;  // L1 according ublox8
     // https://www.u-blox.com/sites/default/files/products/documents/u-blox8-M8_ReceiverDescrPrtSpec_%28UBX-13003221%29.pdf
     double PseudorangeRate = lambda * gnss_raw_measurement.doppler;
@@ -403,13 +399,63 @@ VectorXd EphemerisData2PosVelClock(GNSS_raw_measurement gnss_raw_measurement)
     return pos_vel_ecef_clock;
 }
 
-// compute vehicle's postion, velocity in E frame and clock offset (m) and drift (m/s) 
-void GNSS_LS_pos_vel(MatrixXd &gnss_measurement,
+// evaluate a batch of measurements, one row of gnss_measurement per
+// satellite (at most GNSS_MAX_SATS), returns the number of rows
+int EphemerisData2PosVelClock(const GNSS_raw_measurement *gnss_raw_measurements,
+                              int num_sats, GNSSMeasMatrix &gnss_measurement)
+{
+    if ( num_sats > GNSS_MAX_SATS ) {
+        num_sats = GNSS_MAX_SATS;
+    }
+    gnss_measurement.resize(num_sats, 8); // within the fixed capacity, no allocation
+    for (int j = 0; j < num_sats; j++) {
+        gnss_measurement.row(j) = EphemerisData2PosVelClock(gnss_raw_measurements[j]).transpose();
+    }
+    return num_sats;
+}
+
+// Frame rotation during signal transit time (Grove2nd:8.36), small
+// angle form
+static Matrix3d transit_rotation(double approx_range)
+{
+    Matrix3d T_E2I;
+    T_E2I(0, 0) = 1;
+    T_E2I(0, 1) = OMEGA_DOT_EARTH * approx_range / c;
+    T_E2I(0, 2) = 0;
+    T_E2I(1, 0) = -OMEGA_DOT_EARTH * approx_range / c;
+    T_E2I(1, 1) = 1;
+    T_E2I(1, 2) = 0;
+    T_E2I(2, 0) = 0;
+    T_E2I(2, 1) = 0;
+    T_E2I(2, 2) = 1;
+    return T_E2I;
+}
+
+// Relative measurement weight (inverse variance) from the satellite
+// elevation and carrier to noise density: sigma^2 is modeled as
+// 1/sin^2(el) scaled by 10^(-(CN0 - 45)/10), so low and weak
+// satellites count for less.  sin_el is clamped at 5 degrees, cn0 <= 0
+// means unknown (elevation weighting only.)
+static double gnss_weight(double sin_el, double cn0_dbhz)
+{
+    const double min_sin_el = 0.0871557; // sin(5 deg)
+    if ( sin_el < min_sin_el ) {
+        sin_el = min_sin_el;
+    }
+    double w = sin_el * sin_el;
+    if ( cn0_dbhz > 0.0 ) {
+        w *= pow(10.0, (cn0_dbhz - 45.0) / 10.0);
+    }
+    return w;
+}
+
+// compute vehicle's postion, velocity in E frame and clock offset (m) and drift (m/s)
+bool GNSS_LS_pos_vel(const GNSSMeasMatrix &gnss_measurement, const GNSSWeightVector *cn0_dbhz,
                      Vector3d &pEst_E_m_, Vector3d &vEst_E_mps_, double &clockBias_m_, double &clockRateBias_mps_)
 {
     /*
-   GNSS_LS_position_velocity - Calculates position, velocity, clock offset, 
-   and clock drift using unweighted iterated least squares. Separate
+   GNSS_LS_position_velocity - Calculates position, velocity, clock offset,
+   and clock drift using weighted iterated least squares. Separate
    calculations are implemented for position and clock offset and for
    velocity and clock drift
 
@@ -419,270 +465,196 @@ void GNSS_LS_pos_vel(MatrixXd &gnss_measurement,
     %     Column 1              Pseudo-range rate measurements (m/s)
     %     Columns 2-4           Satellite ECEF position (m)
     %     Columns 5-7           Satellite ECEF velocity (m/s)
-    %   no_GNSS_meas          Number of satellites for which measurements are
-    %                         supplied
+    %   cn0_dbhz              C/N0 per measurement (optional, NULL for
+    %                         elevation weighting only)
     %   pEst_E_m_        prior predicted ECEF user position (m)
     %   vEst_E_mps_      prior predicted ECEF user velocity (m/s)
     %
     % Outputs:
 
-        output is a 8 by 1 matrix containing the following: 
+    %   pEst_E_m_             estimated ECEF user position (m)
+    %   vEst_E_mps_           estimated ECEF user velocity (m/s)
+    %   clockBias_m_, clockRateBias_mps_
+    %                         estimated receiver clock offset (m) and drift (m/s)
 
-    %   est_r_ea_e            estimated ECEF user position (m)
-    %   est_v_ea_e            estimated ECEF user velocity (m/s)
-    %   est_clock             estimated receiver clock offset (m) and drift (m/s)
+        returns false (outputs untouched) if there are too few
+        measurements or the solution doesn't converge.
    */
 
+    // The normal equations (H' W H) dx = H' W r are accumulated one
+    // satellite at a time, so everything here is fixed size.
+    const int max_iterations = 20;
     int no_sat = gnss_measurement.rows();
-    cout << "no_sats: " << no_sat << endl;
-    cout << "pEst_E_m_:" << pEst_E_m_.transpose() << endl;
-    cout << "vEst_E_mps_:" << vEst_E_mps_.transpose() << endl; // questionable vEst, check GNSS_LS_pos_vel calc later 
-    cout << "clockBias_m: " << clockBias_m_ << endl;
-    cout << "clockRateBias_mps " <<  clockRateBias_mps_ << endl;
-  
+    if ( no_sat < 4 ) {
+        return false;
+    }
+
     // Position and Clock OFFSET
-    VectorXd x_pred(4, 1);
-    x_pred.setZero();
-    x_pred.segment(0, 3) = pEst_E_m_;
+    Vector4d x_pred;
+    x_pred.segment<3>(0) = pEst_E_m_;
     x_pred(3) = 0;
 
-    // allocate space for estimation
-    VectorXd delta_r(3, 1);
-    delta_r.setZero();
-    double approx_range = 0;
-    double range = 0;
-    double range_rate = 0;
-    VectorXd pred_meas(no_sat, 1);
-    pred_meas.setZero();
-    MatrixXd H(no_sat, 4);
-    H.setZero();
-    Matrix<double, 3, 3> T_E2I;
-    T_E2I.setIdentity();
-    VectorXd u_as_E(3, 1);
-    u_as_E.setZero();
-
-    // output
-    Matrix<double, 4, 1> x_est_1;
-    x_est_1.setZero();
-    Matrix<double, 4, 1> x_est_2;
-    x_est_2.setZero();
-    VectorXd output(8, 1);
-    output.setZero();
-
-    // set the flag for the while-loop
+    double weight[GNSS_MAX_SATS];
+    Matrix4d N;
+    Vector4d b;
+    Matrix4d N_inv;
+    bool invertible = false;
+
     double test_convergence = 1;
+    int iteration = 0;
     while (test_convergence > 0.0001)
     {
-        cout << "test_convergence: " << test_convergence << endl;
-        
+        if ( ++iteration > max_iterations ) {
+            return false;
+        }
+        // elevation is only meaningful once the estimate is near the
+        // earth's surface (the prior may be the earth center)
+        double p_norm = x_pred.segment<3>(0).norm();
+        Vector3d up = Vector3d::Zero();
+        if ( p_norm > 0.5 * EarthRadius ) {
+            up = x_pred.segment<3>(0) / p_norm;
+        }
+        N.setZero();
+        b.setZero();
         for (int j = 0; j < no_sat; j++)
         {
-            Vector3d x_temp;
-            x_temp(0) = gnss_measurement(j, 2);
-            x_temp(1) = gnss_measurement(j, 3);
-            x_temp(2) = gnss_measurement(j, 4);
-
-            delta_r = x_temp - x_pred.segment(0, 3);
-            approx_range = delta_r.norm();
-
-            // Calculate frame rotation during signal transit time using (Grove2nd:8.36)
-            T_E2I(0, 0) = 1;
-            T_E2I(0, 1) = OMEGA_DOT_EARTH * approx_range / c;
-            T_E2I(0, 2) = 0;
-            T_E2I(1, 0) = -OMEGA_DOT_EARTH * approx_range / c;
-            T_E2I(1, 1) = 1;
-            T_E2I(1, 2) = 0;
-            T_E2I(2, 0) = 0;
-            T_E2I(2, 1) = 0;
-            T_E2I(2, 2) = 1;
-
-            // same thing without the trig approximations
-            // double wEtau = OMEGA_DOT_EARTH * approx_range / c;
-            // T_E2I(0, 0) = cos(wEtau);
-            // T_E2I(0, 1) = sin(wEtau);
-            // T_E2I(0, 2) = 0;
-            // T_E2I(1, 0) = -sin(wEtau);
-            // T_E2I(1, 1) = cos(wEtau);
-            // T_E2I(1, 2) = 0;
-            // T_E2I(2, 0) = 0;
-            // T_E2I(2, 1) = 0;
-            // T_E2I(2, 2) = 1;
-
-            delta_r = T_E2I.cast<double>() * x_temp - x_pred.segment(0, 3);
-            range = delta_r.norm();
-            pred_meas(j, 0) = range + x_pred(3);
-            u_as_E = delta_r / range;
-            H(j, 0) = -u_as_E(0);
-            H(j, 1) = -u_as_E(1);
-            H(j, 2) = -u_as_E(2);
-            H(j, 3) = 1;
+            Vector3d x_temp = gnss_measurement.block<1, 3>(j, 2).transpose();
+            double approx_range = (x_temp - x_pred.segment<3>(0)).norm();
+            Vector3d delta_r = transit_rotation(approx_range) * x_temp - x_pred.segment<3>(0);
+            double range = delta_r.norm();
+            Vector3d u_as_E = delta_r / range;
+
+            double sin_el = up.isZero() ? 1.0 : u_as_E.dot(up);
+            weight[j] = gnss_weight(sin_el, cn0_dbhz ? (*cn0_dbhz)(j) : 0.0);
+
+            Vector4d h;
+            h << -u_as_E, 1;
+            double residual = gnss_measurement(j, 0) - (range + x_pred(3));
+            N += weight[j] * h * h.transpose();
+            b += weight[j] * h * residual;
         }
-        // least sqaure method
-        x_est_1 = x_pred + (H.transpose() * H).inverse() * H.transpose() * (gnss_measurement.col(0) - pred_meas);
-        test_convergence = (x_est_1 - x_pred).norm();
-        x_pred = x_est_1;
-        cout << "x_pred: " << x_pred << endl;
+        N.computeInverseWithCheck(N_inv, invertible);
+        if ( !invertible ) {
+            return false;
+        }
+        Vector4d dx = N_inv * b;
+        test_convergence = dx.norm();
+        x_pred += dx;
     }
-    
+    Vector4d x_est_1 = x_pred;
+
     // Earth rotation vector and matrix
     Vector3d omega_ie; // Earth rate vector
-    Matrix3d Omega_ie; // Earth rate rotation matrix
     omega_ie(0) = 0.0;
     omega_ie(1) = 0.0;
     omega_ie(2) = OMEGA_DOT_EARTH;
-    Omega_ie = Skew(omega_ie);
-
-    // save the estimated postion and clock offset
-    // output(0) = x_est_1(0);
-    // output(1) = x_est_1(1);
-    // output(2) = x_est_1(2);
-    // output(6) = x_est_1(3); // record clock offset
-    pEst_E_m_(0) = x_est_1(0);
-    pEst_E_m_(1) = x_est_1(1);
-    pEst_E_m_(2) = x_est_1(2);
-    clockBias_m_ = (float)x_est_1(3); // record clock offset
-
-    x_pred.setZero();
-    pred_meas.setZero();
-    x_pred.segment(0, 3) = vEst_E_mps_;
+    Matrix3d Omega_ie = Skew(omega_ie); // Earth rate rotation matrix
+
+    // Velocity and clock DRIFT, the per satellite geometry only
+    // depends on the position solution so it is computed once (the
+    // weights are the ones from the final position iteration)
+    Vector3d u_temp[GNSS_MAX_SATS];
+    Vector3d sat_term[GNSS_MAX_SATS];
+    for (int j = 0; j < no_sat; j++)
+    {
+        Vector3d p_temp = gnss_measurement.block<1, 3>(j, 2).transpose();
+        Vector3d v_temp = gnss_measurement.block<1, 3>(j, 5).transpose();
+        double approx_range = (p_temp - x_est_1.segment<3>(0)).norm();
+        Matrix3d T_E2I = transit_rotation(approx_range);
+        Vector3d delta_r = T_E2I * p_temp - x_est_1.segment<3>(0);
+        u_temp[j] = delta_r / delta_r.norm();
+        sat_term[j] = T_E2I * (v_temp + Omega_ie * p_temp);
+    }
+
+    x_pred.segment<3>(0) = vEst_E_mps_;
     x_pred(3) = 0;
+    Vector3d rot_term = Omega_ie * x_est_1.segment<3>(0);
     test_convergence = 1;
-    u_as_E.setZero();
-    
+    iteration = 0;
     while (test_convergence > 0.0001)
     {
+        if ( ++iteration > max_iterations ) {
+            return false;
+        }
+        N.setZero();
+        b.setZero();
         for (int j = 0; j < no_sat; j++)
         {
-            Vector3d p_temp, v_temp;
-            p_temp(0) = gnss_measurement(j, 2);
-            p_temp(1) = gnss_measurement(j, 3);
-            p_temp(2) = gnss_measurement(j, 4);
-            v_temp(0) = gnss_measurement(j, 5);
-            v_temp(1) = gnss_measurement(j, 6);
-            v_temp(2) = gnss_measurement(j, 7);
-
-            delta_r = p_temp - x_est_1.segment(0, 3);
-            approx_range = delta_r.norm();
-
-            // Calculate frame rotation during signal transit time using (Grove2nd:8.36)
-            T_E2I(0, 0) = 1;
-            T_E2I(0, 1) = OMEGA_DOT_EARTH * approx_range / c;
-            T_E2I(0, 2) = 0;
-            T_E2I(1, 0) = -OMEGA_DOT_EARTH * approx_range / c;
-            T_E2I(1, 1) = 1;
-            T_E2I(1, 2) = 0;
-            T_E2I(2, 0) = 0;
-            T_E2I(2, 1) = 0;
-            T_E2I(2, 2) = 1;
-
-            delta_r = T_E2I.cast<double>() * p_temp - x_est_1.segment(0, 3);
-            range = delta_r.norm();
-            u_as_E = delta_r / range;
-     
             // Predict pseudo-range rate using (9.165)
-            range_rate = u_as_E.transpose() * (T_E2I.cast<double>() * (v_temp + Omega_ie.cast<double>() * p_temp) -
-                                               (x_pred.segment(0, 3) + Omega_ie.cast<double>() * x_est_1.segment(0, 3)));
-       
-            pred_meas(j, 0) = range_rate + x_pred(3);  
-    
-            H(j, 0) = -u_as_E(0);
-            H(j, 1) = -u_as_E(1);
-            H(j, 2) = -u_as_E(2);
-            H(j, 3) = 1;
+            double range_rate = u_temp[j].dot(sat_term[j] - (x_pred.segment<3>(0) + rot_term));
+            Vector4d h;
+            h << -u_temp[j], 1;
+            double residual = gnss_measurement(j, 1) - (range_rate + x_pred(3));
+            N += weight[j] * h * h.transpose();
+            b += weight[j] * h * residual;
         }
-
-        x_est_2 = x_pred + (H.transpose() * H).inverse() * H.transpose() * (gnss_measurement.col(1) - pred_meas);
-        test_convergence = (x_est_2 - x_pred).norm();
-        x_pred = x_est_2;
+        N.computeInverseWithCheck(N_inv, invertible);
+        if ( !invertible ) {
+            return false;
+        }
+        Vector4d dx = N_inv * b;
+        test_convergence = dx.norm();
+        x_pred += dx;
     }
-    
-    // save the estimated postion and clock offset
-    // output(3) = x_est_2(0);
-    // output(4) = x_est_2(1);
-    // output(5) = x_est_2(2);
-    // output(7) = x_est_2(3);
-    vEst_E_mps_(0) = x_est_2(0);
-    vEst_E_mps_(1) = x_est_2(1);
-    vEst_E_mps_(2) = x_est_2(2);
-    clockRateBias_mps_ = (float)x_est_2(3);
+
+    // save the estimated postion, velocity, and clock offset/drift
+    pEst_E_m_ = x_est_1.segment<3>(0);
+    clockBias_m_ = x_est_1(3);
+    vEst_E_mps_ = x_pred.segment<3>(0);
+    clockRateBias_mps_ = x_pred(3);
+    return true;
 }
 
 // if we know our position, try to find a clock bias that minimizes the difference between pseudorange and geometric range
-void GNSS_clock_bias(MatrixXd &gnss_measurement, Vector3d &pos_true)
+double GNSS_clock_bias(const GNSSMeasMatrix &gnss_measurement, const Vector3d &pos_true)
 {
     /*
-   GNSS_LS_position_velocity - Calculates position, velocity, clock offset, 
-   and clock drift using unweighted iterated least squares. Separate
-   calculations are implemented for position and clock offset and for
-   velocity and clock drift
-
-    % Inputs:
-    %   GNSS_measurements     GNSS measurement data:
-    %     Column 0              Pseudo-range measurements (m)
-    %     Column 1              Pseudo-range rate measurements (m/s)
-    %     Columns 2-4           Satellite ECEF position (m)
-    %     Columns 5-7           Satellite ECEF velocity (m/s)
-    %   no_GNSS_meas          Number of satellites for which measurements are
-    %                         supplied
-    %   pEst_E_m_        prior predicted ECEF user position (m)
-    %   vEst_E_mps_      prior predicted ECEF user velocity (m/s)
-    %
-    % Outputs:
-
-        output is a 8 by 1 matrix containing the following: 
-
-    %   est_r_ea_e            estimated ECEF user position (m)
-    %   est_v_ea_e            estimated ECEF user velocity (m/s)
-    %   est_clock             estimated receiver clock offset (m) and drift (m/s)
+    Sweeps the signal transit time (cb, seconds) used for the earth
+    rotation correction of the satellite positions and returns the
+    value where the pseudorange minus geometric range differences are
+    most consistent across satellites (smallest spread; the common
+    part is the receiver clock offset.)
    */
 
     int no_sat = gnss_measurement.rows();
-    cout << "no_sats: " << no_sat << endl;
-    cout << "pos_true:" << pos_true.transpose() << endl;
-  
-    // allocate space for estimation
-    Matrix<double, 3, 3> T_E2I;
-    T_E2I.Identity();
-
-    // output
-    Matrix<double, 4, 1> x_est_1;
-    x_est_1.setZero();
-    Matrix<double, 4, 1> x_est_2;
-    x_est_2.setZero();
-    VectorXd output(8, 1);
-    output.setZero();
-
-    // set the flag for the while-loop
+    double best_cb = 0.0;
+    double best_var = -1.0;
+
     double cb = -0.1;
     double cdt = 0.01;
     while (cb <= 0.1) {
-        cout << "clock bias::" << cb << endl;
+        // same thing without the trig approximations
+        double wEtau = OMEGA_DOT_EARTH * cb;
+        Matrix3d T_E2I;
+        T_E2I(0, 0) = cos(wEtau);
+        T_E2I(0, 1) = sin(wEtau);
+        T_E2I(0, 2) = 0;
+        T_E2I(1, 0) = -sin(wEtau);
+        T_E2I(1, 1) = cos(wEtau);
+        T_E2I(1, 2) = 0;
+        T_E2I(2, 0) = 0;
+        T_E2I(2, 1) = 0;
+        T_E2I(2, 2) = 1;
+
+        double sum = 0.0;
+        double sum2 = 0.0;
         for (int j = 0; j < no_sat; j++) {
-            Vector3d x_temp;
-            x_temp(0) = gnss_measurement(j, 2);
-            x_temp(1) = gnss_measurement(j, 3);
-            x_temp(2) = gnss_measurement(j, 4);
-
-            // same thing without the trig approximations
-            double wEtau = OMEGA_DOT_EARTH * cb;
-            T_E2I(0, 0) = cos(wEtau);
-            T_E2I(0, 1) = sin(wEtau);
-            T_E2I(0, 2) = 0;
-            T_E2I(1, 0) = -sin(wEtau);
-            T_E2I(1, 1) = cos(wEtau);
-            T_E2I(1, 2) = 0;
-            T_E2I(2, 0) = 0;
-            T_E2I(2, 1) = 0;
-            T_E2I(2, 2) = 1;
-
-            Vector3d new_sat_pos = T_E2I.cast<double>() * x_temp;
-            // cout << "  " << x_temp.transpose() << endl;
-            Vector3d delta = new_sat_pos - pos_true;
-            double geo_range = delta.norm();
-            printf("  pr: %.1f geo: %.1f diff: %.1f\n", gnss_measurement(j, 0), geo_range,
-                   gnss_measurement(j, 0) - geo_range);
+            Vector3d x_temp = gnss_measurement.block<1, 3>(j, 2).transpose();
+            Vector3d new_sat_pos = T_E2I * x_temp;
+            double geo_range = (new_sat_pos - pos_true).norm();
+            double diff = gnss_measurement(j, 0) - geo_range;
+            sum += diff;
+            sum2 += diff * diff;
+        }
+        if ( no_sat > 0 ) {
+            double mean = sum / no_sat;
+            double var = sum2 / no_sat - mean * mean;
+            if ( best_var < 0.0 || var < best_var ) {
+                best_var = var;
+                best_cb = cb;
+            }
         }
         cb += cdt;
     }
-    cout << endl;    
+    return best_cb;
 }
@@ -4,6 +4,17 @@
 #include <eigen3/Eigen/LU>
 using namespace Eigen;
 
+// Maximum number of satellites in one solution.  The solver works on
+// fixed capacity (stack allocated) matrices sized by this so it can
+// run every epoch without touching the heap.
+const int GNSS_MAX_SATS = 32;
+
+// one row per satellite: pseudorange (m), pseudorange rate (m/s),
+// satellite ECEF position (m), satellite ECEF velocity (m/s)
+typedef Matrix<double, Dynamic, 8, 0, GNSS_MAX_SATS, 8> GNSSMeasMatrix;
+typedef Matrix<double, Dynamic, 1, 0, GNSS_MAX_SATS, 1> GNSSWeightVector;
+typedef Matrix<double, 8, 1> GNSSPosVelClock;
+
 struct GNSS_raw_measurement
 {
     double AODO;          // the age of data offset, in seconds.
@@ -60,11 +71,21 @@ VectorXd EphemerisData2Satecef(float t,
                                double omega, double Omega_dot, double IDOT);
 
 // process raw measurement to give a 8 x 1 matrix (range, range rate, x,y,z,vx,vy,vz)
-VectorXd EphemerisData2PosVelClock(GNSS_raw_measurement gnss_raw_measurement);
+GNSSPosVelClock EphemerisData2PosVelClock(const GNSS_raw_measurement &gnss_raw_measurement);
+
+// evaluate a batch of measurements, one row of gnss_measurement per
+// satellite (at most GNSS_MAX_SATS), returns the number of rows
+int EphemerisData2PosVelClock(const GNSS_raw_measurement *gnss_raw_measurements,
+                              int num_sats, GNSSMeasMatrix &gnss_measurement);
 
-// compute vehicle's postion, velocity in E frame and clock offset (m) and drift (m/s) 
-void GNSS_LS_pos_vel(MatrixXd &gnss_measurement,
+// compute vehicle's postion, velocity in E frame and clock offset (m)
+// and drift (m/s) by weighted (elevation and C/N0, cn0_dbhz may be
+// NULL) iterated least squares.  Returns false if there are fewer than
+// 4 satellites or the solution doesn't converge.
+bool GNSS_LS_pos_vel(const GNSSMeasMatrix &gnss_measurement, const GNSSWeightVector *cn0_dbhz,
                      Vector3d &pEst_E_m_, Vector3d &vEst_E_mps_, double &clockBias_m_, double &clockRateBias_mps_);
 
-// if we know our position, try to find a clock bias that minimizes the difference between pseudorange and geometric range
-void GNSS_clock_bias(MatrixXd &gnss_measurement, Vector3d &pos_true);
+// if we know our position, try to find a clock bias that minimizes
+// the difference between pseudorange and geometric range (returns the
+// best signal transit time in seconds)
+double GNSS_clock_bias(const GNSSMeasMatrix &gnss_measurement, const Vector3d &pos_true);
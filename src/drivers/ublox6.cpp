@@ -151,7 +151,9 @@ static void my_swap( uint8_t *buf, int index, int count ) {
 }
 
 
-bool ublox6_t::parse_msg() {
+bool ublox6_t::parse_msg( uint8_t msg_class, uint8_t msg_id,
+                          uint16_t payload_length, uint8_t *payload )
+{
     bool new_position = false;
     static bool set_system_time = false;
 
@@ -389,132 +391,20 @@ bool ublox6_t::parse_msg() {
 }
 
 bool ublox6_t::read_ublox6() {
-    // static int state = 0;
-    // static int msg_class = 0, msg_id = 0;
-    // static int length_lo = 0, length_hi = 0, payload_length = 0;
-    // static int counter = 0;
-    // static uint8_t cksum_A = 0, cksum_B = 0, cksum_lo = 0, cksum_hi = 0;
-    int len;
-    uint8_t input[500];
-    // static uint8_t payload[500];
-
-    // printf("read ublox6, entry state = %d\n", state);
-
     bool new_position = false;
 
-    if ( state == 0 ) {
-	counter = 0;
-	cksum_A = cksum_B = 0;
-	len = ::read( fd, input, 1 );
-	while ( len > 0 && input[0] != 0xB5 ) {
-	    // fprintf( stderr, "state0: len = %d val = %2X\n", len, input[0] );
-	    len = ::read( fd, input, 1 );
-	}
-	if ( len > 0 && input[0] == 0xB5 ) {
-	    // fprintf( stderr, "read 0xB5\n");
-	    state++;
-	}
-    }
-    if ( state == 1 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    if ( input[0] == 0x62 ) {
-		// fprintf( stderr, "read 0x62\n");
-		state++;
-	    } else if ( input[0] == 0xB5 ) {
-		// fprintf( stderr, "read 0xB5\n");
-	    } else {
-		state = 0;
-	    }
-	}
-    }
-    if ( state == 2 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    msg_class = input[0];
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    // fprintf( stderr, "msg class = %d\n", msg_class );
-	    state++;
-	}
-    }
-    if ( state == 3 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    msg_id = input[0];
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    // fprintf( stderr, "msg id = %d\n", msg_id );
-	    state++;
-	}
-    }
-    if ( state == 4 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    length_lo = input[0];
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    state++;
-	}
-    }
-    if ( state == 5 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    length_hi = input[0];
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    payload_length = length_hi*256 + length_lo;
-	    // fprintf( stderr, "payload len = %d\n", payload_length );
-	    if ( payload_length > 400 ) {
-		state = 0;
-	    } else {
-		state++;
-	    }
-	}
-    }
-    if ( state == 6 ) {
-	len = ::read( fd, input, 1 );
-	while ( len > 0 ) {
-	    payload[counter++] = input[0];
-	    //fprintf( stderr, "%02X ", input[0] );
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    if ( counter >= payload_length ) {
-		break;
-	    }
-	    len = ::read( fd, input, 1 );
-	}
-
-	if ( counter >= payload_length ) {
-	    state++;
-	    //fprintf( stderr, "\n" );
-	}
-    }
-    if ( state == 7 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    cksum_lo = input[0];
-	    state++;
-	}
+    // one read() for everything the port has, then handle every
+    // complete message in it
+    ubx.fill( fd );
+    while ( ubx.parse() ) {
+        if ( parse_msg( ubx.msg_class, ubx.msg_id,
+                        ubx.payload_length, ubx.payload ) ) {
+            new_position = true;
+        }
     }
-    if ( state == 8 ) {
-	len = ::read( fd, input, 1 );
-	if ( len > 0 ) {
-	    cksum_hi = input[0];
-	    if ( cksum_A == cksum_lo && cksum_B == cksum_hi ) {
-		// fprintf( stderr, "checksum passes (%d)!\n", msg_id );
-		new_position = parse_msg();
-		state++;
-	    } else {
-		if ( verbose && 0 ) {
-		    printf("checksum failed %d %d (computed) != %d %d (message)\n",
-			   cksum_A, cksum_B, cksum_lo, cksum_hi );
-		}
-	    }
-	    // this is the end of a record, reset state to 0 to start
-	    // looking for next record
-	    state = 0;
-	}
+    if ( verbose && ubx.checksum_errors != last_checksum_errors ) {
+        printf("ublox6: checksum errors: %d\n", ubx.checksum_errors);
+        last_checksum_errors = ubx.checksum_errors;
     }
 
     return new_position;
@@ -12,6 +12,7 @@
 #include <pyprops.h>
 
 #include "drivers/driver.h"
+#include "drivers/ubx_link.h"
 
 class ublox9_t: public driver_t {
     
@@ -24,19 +25,16 @@ public:
     void write() {};
     void close();
     void command( const char *cmd ) {}
+    int get_fd() { return fd; }
 
 private:
     pyPropertyNode gps_node;
     int gps_fix_value = 0;
     int fd = -1;
-    static const int max_payload = 2048;
-    uint8_t payload[max_payload];
-    int state = 0;
-    int msg_class = 0, msg_id = 0;
-    int length_lo = 0, length_hi = 0, payload_length = 0;
-    int counter = 0;
-    uint8_t cksum_A = 0, cksum_B = 0, cksum_lo = 0, cksum_hi = 0;
+    ubx_link_t ubx;
+    uint32_t last_checksum_errors = 0;
     bool open( const char *device_name, const int baud );
     bool read_ublox9();
-    bool parse_msg();
+    bool parse_msg( uint8_t msg_class, uint8_t msg_id,
+                    uint16_t payload_length, uint8_t *payload );
 };
@@ -0,0 +1,85 @@
+// ubx_link.cpp - UBX (u-blox binary protocol) framing
+
+#include <string.h>		// memchr(), memcpy(), memmove()
+#include <unistd.h>		// read()
+
+#include "ubx_link.h"
+
+bool ubx_link_t::fill( int fd ) {
+    if ( fd < 0 ) {
+        return false;
+    }
+    // slide the unframed bytes to the front once the free space at
+    // the end runs low
+    if ( head > 0 && RX_BUF_SIZE - tail < RX_BUF_SIZE / 2 ) {
+        memmove( rx_buf, rx_buf + head, tail - head );
+        tail -= head;
+        head = 0;
+    }
+    if ( tail >= RX_BUF_SIZE ) {
+        // full of a partial message that can't complete, start over
+        reset();
+    }
+    int len = ::read( fd, rx_buf + tail, RX_BUF_SIZE - tail );
+    if ( len <= 0 ) {
+        return false;
+    }
+    tail += len;
+    return true;
+}
+
+bool ubx_link_t::parse() {
+    while ( tail - head >= 8 ) {
+        // sync
+        uint8_t *p = rx_buf + head;
+        if ( p[0] != 0xB5 ) {
+            uint8_t *sync = (uint8_t *)memchr( p, 0xB5, tail - head );
+            if ( sync == NULL ) {
+                head = tail = 0;
+                return false;
+            }
+            head = sync - rx_buf;
+            continue;
+        }
+        if ( p[1] != 0x62 ) {
+            head++;
+            continue;
+        }
+
+        // header
+        int len = p[4] | (p[5] << 8);
+        if ( len > max_payload ) {
+            head++;
+            continue;
+        }
+        if ( tail - head < len + 8 ) {
+            return false;       // wait for the rest of the message
+        }
+
+        // checksum over class, id, length, and payload
+        uint8_t cksum_A = 0, cksum_B = 0;
+        const uint8_t *span = p + 2;
+        const uint8_t *end = p + 6 + len;
+        while ( span < end ) {
+            cksum_A += *span++;
+            cksum_B += cksum_A;
+        }
+        if ( cksum_A != end[0] || cksum_B != end[1] ) {
+            // resync just past this sync byte
+            checksum_errors++;
+            head++;
+            continue;
+        }
+
+        msg_class = p[2];
+        msg_id = p[3];
+        payload_length = len;
+        memcpy( payload, p + 6, len );
+        head += len + 8;
+        if ( head == tail ) {
+            head = tail = 0;
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+// ubx_link.h - UBX (u-blox binary protocol) framing shared by the
+// ublox drivers
+//
+// fill() pulls everything the (non-blocking) port has available into
+// a linear buffer with a single read(), and parse() then frames one
+// complete message at a time out of the buffered bytes: sync on the
+// 0xB5 0x62 header, check the length, and run the Fletcher checksum
+// over the whole class/id/length/payload span.  A driver drains the
+// buffer with
+//
+//   ubx.fill( fd );
+//   while ( ubx.parse() ) { ...ubx.msg_class, ubx.payload, ... }
+//
+// so several messages (e.g. high rate NAV-PVT plus RXM-RAWX) are
+// handled per call without a system call per byte.
+
+#pragma once
+
+#include <stdint.h>
+
+class ubx_link_t {
+
+public:
+
+    static const int max_payload = 2048;
+
+    // the last message framed by parse(), payload is an aligned copy
+    // (valid until the next parse()) that the driver may modify
+    uint8_t msg_class = 0;
+    uint8_t msg_id = 0;
+    uint16_t payload_length = 0;
+    alignas(8) uint8_t payload[max_payload];
+
+    uint32_t checksum_errors = 0;
+
+    // read whatever fd has available, returns false if nothing new
+    bool fill( int fd );
+    // frame the next buffered message, returns false if none is complete
+    bool parse();
+    // drop any buffered bytes
+    void reset() { head = tail = 0; }
+
+private:
+
+    static const int RX_BUF_SIZE = 8192;
+    uint8_t rx_buf[RX_BUF_SIZE];
+    int head = 0;               // next byte to frame
+    int tail = 0;               // end of buffered bytes
+};
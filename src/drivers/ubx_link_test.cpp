@@ -0,0 +1,159 @@
+// ubx_link_test.cpp - frame UBX messages fed through a pipe (no
+// receiver needed)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             // pipe2()
+#endif
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ubx_link.h"
+#include "util/test_check.h"
+
+static int frame( uint8_t *out, uint8_t cls, uint8_t id, int len,
+                  bool corrupt = false ) {
+    int size = 0;
+    out[size++] = 0xB5;
+    out[size++] = 0x62;
+    out[size++] = cls;
+    out[size++] = id;
+    out[size++] = len & 0xff;
+    out[size++] = len >> 8;
+    for ( int i = 0; i < len; i++ ) {
+        out[size++] = (uint8_t)(cls + id + i);
+    }
+    uint8_t a = 0, b = 0;
+    for ( int i = 2; i < size; i++ ) {
+        a += out[i];
+        b += a;
+    }
+    out[size++] = corrupt ? a + 1 : a;
+    out[size++] = b;
+    return size;
+}
+
+static bool payload_ok( const ubx_link_t &ubx ) {
+    for ( int i = 0; i < ubx.payload_length; i++ ) {
+        if ( ubx.payload[i] != (uint8_t)(ubx.msg_class + ubx.msg_id + i) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    int p[2];
+    if ( pipe2( p, O_NONBLOCK ) < 0 ) {
+        perror("pipe2()");
+        return 1;
+    }
+    static ubx_link_t ubx;
+    static uint8_t buf[65536];
+
+    check( !ubx.fill( p[0] ), "nothing to read" );
+    check( !ubx.parse(), "nothing to frame" );
+
+    // several messages with noise between them in one read
+    int size = 0;
+    size += frame( buf + size, 0x01, 0x07, 92 );       // NAV-PVT
+    buf[size++] = 0x00;
+    buf[size++] = 0xB5;                                // stray sync
+    size += frame( buf + size, 0x02, 0x15, 16 + 32 * 20 ); // RXM-RAWX
+    size += frame( buf + size, 0x05, 0x01, 2 );        // ACK-ACK
+    size += frame( buf + size, 0x01, 0x07, 92, true ); // bad checksum
+    size += frame( buf + size, 0x0A, 0x04, 0 );        // empty payload
+    write( p[1], buf, size );
+    check( ubx.fill( p[0] ), "fill" );
+    int count = 0;
+    bool ok = true;
+    const uint8_t want[][2] = {
+        { 0x01, 0x07 }, { 0x02, 0x15 }, { 0x05, 0x01 }, { 0x0A, 0x04 }
+    };
+    while ( ubx.parse() ) {
+        if ( count >= 4 || ubx.msg_class != want[count][0]
+             || ubx.msg_id != want[count][1] || !payload_ok( ubx ) ) {
+            ok = false;
+        }
+        count++;
+    }
+    check( count == 4 && ok, "good messages framed in order" );
+    check( ubx.checksum_errors == 1, "bad checksum counted" );
+
+    // a message split across reads one byte at a time
+    size = frame( buf, 0x01, 0x07, 92 );
+    int framed = 0;
+    for ( int i = 0; i < size; i++ ) {
+        write( p[1], buf + i, 1 );
+        ubx.fill( p[0] );
+        while ( ubx.parse() ) {
+            framed++;
+        }
+        if ( i < size - 1 && framed ) {
+            break;
+        }
+    }
+    check( framed == 1 && payload_ok( ubx ), "split message framed once complete" );
+
+    // a length beyond max_payload is skipped
+    size = frame( buf, 0x01, 0x07, 4 );
+    buf[5] = 0x7f;
+    size += frame( buf + size, 0x01, 0x03, 16 );
+    write( p[1], buf, size );
+    ubx.fill( p[0] );
+    count = 0;
+    while ( ubx.parse() ) {
+        count++;
+    }
+    check( count == 1 && ubx.msg_id == 0x03, "oversized length resyncs" );
+
+    // a long stream through many fills, buffer compacts as it goes
+    count = 0;
+    ok = true;
+    for ( int round = 0; round < 200; round++ ) {
+        size = 0;
+        for ( int k = 0; k < 5; k++ ) {
+            size += frame( buf + size, 0x01, (uint8_t)(round + k), 100 + k * 150 );
+        }
+        // send in two uneven pieces so messages straddle fills
+        int cut = (round * 311) % size;
+        write( p[1], buf, cut );
+        ubx.fill( p[0] );
+        while ( ubx.parse() ) {
+            ok = ok && payload_ok( ubx );
+            count++;
+        }
+        write( p[1], buf + cut, size - cut );
+        ubx.fill( p[0] );
+        while ( ubx.parse() ) {
+            ok = ok && payload_ok( ubx );
+            count++;
+        }
+    }
+    check( count == 1000 && ok, "long stream intact" );
+
+    // a partial message that can never complete is eventually dropped
+    buf[0] = 0xB5;
+    buf[1] = 0x62;
+    buf[2] = 0x01;
+    buf[3] = 0x07;
+    buf[4] = 0xff;
+    buf[5] = 0x07;              // 2047 byte payload that never arrives
+    write( p[1], buf, 6 );
+    memset( buf, 0, sizeof(buf) );
+    for ( int i = 0; i < 5; i++ ) {
+        write( p[1], buf, 4096 );
+        ubx.fill( p[0] );
+        ubx.parse();
+    }
+    size = frame( buf, 0x05, 0x00, 2 );
+    write( p[1], buf, size );
+    ubx.fill( p[0] );
+    check( ubx.parse() && ubx.msg_class == 0x05 && ubx.msg_id == 0x00,
+           "recovers after junk" );
+
+    close( p[0] );
+    close( p[1] );
+    return check_summary();
+}
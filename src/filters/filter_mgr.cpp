@@ -20,6 +20,7 @@ using std::string;
 #include "filters/nav_ekf15/aura_interface.h"
 #include "filters/nav_ekf15_mag/aura_interface.h"
 #include "include/globaldefs.h"
+#include "util/props_handle.h"
 #include "util/props_helper.h"
 
 #include "ground.h"
@@ -48,6 +49,24 @@ static pyPropertyNode status_node;
 static vector<pyPropertyNode> sections;
 static vector<pyPropertyNode> outputs;
 
+// primary filter values copied to their published locations every
+// frame (bound once in Filter_init())
+struct prop_copy_t {
+    prop_double_t src;
+    prop_double_t dst;
+};
+static vector<prop_copy_t> published;
+static prop_long_t filter_status;
+static prop_double_t imu_timestamp;
+
+static void publish_bind( pyPropertyNode &src, const char *src_name,
+                          pyPropertyNode &dst, const char *dst_name ) {
+    prop_copy_t c;
+    c.src.bind( src, src_name );
+    c.dst.bind( dst, dst_name );
+    published.push_back( c );
+}
+
 void Filter_init() {
     pyPropsInit();              // first thing
     
@@ -64,6 +83,59 @@ void Filter_init() {
     pos_combined_node = pyGetNode("/position/combined", true);
     status_node = pyGetNode("/status", true);
 
+    filter_status.bind( filter_node, "status" );
+    imu_timestamp.bind( imu_node, "timestamp" );
+    publish_bind( filter_node, "roll_deg", orient_node, "roll_deg" );
+    publish_bind( filter_node, "pitch_deg", orient_node, "pitch_deg" );
+    publish_bind( filter_node, "heading_deg", orient_node, "heading_deg" );
+    publish_bind( filter_node, "latitude_deg", pos_node, "latitude_deg" );
+    publish_bind( filter_node, "longitude_deg", pos_node, "longitude_deg" );
+    publish_bind( filter_node, "altitude_m", pos_filter_node, "altitude_m" );
+    publish_bind( filter_node, "altitude_ft", pos_filter_node, "altitude_ft" );
+    publish_bind( filter_node, "vn_ms", vel_node, "vn_ms" );
+    publish_bind( filter_node, "ve_ms", vel_node, "ve_ms" );
+    publish_bind( filter_node, "vd_ms", vel_node, "vd_ms" );
+    publish_bind( filter_node, "timestamp", filter_group_node, "timestamp" );
+    // groundtrack/speed from the filter.  (The gps alternative
+    // computed them from /sensors/gps vn_ms, ve_ms:
+    // groundtrack_deg = 90 - atan2(vn, ve) * R2D,
+    // groundspeed_ms = sqrt(vn*vn + ve*ve).)
+    publish_bind( filter_node, "groundtrack_deg", orient_node, "groundtrack_deg" );
+    publish_bind( filter_node, "groundspeed_ms", vel_node, "groundspeed_ms" );
+    publish_bind( filter_node, "vertical_speed_fps", vel_node, "vertical_speed_fps" );
+
+    // select official source (currently AGL is pressure based,
+    // absolute ground alt is based on average gps/filter value at
+    // startup, and MSL altitude is based on pressure altitude -
+    // pressure error (pressure error computed as average difference
+    // between gps altitude and pressure altitude over time)):
+    //
+    // 1. /position/pressure
+    // 2. /position/filter
+    // 3. /position/combined
+    //official_alt_m_node->alias("/position/combined/altitude-true-m");
+    //official_alt_ft_node->alias("/position/combined/altitude-true-ft");
+    //official_agl_m_node->alias("/position/pressure/altitude-agl-m");
+    //official_agl_ft_node->alias("/position/pressure/altitude-agl-ft");
+    //official_ground_m_node->alias("/position/filter/altitude-ground-m");    
+
+    // the following block favors the baro based altimeter, but can
+    // suffer from cabin pressure change bias, temperature bias, or
+    // other unexplained biases.
+    // publish_bind( pos_combined_node, "altitude_true_m", pos_node, "altitude_m" );
+    // publish_bind( pos_combined_node, "altitude_true_ft", pos_node, "altitude_ft" );
+    // publish_bind( pos_pressure_node, "altitude_agl_m", pos_node, "altitude_agl_m" );
+    // publish_bind( pos_pressure_node, "altitude_agl_ft", pos_node, "altitude_agl_ft" );
+    // publish_bind( pos_filter_node, "altitude_ground_m", pos_node, "altitude_ground_m" );
+
+    // the following block favor the filter based altitude which can
+    // be adversely affected (significantly) by gps altitude errors.
+    publish_bind( pos_filter_node, "altitude_m", pos_node, "altitude_m" );
+    publish_bind( pos_filter_node, "altitude_ft", pos_node, "altitude_ft" );
+    publish_bind( pos_filter_node, "altitude_agl_m", pos_node, "altitude_agl_m" );
+    publish_bind( pos_filter_node, "altitude_agl_ft", pos_node, "altitude_agl_ft" );
+    publish_bind( pos_filter_node, "altitude_ground_m", pos_node, "altitude_ground_m" );
+
     // traverse configured modules
     pyPropertyNode group_node = pyGetNode("/config/filters", true);
     vector<string> children = group_node.getChildren();
@@ -134,19 +206,7 @@ static void update_euler_rates() {
 
 
 static void publish_values() {
-    orient_node.setDouble( "roll_deg", filter_node.getDouble("roll_deg") );
-    orient_node.setDouble( "pitch_deg", filter_node.getDouble("pitch_deg") );
-    orient_node.setDouble( "heading_deg", filter_node.getDouble("heading_deg") );
-    pos_node.setDouble( "latitude_deg", filter_node.getDouble("latitude_deg") );
-    pos_node.setDouble( "longitude_deg", filter_node.getDouble("longitude_deg") );
-    pos_filter_node.setDouble("altitude_m", filter_node.getDouble("altitude_m"));
-    pos_filter_node.setDouble("altitude_ft", filter_node.getDouble("altitude_ft"));
-    vel_node.setDouble( "vn_ms", filter_node.getDouble("vn_ms") );
-    vel_node.setDouble( "ve_ms", filter_node.getDouble("ve_ms") );
-    vel_node.setDouble( "vd_ms", filter_node.getDouble("vd_ms") );
-    filter_group_node.setDouble( "timestamp",
-				 filter_node.getDouble("timestamp") );
-    int status = filter_node.getLong("status");
+    int status = filter_status.get();
     if ( status == 0 ) {
         status_node.setString( "navigation", "invalid" );
     } else if ( status == 1 ) {
@@ -154,69 +214,16 @@ static void publish_values() {
     } else if ( status == 2 ) {
         status_node.setString( "navigation", "ok" );
     }
-    bool use_filter = true;
-    bool use_gps = !use_filter;
-    if ( use_filter ) {
-	orient_node.setDouble( "groundtrack_deg",
-			       filter_node.getDouble("groundtrack_deg") );
-	vel_node.setDouble( "groundspeed_ms",
-			    filter_node.getDouble("groundspeed_ms") );
-    } else if ( use_gps ) {
-	const double R2D = 57.295779513082323;
-	double vn = gps_node.getDouble("vn_ms");
-	double ve = gps_node.getDouble("ve_ms");
-	filter_node.setDouble( "groundtrack_deg", 90 - atan2(vn, ve) * R2D );
-	filter_node.setDouble( "groundspeed_ms", sqrt(vn*vn + ve*ve) );
-    }
-   
-    vel_node.setDouble( "vertical_speed_fps",
-			filter_node.getDouble("vertical_speed_fps") );
-    
-    // select official source (currently AGL is pressure based,
-    // absolute ground alt is based on average gps/filter value at
-    // startup, and MSL altitude is based on pressure altitude -
-    // pressure error (pressure error computed as average difference
-    // between gps altitude and pressure altitude over time)):
-    //
-    // 1. /position/pressure
-    // 2. /position/filter
-    // 3. /position/combined
-    //official_alt_m_node->alias("/position/combined/altitude-true-m");
-    //official_alt_ft_node->alias("/position/combined/altitude-true-ft");
-    //official_agl_m_node->alias("/position/pressure/altitude-agl-m");
-    //official_agl_ft_node->alias("/position/pressure/altitude-agl-ft");
-    //official_ground_m_node->alias("/position/filter/altitude-ground-m");    
-
-    // the following block favors the baro based altimeter, but can
-    // suffer from cabin pressure change bias, temperature bias, or
-    // other unexplained biases.
-    // pos_node.setDouble( "altitude_m",
-    //     		pos_combined_node.getDouble("altitude_true_m") );
-    // pos_node.setDouble( "altitude_ft",
-    //     		pos_combined_node.getDouble("altitude_true_ft") );
-    // pos_node.setDouble( "altitude_agl_m",
-    //     		pos_pressure_node.getDouble("altitude_agl_m") );
-    // pos_node.setDouble( "altitude_agl_ft",
-    //     		pos_pressure_node.getDouble("altitude_agl_ft") );
-    // pos_node.setDouble( "altitude_ground_m",
-    //     		pos_filter_node.getDouble("altitude_ground_m") );
 
-    // the following block favor the filter based altitude which can
-    // be adversely affected (significantly) by gps altitude errors.
-    pos_node.setDouble( "altitude_m",
-			pos_filter_node.getDouble("altitude_m") );
-    pos_node.setDouble( "altitude_ft",
-			pos_filter_node.getDouble("altitude_ft") );
-    pos_node.setDouble( "altitude_agl_m",
-			pos_filter_node.getDouble("altitude_agl_m") );
-    pos_node.setDouble( "altitude_agl_ft",
-			pos_filter_node.getDouble("altitude_agl_ft") );
-    pos_node.setDouble( "altitude_ground_m",
-			pos_filter_node.getDouble("altitude_ground_m") );
+    // orientation, position, velocity, groundtrack/speed and the
+    // official altitudes (the sources are selected in Filter_init())
+    for ( unsigned int i = 0; i < published.size(); i++ ) {
+        published[i].dst.set( published[i].src.get() );
+    }
 }
 
 bool Filter_update() {
-    double imu_time = imu_node.getDouble("timestamp");
+    double imu_time = imu_timestamp.get();
     double imu_dt = imu_time - last_imu_time;
     bool fresh_filter_data = false;
 
@@ -263,7 +270,7 @@ bool Filter_update() {
     }
     
     // only for primary filter
-    if ( filter_node.getLong("status") == 2 ) {
+    if ( filter_status.get() == 2 ) {
         update_euler_rates();
         update_ground(imu_dt);
         update_wind(imu_dt);
@@ -0,0 +1,203 @@
+/*! \file EKF_15state_core.h
+ *	\brief 15 state EKF navigation filter core
+ *
+ *	\details  15 state EKF navigation filter using loosely integrated INS/GPS architecture.
+ * 	Time update is done after every IMU data acquisition and GPS measurement
+ * 	update is done every time the new data flag in the GPS data packet is set. Designed by Adhika Lie.
+ *	Attitude is parameterized using quaternions.
+ *	Estimates IMU bias errors.
+ *
+ *	The filter is shared by every variant (nav-ekf15, nav-ekf15-mag,
+ *	...) and is parameterized on an aiding measurement model that
+ *	adds rows after the 6 gps position/velocity rows.  The model
+ *	fixes the measurement dimension at compile time so every matrix
+ *	in the update is fixed size.  An aiding model provides:
+ *
+ *	  static const int rows;   // number of aiding rows (may be 0)
+ *	  void init(const NAVconfig &config, const NAVdata &nav,
+ *	            Matrix<float,rows,1> &r);   // measurement variances
+ *	  void residual(const IMUdata &imu, const Matrix3f &C_N2B,
+ *	                Matrix<float,rows,1> &y, Matrix<float,rows,15> &H);
+ *
+ *	residual() fills the aiding part of y and H for the current
+ *	state.  A row with a non-finite residual is skipped by the
+ *	sequential update; a row with zero H has no effect.
+ *
+ *	The member definitions live in EKF_15state_core_impl.h and each
+ *	variant explicitly instantiates the core in its own source file.
+ *	\ingroup nav_fcns
+ *
+ * \author University of Minnesota
+ * \author Aerospace Engineering and Mechanics
+ * \copyright Copyright 2011 Regents of the University of Minnesota. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <math.h>
+#include <eigen3/Eigen/Core>
+#include <eigen3/Eigen/Geometry>
+#include <eigen3/Eigen/LU>
+using namespace Eigen;
+
+#include <vector>
+using std::vector;
+
+#include "constants.h"
+#include "structs.h"
+
+// usefule constants
+const float g = 9.814;
+
+// initial covariance (1 sigma)
+const float P_P_INIT = 10.0;
+const float P_V_INIT = 1.0;
+const float P_A_INIT = 0.34906;   // 20 deg
+const float P_HDG_INIT = 3.14159; // 180 deg
+const float P_AB_INIT = 0.9810;   // 0.5*g
+const float P_GB_INIT = 0.01745;  // 5 deg/s
+
+// define some types for notational convenience and consistency
+typedef Matrix<float,6,6> Matrix6f;
+typedef Matrix<float,12,12> Matrix12f;
+typedef Matrix<float,15,15> Matrix15f;
+typedef Matrix<float,15,6> Matrix15x6f;
+typedef Matrix<float,15,12> Matrix15x12f;
+typedef Matrix<float,6,1> Vector6f;
+typedef Matrix<float,15,1> Vector15f;
+
+template <class Aiding>
+class EKF15_core {
+
+public:
+
+    // measurement dimension: gps position/velocity + aiding rows
+    static const int M = 6 + Aiding::rows;
+    typedef Matrix<float,M,M> MatrixMf;
+    typedef Matrix<float,M,15> MatrixMx15f;
+    typedef Matrix<float,15,M> Matrix15xMf;
+    typedef Matrix<float,M,1> VectorMf;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    EKF15_core() {
+	default_config();
+    }
+    ~EKF15_core() {}
+
+    // set/get error characteristics of navigation sensors
+    void set_config(NAVconfig config);
+    NAVconfig get_config();
+    void default_config();
+
+    // select the block structured covariance propagation (skips the
+    // known zero/identity blocks of F, G, and Rw) instead of the
+    // dense PHI*P*PHI' + Q form.
+    void set_sparse_covariance(bool enable) { sparse_covariance = enable; }
+
+    // process the measurement update one scalar component at a time
+    // (R is diagonal) rather than inverting H*P*H' + R.
+    void set_sequential_update(bool enable) { sequential_update = enable; }
+
+    // run the strapdown integration every imu sample but propagate
+    // the covariance at (about) this rate from coning/sculling
+    // compensated delta angle/velocity.  0 = every imu sample.
+    void set_covariance_rate(float hz) { covariance_rate_hz = hz; }
+
+    // fuse gps measurements at (gps.time - sec) against a history of
+    // saved states rather than as if they were current (the aiding
+    // rows are formed from the imu sample at that epoch.)  0 = off.
+    // The history holds 1.5 x sec at the covariance propagation rate
+    // (sized on the first step, it grows if a measurement ever falls
+    // off the end.)
+    void set_gps_delay(float sec) { gps_delay_sec = sec; }
+
+    // main interface
+    void init(IMUdata imu, GPSdata gps);
+    void time_update(IMUdata imu);
+    // aiding rows use the imu sample from the last time_update()
+    void measurement_update(GPSdata gps) {
+        measurement_update(imu_last, gps);
+    }
+    void measurement_update(IMUdata imu, GPSdata gps);
+
+    // replace the state and covariance (after init())
+    void set_state(NAVdata state, const Matrix15f &cov);
+
+    NAVdata get_nav();
+
+private:
+
+    // saved state for delayed gps fusion
+    static const int HISTORY_MIN = 16;
+    static const int HISTORY_MAX = 4096;
+    struct history_t {
+        float time;
+        double lat, lon;
+        float alt;
+        Vector3f vel;
+        Matrix15f PHI;          // transition from the previous entry
+        Matrix15f P;            // covariance after this step
+        Matrix3f C_N2B;         // attitude and imu sample for the
+        IMUdata imu;            // aiding rows at this epoch
+    };
+
+    void propagate_covariance(float imu_dt);
+    void propagate_covariance_sparse(float imu_dt);
+    void accumulate_increments(float imu_dt);
+    void propagate_covariance_accumulated();
+    void reset_accumulators();
+    void gps_innovation(GPSdata gps, const Vector3d &pos_ref,
+                        const Vector3f &vel);
+    void aiding_innovation(const IMUdata &imu, const Matrix3f &C_N2B);
+    void save_history(float dt);
+    void resize_history(int size);
+    void correct_history(history_t &h, const Matrix15xMf &A,
+                         const MatrixMf &Sinv);
+    bool measurement_update_delayed(GPSdata gps);
+    int hist_index(int steps_back) {
+        int size = history.size();
+        return (hist_head - steps_back + size) % size;
+    }
+    void phi_mult(const Matrix15f &X, Matrix15f &Y);
+    void measurement_update_sequential();
+
+    Aiding aiding;
+
+    Matrix15f F, PHI, P, Qw, Q, ImKH, KRKt, I15 /* identity */, temp1515;
+    Matrix15x12f G;
+    Matrix15xMf K;
+    Vector15f x, k, PHt;
+    Matrix12f Rw;
+    MatrixMx15f H;
+    MatrixMf R;
+    VectorMf y;
+    Matrix3f C_N2B, C_B2N, I3 /* identity */, temp33;
+
+    // non-zero blocks of PHI used by the sparse covariance propagation
+    Matrix3f phi_va, phi_vb, phi_aa;
+    float phi_pv, phi_vp, phi_ag, phi_bb, phi_gg;
+    bool sparse_covariance = false;
+    bool sequential_update = false;
+
+    // multi-rate covariance propagation
+    float covariance_rate_hz = 0.0;
+    Vector3f acc_dtheta, acc_coning, acc_dvel, acc_sculling;
+    Matrix3f acc_C_B2N;
+    float acc_dt = 0.0;
+
+    // delayed gps fusion (ring buffer, hist_head is the newest entry)
+    float gps_delay_sec = 0.0;
+    vector<history_t, aligned_allocator<history_t> > history;
+    int hist_head = 0;
+    int hist_count = 0;
+    bool hist_warned = false;
+    Vector3f grav, f_b, om_ib, dx;
+
+    Quaternionf quat;
+
+    IMUdata imu_last;
+    NAVconfig config;
+    NAVdata nav;
+};
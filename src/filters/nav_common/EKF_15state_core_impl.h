@@ -0,0 +1,728 @@
+/*! \file EKF_15state_core_impl.h
+ *	\brief 15 state EKF navigation filter core (member definitions)
+ *
+ *	\details Included by the source file of each filter variant,
+ *	which then explicitly instantiates EKF15_core for its aiding
+ *	model (see EKF_15state_core.h.)
+ *	\ingroup nav_fcns
+ *
+ * \author University of Minnesota
+ * \author Aerospace Engineering and Mechanics
+ * \copyright Copyright 2011 Regents of the University of Minnesota. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <stdio.h>
+#include <cmath>
+
+#include "nav_functions.h"
+#include "EKF_15state_core.h"
+
+// BRT: (1) I think there are some several identity and sparse
+// matrices, so probably some optimization still left there.  (2)
+// Seems like a lot of the transforms could be more efficiently done
+// with just a matrix or vector multiply.  (3) Probably could do a lot
+// of block operations with F, i.e. F.block(j,k) = C_B2N, etc.  (4) A
+// lot of these multi line equations with temp matrices can be
+// compressed.
+
+template <class Aiding>
+void EKF15_core<Aiding>::set_config(NAVconfig config) {
+    this->config = config;
+}
+
+template <class Aiding>
+NAVconfig EKF15_core<Aiding>::get_config() {
+    return config;
+}
+
+template <class Aiding>
+void EKF15_core<Aiding>::default_config()
+{
+    config.sig_w_ax = 0.05;     // Std dev of Accelerometer Wide Band Noise (m/s^2)
+    config.sig_w_ay = 0.05;
+    config.sig_w_az = 0.05;
+    config.sig_w_gx = 0.00175;  // Std dev of gyro output noise (rad/s)  (0.1 deg/s)
+    config.sig_w_gy = 0.00175;
+    config.sig_w_gz = 0.00175;
+    config.sig_a_d  = 0.01;     // Std dev of Accelerometer Markov Bias
+    config.tau_a    = 100.0;    // Correlation time or time constant of b_{ad}
+    config.sig_g_d  = 0.00025;  // Std dev of correlated gyro bias (rad)
+    config.tau_g    = 50.0;     // Correlation time or time constant of b_{gd}
+    config.sig_gps_p_ne = 3.0;  // GPS measurement noise std dev (m)
+    config.sig_gps_p_d  = 6.0;  // GPS measurement noise std dev (m)
+    config.sig_gps_v_ne = 0.5;  // GPS measurement noise std dev (m/s)
+    config.sig_gps_v_d  = 1.0;  // GPS measurement noise std dev (m/s)
+    config.sig_mag      = 0.3;  // Magnetometer measurement noise std dev (normalized -1 to 1)
+}
+
+template <class Aiding>
+void EKF15_core<Aiding>::init(IMUdata imu, GPSdata gps) {
+    I15.setIdentity();
+    I3.setIdentity();
+
+    // Assemble the matrices
+    // .... gravity, g
+    grav = Vector3f(0.0, 0.0, g);
+	
+    // ... H
+    H.setZero();
+    H.topLeftCorner(6,6).setIdentity();
+
+    // first order correlation + white noise, tau = time constant for correlation
+    // gain on white noise plus gain on correlation
+    // Rw small - trust time update, Rw more - lean on measurement update
+    // split between accels and gyros and / or noise and correlation
+    // ... Rw
+    Rw.setZero();
+    Rw(0,0) = config.sig_w_ax*config.sig_w_ax;	Rw(1,1) = config.sig_w_ay*config.sig_w_ay;	      Rw(2,2) = config.sig_w_az*config.sig_w_az; //1 sigma on noise
+    Rw(3,3) = config.sig_w_gx*config.sig_w_gx;	Rw(4,4) = config.sig_w_gy*config.sig_w_gy;	      Rw(5,5) = config.sig_w_gz*config.sig_w_gz;
+    Rw(6,6) = 2*config.sig_a_d*config.sig_a_d/config.tau_a;	Rw(7,7) = 2*config.sig_a_d*config.sig_a_d/config.tau_a;    Rw(8,8) = 2*config.sig_a_d*config.sig_a_d/config.tau_a;
+    Rw(9,9) = 2*config.sig_g_d*config.sig_g_d/config.tau_g;	Rw(10,10) = 2*config.sig_g_d*config.sig_g_d/config.tau_g;  Rw(11,11) = 2*config.sig_g_d*config.sig_g_d/config.tau_g;
+
+    // ... P (initial)
+    P.setZero();
+    P(0,0) = P_P_INIT*P_P_INIT; 	P(1,1) = P_P_INIT*P_P_INIT; 	      P(2,2) = P_P_INIT*P_P_INIT;
+    P(3,3) = P_V_INIT*P_V_INIT; 	P(4,4) = P_V_INIT*P_V_INIT; 	      P(5,5) = P_V_INIT*P_V_INIT;
+    P(6,6) = P_A_INIT*P_A_INIT; 	P(7,7) = P_A_INIT*P_A_INIT; 	      P(8,8) = P_HDG_INIT*P_HDG_INIT;
+    P(9,9) = P_AB_INIT*P_AB_INIT; 	P(10,10) = P_AB_INIT*P_AB_INIT;       P(11,11) = P_AB_INIT*P_AB_INIT;
+    P(12,12) = P_GB_INIT*P_GB_INIT; 	P(13,13) = P_GB_INIT*P_GB_INIT;       P(14,14) = P_GB_INIT*P_GB_INIT;
+	
+    // ... R
+    R.setZero();
+    R(0,0) = config.sig_gps_p_ne*config.sig_gps_p_ne;	 R(1,1) = config.sig_gps_p_ne*config.sig_gps_p_ne;  R(2,2) = config.sig_gps_p_d*config.sig_gps_p_d;
+    R(3,3) = config.sig_gps_v_ne*config.sig_gps_v_ne;	 R(4,4) = config.sig_gps_v_ne*config.sig_gps_v_ne;  R(5,5) = config.sig_gps_v_d*config.sig_gps_v_d;
+	
+    // ... update P in get_nav
+    nav.Pp0 = P(0,0);	  nav.Pp1 = P(1,1);	nav.Pp2 = P(2,2);
+    nav.Pv0 = P(3,3);	  nav.Pv1 = P(4,4);	nav.Pv2 = P(5,5);
+    nav.Pa0 = P(6,6);	  nav.Pa1 = P(7,7);	nav.Pa2 = P(8,8);
+	
+    nav.Pabx = P(9,9);	  nav.Paby = P(10,10);	nav.Pabz = P(11,11);
+    nav.Pgbx = P(12,12);  nav.Pgby = P(13,13);  nav.Pgbz = P(14,14);
+	
+    // .. then initialize states with GPS Data
+    nav.lat = gps.lat*D2R;
+    nav.lon = gps.lon*D2R;
+    nav.alt = gps.alt;
+	
+    nav.vn = gps.vn;
+    nav.ve = gps.ve;
+    nav.vd = gps.vd;
+
+    // ... R (aiding rows), the aiding model may depend on position
+    Matrix<float,Aiding::rows,1> r_aiding;
+    aiding.init(config, nav, r_aiding);
+    for ( int i = 0; i < Aiding::rows; i++ ) {
+        R(6+i,6+i) = r_aiding(i);
+    }
+	
+    // ... and initialize states with IMU Data, theta from Ax, aircraft
+    // at rest
+    nav.the = asin(imu.ax/g); 
+    // phi from Ay, aircraft at rest
+    nav.phi = asin(imu.ay/(g*cos(nav.the)));
+
+    // this is atan2(x, -y) because the aircraft body X,Y axis are
+    // swapped with the cartesion axes from the top down perspective
+    // nav.psi = 90*D2R - atan2(imu.hx, -imu.hy);
+    // printf("ekf: hx: %.2f hy: %.2f psi: %.2f\n", imu.hx, imu.hy, nav.psi*R2D);
+    // printf("atan2: %.2f\n", atan2(imu.hx, -imu.hy)*R2D);
+
+    // tilt compensated heading
+    nav.psi = atan2(imu.hz*sin(nav.phi)-imu.hy*cos(nav.phi),imu.hx*cos(nav.the)+imu.hy*sin(nav.the)*sin(nav.phi)+imu.hz*sin(nav.the)*cos(nav.phi));
+    printf("tilt compensated psi: %.2f\n", nav.psi*R2D);
+	
+    quat = eul2quat(nav.phi, nav.the, nav.psi);
+
+    nav.abx = 0.0;
+    nav.aby = 0.0;
+    nav.abz = 0.0;
+
+    // I might want to initialize these to zero assuming imu driver
+    // has made some plausible attempt to zero it's own gyro biases.
+    nav.gbx = imu.p;
+    nav.gby = imu.q;
+    nav.gbz = imu.r;
+	
+    imu_last = imu;
+    reset_accumulators();
+    hist_head = 0;
+    hist_count = 0;
+	
+    nav.time = imu.time;
+    nav.err_type = data_valid;
+}
+
+// Main get_nav filter function
+template <class Aiding>
+void EKF15_core<Aiding>::time_update(IMUdata imu) {
+    // compute time-elapsed 'dt'
+    // This compute the navigation state at the DAQ's Time Stamp
+    float imu_dt = imu.time - imu_last.time;
+    nav.time = imu.time;
+
+    // ==================  Time Update  ===================
+
+    // Attitude Update
+    // ... Calculate Navigation Rate
+    Vector3f vel_vec(nav.vn, nav.ve, nav.vd);
+    Vector3d pos_ref(nav.lat, nav.lon, nav.alt);
+
+    if ( false ) {
+        // Get the new Specific forces and Rotation Rate from previous
+        // frame (k) to use in this frame (k+1).  Rectangular
+        // integration.
+        f_b(0) = imu_last.ax - nav.abx;
+        f_b(1) = imu_last.ay - nav.aby;
+        f_b(2) = imu_last.az - nav.abz;
+
+        om_ib(0) = imu_last.p - nav.gbx;
+        om_ib(1) = imu_last.q - nav.gby;
+        om_ib(2) = imu_last.r - nav.gbz;
+    } else if ( false ) {
+        // Combine the Specific forces and Rotation Rate from previous
+        // frame (k) with current frame (k+1) to use in this frame
+        // (k+1).  Trapazoidal integration.
+        f_b(0) = 0.5 * (imu_last.ax + imu.ax) - nav.abx;
+        f_b(1) = 0.5 * (imu_last.ay + imu.ay) - nav.aby;
+        f_b(2) = 0.5 * (imu_last.az + imu.az) - nav.abz;
+
+        om_ib(0) = 0.5 * (imu_last.p + imu.p) - nav.gbx;
+        om_ib(1) = 0.5 * (imu_last.q + imu.q) - nav.gby;
+        om_ib(2) = 0.5 * (imu_last.r + imu.r) - nav.gbz;
+    } else {
+        // Chris says the first two ways are BS
+        f_b(0) = imu.ax - nav.abx;
+        f_b(1) = imu.ay - nav.aby;
+        f_b(2) = imu.az - nav.abz;
+
+        om_ib(0) = imu.p - nav.gbx;
+        om_ib(1) = imu.q - nav.gby;
+        om_ib(2) = imu.r - nav.gbz;
+    }
+
+    imu_last = imu;
+
+    if ( covariance_rate_hz > 0.0 ) {
+        accumulate_increments(imu_dt);
+    }
+
+    Quaternionf dq = Quaternionf(1.0, 0.5*om_ib(0)*imu_dt, 0.5*om_ib(1)*imu_dt, 0.5*om_ib(2)*imu_dt);
+    quat = (quat * dq).normalized();
+
+    if (quat.w() < 0) {
+        // Avoid quaternion flips sign
+        quat = Quaternionf(-quat.w(), -quat.x(), -quat.y(), -quat.z());
+    }
+    
+    Vector3f att_vec = quat2eul(quat);
+    nav.phi = att_vec(0);
+    nav.the = att_vec(1);
+    nav.psi = att_vec(2);
+	
+    // AHRS Transformations
+    C_N2B = quat2dcm(quat);
+    C_B2N = C_N2B.transpose();
+	
+    // Velocity Update
+    dx = C_B2N * f_b;
+    dx += grav;
+	
+    nav.vn += imu_dt*dx(0);
+    nav.ve += imu_dt*dx(1);
+    nav.vd += imu_dt*dx(2);
+	
+    // Position Update
+    dx = llarate(vel_vec, pos_ref);
+    nav.lat += imu_dt*dx(0);
+    nav.lon += imu_dt*dx(1);
+    nav.alt += imu_dt*dx(2);
+	
+    if ( covariance_rate_hz <= 0.0 ) {
+        propagate_covariance(imu_dt);
+    } else if ( acc_dt + 0.5 * imu_dt >= 1.0 / covariance_rate_hz ) {
+        propagate_covariance_accumulated();
+    }
+	
+    nav.Pp0 = P(0,0);     nav.Pp1 = P(1,1);     nav.Pp2 = P(2,2);
+    nav.Pv0 = P(3,3);     nav.Pv1 = P(4,4);     nav.Pv2 = P(5,5);
+    nav.Pa0 = P(6,6);     nav.Pa1 = P(7,7);     nav.Pa2 = P(8,8);
+    nav.Pabx = P(9,9);    nav.Paby = P(10,10);  nav.Pabz = P(11,11);
+    nav.Pgbx = P(12,12);  nav.Pgby = P(13,13);  nav.Pgbz = P(14,14);
+
+    // ==================  DONE TU  ===================
+}
+
+// Covariance time update over dt, linearized about the current
+// C_B2N, f_b, and om_ib.
+template <class Aiding>
+void EKF15_core<Aiding>::propagate_covariance(float imu_dt) {
+    if ( sparse_covariance ) {
+        propagate_covariance_sparse(imu_dt);
+    } else {
+        // JACOBIAN
+        F.setZero();
+        // ... pos2gs
+        F(0,3) = 1.0; 	F(1,4) = 1.0; 	F(2,5) = 1.0;
+        // ... gs2pos
+        F(5,2) = -2 * g / EarthRadius;
+	
+        // ... gs2att
+        temp33 = C_B2N * sk(f_b);
+	
+        F(3,6) = -2.0*temp33(0,0);  F(3,7) = -2.0*temp33(0,1);  F(3,8) = -2.0*temp33(0,2);
+        F(4,6) = -2.0*temp33(1,0);  F(4,7) = -2.0*temp33(1,1);  F(4,8) = -2.0*temp33(1,2);
+        F(5,6) = -2.0*temp33(2,0);  F(5,7) = -2.0*temp33(2,1);  F(5,8) = -2.0*temp33(2,2);
+	
+        // ... gs2acc
+        F(3,9) = -C_B2N(0,0);  F(3,10) = -C_B2N(0,1);  F(3,11) = -C_B2N(0,2);
+        F(4,9) = -C_B2N(1,0);  F(4,10) = -C_B2N(1,1);  F(4,11) = -C_B2N(1,2);
+        F(5,9) = -C_B2N(2,0);  F(5,10) = -C_B2N(2,1);  F(5,11) = -C_B2N(2,2);
+	
+        // ... att2att
+        temp33 = sk(om_ib);
+        F(6,6) = -temp33(0,0);  F(6,7) = -temp33(0,1);  F(6,8) = -temp33(0,2);
+        F(7,6) = -temp33(1,0);  F(7,7) = -temp33(1,1);  F(7,8) = -temp33(1,2);
+        F(8,6) = -temp33(2,0);  F(8,7) = -temp33(2,1);  F(8,8) = -temp33(2,2);
+	
+        // ... att2gyr
+        F(6,12) = -0.5;
+        F(7,13) = -0.5;
+        F(8,14) = -0.5;
+	
+        // ... Accel Markov Bias
+        F(9,9) = -1.0/config.tau_a;    F(10,10) = -1.0/config.tau_a;  F(11,11) = -1.0/config.tau_a;
+        F(12,12) = -1.0/config.tau_g;  F(13,13) = -1.0/config.tau_g;  F(14,14) = -1.0/config.tau_g;
+	
+        // State Transition Matrix: PHI = I15 + F*dt;
+        PHI = I15 + F * imu_dt;
+	
+        // Process Noise
+        G.setZero();
+        G(3,0) = -C_B2N(0,0);   G(3,1) = -C_B2N(0,1);   G(3,2) = -C_B2N(0,2);
+        G(4,0) = -C_B2N(1,0);   G(4,1) = -C_B2N(1,1);   G(4,2) = -C_B2N(1,2);
+        G(5,0) = -C_B2N(2,0);   G(5,1) = -C_B2N(2,1);   G(5,2) = -C_B2N(2,2);
+	
+        G(6,3) = -0.5;
+        G(7,4) = -0.5;
+        G(8,5) = -0.5;
+	
+        G(9,6) = 1.0; 	    G(10,7) = 1.0; 	    G(11,8) = 1.0;
+        G(12,9) = 1.0; 	    G(13,10) = 1.0; 	    G(14,11) = 1.0;
+
+        // Discrete Process Noise
+        Qw = G * Rw * G.transpose() * imu_dt;		// Qw = dt*G*Rw*G'
+        Q = PHI * Qw;					// Q = (I+F*dt)*Qw
+        Q = (Q + Q.transpose()) * 0.5;			// Q = 0.5*(Q+Q')
+	
+        // Covariance Time Update
+        P = PHI * P * PHI.transpose() + Q;			// P = PHI*P*PHI' + Q
+        P = (P + P.transpose()) * 0.5;			// P = 0.5*(P+P')
+    }
+
+    if ( gps_delay_sec > 0.0 ) {
+        save_history(imu_dt);
+    }
+}
+
+// Accumulate the delta angle/delta velocity (in the body frame at the
+// start of the accumulation interval) with first order coning and
+// sculling compensation.  Must be called before the attitude update
+// of the current sample.
+template <class Aiding>
+void EKF15_core<Aiding>::accumulate_increments(float imu_dt) {
+    if ( acc_dt <= 0.0 ) {
+        acc_C_B2N = quat2dcm(quat).transpose();
+    }
+    Vector3f dtheta = om_ib * imu_dt;
+    Vector3f dvel = f_b * imu_dt;
+    acc_coning += 0.5 * acc_dtheta.cross(dtheta);
+    acc_sculling += 0.5 * (acc_dtheta.cross(dvel) + acc_dvel.cross(dtheta));
+    acc_dtheta += dtheta;
+    acc_dvel += dvel;
+    acc_dt += imu_dt;
+}
+
+// Propagate the covariance across the accumulated interval using the
+// average (compensated) rate and specific force, then start a new
+// interval.
+template <class Aiding>
+void EKF15_core<Aiding>::propagate_covariance_accumulated() {
+    if ( acc_dt <= 0.0 ) {
+        return;
+    }
+    Vector3f dtheta = acc_dtheta + acc_coning;
+    Vector3f dvel = acc_dvel + 0.5 * acc_dtheta.cross(acc_dvel) + acc_sculling;
+    om_ib = dtheta / acc_dt;
+    // rotate into the current body frame to match C_B2N
+    f_b = C_N2B * (acc_C_B2N * dvel) / acc_dt;
+    propagate_covariance(acc_dt);
+    reset_accumulators();
+}
+
+template <class Aiding>
+void EKF15_core<Aiding>::reset_accumulators() {
+    acc_dtheta.setZero();
+    acc_coning.setZero();
+    acc_dvel.setZero();
+    acc_sculling.setZero();
+    acc_dt = 0.0;
+}
+
+// Y = PHI * X visiting only the non-zero 3x3 blocks of PHI = I15 +
+// F*dt (see the JACOBIAN section of time_update() for the layout.)
+template <class Aiding>
+void EKF15_core<Aiding>::phi_mult(const Matrix15f &X, Matrix15f &Y) {
+    Y.block<3,15>(0,0) = X.block<3,15>(0,0) + phi_pv * X.block<3,15>(3,0);
+    Y.block<3,15>(3,0) = X.block<3,15>(3,0);
+    Y.block<3,15>(3,0).noalias() += phi_va * X.block<3,15>(6,0);
+    Y.block<3,15>(3,0).noalias() += phi_vb * X.block<3,15>(9,0);
+    Y.row(5) += phi_vp * X.row(2);
+    Y.block<3,15>(6,0).noalias() = phi_aa * X.block<3,15>(6,0);
+    Y.block<3,15>(6,0) += phi_ag * X.block<3,15>(12,0);
+    Y.block<3,15>(9,0) = phi_bb * X.block<3,15>(9,0);
+    Y.block<3,15>(12,0) = phi_gg * X.block<3,15>(12,0);
+}
+
+// Covariance time update equivalent to the dense path in
+// time_update(), but F, G, and PHI are never assembled.  PHI is
+// applied blockwise and Qw = dt*G*Rw*G' is block diagonal so only the
+// vel/att/bias diagonal blocks are computed.
+template <class Aiding>
+void EKF15_core<Aiding>::propagate_covariance_sparse(float imu_dt) {
+    phi_pv = imu_dt;
+    phi_vp = -2 * g / EarthRadius * imu_dt;
+    phi_va = C_B2N * sk(f_b) * (-2.0 * imu_dt);
+    phi_vb = C_B2N * -imu_dt;
+    phi_aa = I3 - sk(om_ib) * imu_dt;
+    phi_ag = -0.5 * imu_dt;
+    phi_bb = 1.0 - imu_dt / config.tau_a;
+    phi_gg = 1.0 - imu_dt / config.tau_g;
+
+    // Discrete Process Noise, Qw = dt*G*Rw*G'
+    Qw.setZero();
+    Qw.block<3,3>(3,3) = C_B2N * Rw.block<3,3>(0,0).diagonal().asDiagonal()
+        * C_B2N.transpose() * imu_dt;
+    Qw.block<3,3>(6,6) = Rw.block<3,3>(3,3) * (0.25 * imu_dt);
+    Qw.block<3,3>(9,9) = Rw.block<3,3>(6,6) * imu_dt;
+    Qw.block<3,3>(12,12) = Rw.block<3,3>(9,9) * imu_dt;
+    phi_mult(Qw, Q);                            // Q = (I+F*dt)*Qw
+    Q = (Q + Q.transpose()) * 0.5;              // Q = 0.5*(Q+Q')
+
+    // Covariance Time Update, P = PHI*(PHI*P)' + Q (P is symmetric)
+    phi_mult(P, temp1515);
+    phi_mult(temp1515.transpose(), P);
+    P += Q;
+    P = (P + P.transpose()) * 0.5;              // P = 0.5*(P+P')
+}
+
+// apply a NED position error correction to a lat/lon/alt triple
+static inline void correct_position(const Vector15f &dx, double &lat, double &lon,
+                             float &alt)
+{
+    double denom = fabs(1.0 - (ECC2 * sin(lat) * sin(lat)));
+    double denom_sqrt = sqrt(denom);
+    double Re = EarthRadius / denom_sqrt;
+    double Rn = EarthRadius * (1-ECC2) * denom_sqrt / denom;
+    alt = alt - dx(2);
+    lat = lat + dx(0)/(Re + alt);
+    lon = lon + dx(1)/(Rn + alt)/cos(lat);
+}
+
+// gps position/velocity residual (y) relative to the given ins state
+template <class Aiding>
+void EKF15_core<Aiding>::gps_innovation(GPSdata gps, const Vector3d &pos_ref,
+                           const Vector3f &vel)
+{
+    // Position, converted to NED
+    Vector3d pos_ins_ecef = lla2ecef(pos_ref);
+
+    Vector3d pos_gps(gps.lat*D2R, gps.lon*D2R, gps.alt);
+    Vector3d pos_gps_ecef = lla2ecef(pos_gps);
+    
+    Vector3d pos_error_ecef = pos_gps_ecef - pos_ins_ecef;
+    
+    Vector3f pos_error_ned = ecef2ned(pos_error_ecef, pos_ref);
+
+    // Create Measurement: y
+    y(0) = pos_error_ned(0);
+    y(1) = pos_error_ned(1);
+    y(2) = pos_error_ned(2);
+		
+    y(3) = gps.vn - vel(0);
+    y(4) = gps.ve - vel(1);
+    y(5) = gps.vd - vel(2);
+}
+
+// aiding rows of y and H from the given imu sample and attitude
+template <class Aiding>
+void EKF15_core<Aiding>::aiding_innovation(const IMUdata &imu,
+                                           const Matrix3f &C_N2B)
+{
+    Matrix<float,Aiding::rows,1> y_aiding;
+    Matrix<float,Aiding::rows,15> H_aiding;
+    aiding.residual(imu, C_N2B, y_aiding, H_aiding);
+    y.template tail<Aiding::rows>() = y_aiding;
+    H.template bottomRows<Aiding::rows>() = H_aiding;
+}
+
+template <class Aiding>
+void EKF15_core<Aiding>::measurement_update(IMUdata imu, GPSdata gps) {
+    // bring the covariance up to date if propagation is decimated
+    propagate_covariance_accumulated();
+
+    // ==================  GPS Update  ===================
+
+    if ( gps_delay_sec > 0.0 && measurement_update_delayed(gps) ) {
+        // Kalman Gain, Covariance Update, and state error (x) computed
+        // at the gps epoch and carried forward to the current time
+    } else if ( sequential_update ) {
+        gps_innovation(gps, Vector3d(nav.lat, nav.lon, nav.alt),
+                       Vector3f(nav.vn, nav.ve, nav.vd));
+        aiding_innovation(imu, C_N2B);
+        // Kalman Gain, Covariance Update, and state error (x) one
+        // scalar measurement at a time
+        measurement_update_sequential();
+    } else {
+        gps_innovation(gps, Vector3d(nav.lat, nav.lon, nav.alt),
+                       Vector3f(nav.vn, nav.ve, nav.vd));
+        aiding_innovation(imu, C_N2B);
+
+        // Kalman Gain
+        // K = P*H'*inv(H*P*H'+R)
+        K = P * H.transpose() * (H * P * H.transpose() + R).inverse();
+		
+        // Covariance Update
+        ImKH = I15 - K * H;	                // ImKH = I - K*H
+		
+        KRKt = K * R * K.transpose();		// KRKt = K*R*K'
+		
+        P = ImKH * P * ImKH.transpose() + KRKt;	// P = ImKH*P*ImKH' + KRKt
+
+        x = K * y;
+    }
+		
+    nav.Pp0 = P(0,0);     nav.Pp1 = P(1,1);     nav.Pp2 = P(2,2);
+    nav.Pv0 = P(3,3);     nav.Pv1 = P(4,4);     nav.Pv2 = P(5,5);
+    nav.Pa0 = P(6,6);     nav.Pa1 = P(7,7);     nav.Pa2 = P(8,8);
+    nav.Pabx = P(9,9);    nav.Paby = P(10,10);  nav.Pabz = P(11,11);
+    nav.Pgbx = P(12,12);  nav.Pgby = P(13,13);  nav.Pgbz = P(14,14);
+		
+    // State Update
+    correct_position(x, nav.lat, nav.lon, nav.alt);
+		
+    nav.vn = nav.vn + x(3);
+    nav.ve = nav.ve + x(4);
+    nav.vd = nav.vd + x(5);
+		
+    // Attitude correction
+    Quaternionf dq = Quaternionf(1.0, x(6), x(7), x(8));
+    quat = (quat * dq).normalized();
+		
+    Vector3f att_vec = quat2eul(quat);
+    nav.phi = att_vec(0);
+    nav.the = att_vec(1);
+    nav.psi = att_vec(2);
+	
+    nav.abx += x(9);
+    nav.aby += x(10);
+    nav.abz += x(11);
+
+    nav.gbx += x(12);
+    nav.gby += x(13);
+    nav.gbz += x(14);
+}
+
+
+// Sequential form of the measurement update.  R is diagonal so each
+// component of y can be applied as an independent scalar
+// measurement.  The gps
+// rows of H are the identity for the first 6 states so those need no
+// P*H' product.  This needs no matrix inverse and each covariance
+// update is rank-1.  Components with a non-finite residual are
+// skipped.
+template <class Aiding>
+void EKF15_core<Aiding>::measurement_update_sequential() {
+    x.setZero();
+    for ( int i = 0; i < M; i++ ) {
+        if ( !std::isfinite(y(i)) ) {
+            continue;
+        }
+        float s, hx;
+        if ( i < 6 ) {
+            PHt = P.col(i);                     // PHt = P*H'
+            s = PHt(i) + R(i,i);                // s = H*P*H' + R
+            hx = x(i);
+        } else {
+            PHt.noalias() = P * H.row(i).transpose();
+            s = H.row(i).dot(PHt) + R(i,i);
+            hx = H.row(i).dot(x);
+        }
+        k = PHt / s;                            // k = P*H'/s
+        x += k * (y(i) - hx);
+        P -= k * PHt.transpose();               // P = (I - k*H)*P
+    }
+    P = (P + P.transpose()) * 0.5;              // P = 0.5*(P+P')
+}
+
+// Record the propagated state and covariance (dt after the previous
+// entry) so a late gps measurement can be fused at its epoch.  The
+// ring is sized to the gps delay on the first step (an entry is ~2KB
+// so a fixed worst case size would be wasteful), after that no
+// allocation happens in the loop.
+template <class Aiding>
+void EKF15_core<Aiding>::save_history(float dt) {
+    if ( history.empty() && dt > 0.0 ) {
+        int size = (int)ceil(1.5 * gps_delay_sec / dt) + 2;
+        if ( size < HISTORY_MIN ) {
+            size = HISTORY_MIN;
+        }
+        if ( size > HISTORY_MAX ) {
+            size = HISTORY_MAX;
+        }
+        resize_history(size);
+    }
+    if ( history.empty() ) {
+        return;
+    }
+    if ( sparse_covariance ) {
+        // assemble PHI from the blocks used by phi_mult()
+        PHI = I15;
+        PHI.block<3,3>(0,3) = I3 * phi_pv;
+        PHI(5,2) = phi_vp;
+        PHI.block<3,3>(3,6) = phi_va;
+        PHI.block<3,3>(3,9) = phi_vb;
+        PHI.block<3,3>(6,6) = phi_aa;
+        PHI.block<3,3>(6,12) = I3 * phi_ag;
+        PHI.block<3,3>(9,9) = I3 * phi_bb;
+        PHI.block<3,3>(12,12) = I3 * phi_gg;
+    }
+    hist_head = (hist_head + 1) % history.size();
+    if ( hist_count < (int)history.size() ) {
+        hist_count++;
+    }
+    history_t &h = history[hist_head];
+    h.time = nav.time;
+    h.lat = nav.lat;
+    h.lon = nav.lon;
+    h.alt = nav.alt;
+    h.vel = Vector3f(nav.vn, nav.ve, nav.vd);
+    h.PHI = PHI;
+    h.P = P;
+    h.C_N2B = C_N2B;
+    h.imu = imu_last;
+}
+
+// resize the ring keeping the newest entries
+template <class Aiding>
+void EKF15_core<Aiding>::resize_history(int size) {
+    vector<history_t, aligned_allocator<history_t> > resized(size);
+    int keep = hist_count < size ? hist_count : size;
+    for ( int i = 0; i < keep; i++ ) {
+        resized[keep - 1 - i] = history[hist_index(i)];
+    }
+    history.swap(resized);
+    hist_head = keep > 0 ? keep - 1 : 0;
+    hist_count = keep;
+}
+
+// apply a (forward propagated) measurement correction to a saved
+// history entry so later delayed updates see a consistent state
+template <class Aiding>
+void EKF15_core<Aiding>::correct_history(history_t &h, const Matrix15xMf &A,
+                                         const MatrixMf &Sinv)
+{
+    correct_position(x, h.lat, h.lon, h.alt);
+    h.vel += x.segment<3>(3);
+    h.P -= A * Sinv * A.transpose();
+}
+
+// Fuse the gps measurement (and the aiding rows formed from the imu
+// sample at the same epoch) against the saved state at its epoch
+// (gps.time - gps_delay_sec).  The gain P_k*H'*inv(S) and the state
+// correction are carried to the current time through the saved PHI
+// matrices rather than re-running the filter, and every saved entry
+// since the epoch is corrected along the way.  Returns false if there
+// is no history to fuse against.
+template <class Aiding>
+bool EKF15_core<Aiding>::measurement_update_delayed(GPSdata gps) {
+    if ( hist_count == 0 ) {
+        return false;
+    }
+
+    // newest entry at or before the epoch (or the oldest available)
+    float epoch = gps.time - gps_delay_sec;
+    int n = 0;
+    while ( n < hist_count - 1 && history[hist_index(n)].time > epoch ) {
+        n++;
+    }
+    history_t &h = history[hist_index(n)];
+    int grow = 0;
+    if ( h.time > epoch && hist_count == (int)history.size()
+         && (int)history.size() < HISTORY_MAX ) {
+        // the epoch fell off the end (imu rate higher than the first
+        // step suggested): fuse at the oldest entry this time and
+        // grow the ring for the next measurement
+        if ( !hist_warned ) {
+            printf("ekf15: gps epoch %.3f older than the %d entry history (oldest %.3f), growing it\n",
+                   epoch, hist_count, h.time);
+            hist_warned = true;
+        }
+        grow = 2 * history.size();
+        if ( grow > HISTORY_MAX ) {
+            grow = HISTORY_MAX;
+        }
+    }
+
+    gps_innovation(gps, Vector3d(h.lat, h.lon, h.alt), h.vel);
+    aiding_innovation(h.imu, h.C_N2B);
+
+    Matrix15xMf A = h.P * H.transpose();        // A = PHI_k..j * P_j*H'
+    MatrixMf Sinv = (H * A + R).inverse();      // inv(H*P_j*H' + R)
+    x = A * Sinv * y;
+    correct_history(h, A, Sinv);
+    for ( int i = n - 1; i >= 0; i-- ) {
+        history_t &hi = history[hist_index(i)];
+        A = hi.PHI * A;
+        x = hi.PHI * x;
+        correct_history(hi, A, Sinv);
+    }
+
+    // Covariance Update: P = P - A*inv(S)*A'
+    P -= A * Sinv * A.transpose();
+    P = (P + P.transpose()) * 0.5;
+
+    if ( grow > 0 ) {
+        resize_history(grow);
+    }
+    return true;
+}
+
+// replace the state and covariance (e.g. with a hypothesis selected by
+// EKF15_bank), call after init()
+template <class Aiding>
+void EKF15_core<Aiding>::set_state(NAVdata state, const Matrix15f &cov) {
+    nav = state;
+    quat = Quaternionf(nav.qw, nav.qx, nav.qy, nav.qz);
+    P = cov;
+    reset_accumulators();
+    hist_count = 0;
+}
+
+template <class Aiding>
+NAVdata EKF15_core<Aiding>::get_nav() {
+    nav.qw = quat.w();
+    nav.qx = quat.x();
+    nav.qy = quat.y();
+    nav.qz = quat.z();
+
+    return nav;
+}
+
+
@@ -176,16 +176,6 @@ static double htnm_wmm2015[13][13]=
 
 static const int nmax = 12;
 
-static double P[13][13];
-static double DP[13][13];
-static double gnm[13][13];
-static double hnm[13][13];
-static double sm[13];
-static double cm[13];
-
-static double root[13];
-static double roots[13][13][2];
-
 /* Convert date to Julian day    1950-2049 */
 unsigned long int yymmdd_to_julian_days( int yy, int mm, int dd )
 {
@@ -204,7 +194,8 @@ unsigned long int yymmdd_to_julian_days( int yy, int mm, int dd )
 /* Convert unix date (seconds since the epoc) to Julian day: 1950-2049 */
 unsigned long int unixdate_to_julian_days( time_t current_time )
 {
-    struct tm *date = gmtime(&current_time);
+    struct tm tm_date;
+    struct tm *date = gmtime_r(&current_time, &tm_date);
     /* tm_year + 1900 yield the current date, so when tm_year is 109
        (+ 1900 = 2009).  yymmdd_to_julian_days wants the year in YY
        format so this is computed as tm_year - 100, which works for
@@ -227,6 +218,9 @@ unsigned long int now_to_julian_days()
  * return variation (in radians) given geodetic latitude (radians),
  * longitude(radians), height (km) and (Julian) date
  * N and E lat and long are positive, S and W negative
+ *
+ * All working storage is local so this may be called from several
+ * threads at once (e.g. ekf-replay.)
 */
 
 double calc_magvar( double lat, double lon, double h, long dat, double* field )
@@ -239,7 +233,17 @@ double calc_magvar( double lat, double lon, double h, long dat, double* field )
     double yearfrac,sr,r,theta,c,s,psi,fn,fn_0,B_r,B_theta,B_phi,X,Y,Z;
     double sinpsi, cospsi, inv_s;
 
-    static int been_here = 0;
+    /* the lower triangle recurrence reads P[m-1][m] (times a zero
+       root) at n = m+1, so the whole square starts out zeroed */
+    double P[13][13] = {{0}};
+    double DP[13][13] = {{0}};
+    double gnm[13][13];
+    double hnm[13][13];
+    double sm[13];
+    double cm[13];
+
+    double root[13];
+    double roots[13][13][2];
 
     double sinlat = sin(lat);
     double coslat = cos(lat);
@@ -264,14 +268,6 @@ double calc_magvar( double lat, double lon, double h, long dat, double* field )
     /* protect against zero divide at geographic poles */
     inv_s =  1.0 / (s + (s == 0.)*1.0e-8);
 
-    /* zero out arrays */
-    for ( n = 0; n <= nmax; n++ ) {
-	for ( m = 0; m <= n; m++ ) {
-	    P[n][m] = 0;
-	    DP[n][m] = 0;
-	}
-    }
-
     /* diagonal elements */
     P[0][0] = 1;
     P[1][1] = s;
@@ -280,20 +276,18 @@ double calc_magvar( double lat, double lon, double h, long dat, double* field )
     P[1][0] = c ;
     DP[1][0] = -s;
 
-    // these values will not change for subsequent function calls
-    if( !been_here ) {
-	for ( n = 2; n <= nmax; n++ ) {
-	    root[n] = sqrt((2.0*n-1) / (2.0*n));
-	}
+    // constant, but cheap enough to compute per call (no shared
+    // state)
+    for ( n = 2; n <= nmax; n++ ) {
+	root[n] = sqrt((2.0*n-1) / (2.0*n));
+    }
 
-	for ( m = 0; m <= nmax; m++ ) {
-	    double mm = m*m;
-	    for ( n = SG_MAX2(m + 1, 2); n <= nmax; n++ ) {
-		roots[m][n][0] = sqrt((n-1)*(n-1) - mm);
-		roots[m][n][1] = 1.0 / sqrt( n*n - mm);
-	    }
+    for ( m = 0; m <= nmax; m++ ) {
+	double mm = m*m;
+	for ( n = SG_MAX2(m + 1, 2); n <= nmax; n++ ) {
+	    roots[m][n][0] = sqrt((n-1)*(n-1) - mm);
+	    roots[m][n][1] = 1.0 / sqrt( n*n - mm);
 	}
-	been_here = 1;
     }
 
     for ( n=2; n <= nmax; n++ ) {
@@ -0,0 +1,364 @@
+/*! \file EKF_15state_bank.cpp
+ *	\brief Bank of 15 state EKF's for multi-hypothesis heading init
+ *
+ *	\details The math follows EKF15 (time update with the block
+ *	structured covariance propagation and the sequential scalar GPS
+ *	update) written out per state element so each operation covers
+ *	all hypotheses at once.
+ */
+
+#include <stdio.h>
+
+#include "../nav_common/nav_functions.h"
+#include "EKF_15state_bank.h"
+
+// collapse when the hypotheses agreeing with the best one (heading
+// within collapse_heading_rad) are this likely after this many gps
+// updates with the vehicle moving faster than min_speed_ms
+static const float collapse_probability = 0.95;
+static const float collapse_heading_rad = 10.0 * D2R;
+static const int collapse_updates = 10;
+static const float min_speed_ms = 3.0;
+
+void EKF15_bank::set_config(NAVconfig config) {
+    this->config = config;
+}
+
+NAVconfig EKF15_bank::get_config() {
+    return config;
+}
+
+void EKF15_bank::default_config() {
+    EKF15 ekf;
+    config = ekf.get_config();
+}
+
+void EKF15_bank::init(IMUdata imu, GPSdata gps) {
+    rw_acc[0] = config.sig_w_ax*config.sig_w_ax;
+    rw_acc[1] = config.sig_w_ay*config.sig_w_ay;
+    rw_acc[2] = config.sig_w_az*config.sig_w_az;
+    rw_gyr[0] = config.sig_w_gx*config.sig_w_gx;
+    rw_gyr[1] = config.sig_w_gy*config.sig_w_gy;
+    rw_gyr[2] = config.sig_w_gz*config.sig_w_gz;
+    rw_ab = 2*config.sig_a_d*config.sig_a_d/config.tau_a;
+    rw_gb = 2*config.sig_g_d*config.sig_g_d/config.tau_g;
+    r_gps[0] = r_gps[1] = config.sig_gps_p_ne*config.sig_gps_p_ne;
+    r_gps[2] = config.sig_gps_p_d*config.sig_gps_p_d;
+    r_gps[3] = r_gps[4] = config.sig_gps_v_ne*config.sig_gps_v_ne;
+    r_gps[5] = config.sig_gps_v_d*config.sig_gps_v_d;
+
+    // ... P (initial), the heading sigma is half the hypothesis spacing
+    float p_hdg = P_HDG_INIT / EKF15_BANK_SIZE;
+    float p_diag[15] = { P_P_INIT, P_P_INIT, P_P_INIT,
+                         P_V_INIT, P_V_INIT, P_V_INIT,
+                         P_A_INIT, P_A_INIT, p_hdg,
+                         P_AB_INIT, P_AB_INIT, P_AB_INIT,
+                         P_GB_INIT, P_GB_INIT, P_GB_INIT };
+    for ( int i = 0; i < 15; i++ ) {
+        for ( int j = 0; j < 15; j++ ) {
+            P[i][j].setZero();
+        }
+        P[i][i].setConstant(p_diag[i]*p_diag[i]);
+    }
+
+    // .. then initialize states with GPS Data
+    lat.setConstant(gps.lat*D2R);
+    lon.setConstant(gps.lon*D2R);
+    alt.setConstant(gps.alt);
+    vn.setConstant(gps.vn);
+    ve.setConstant(gps.ve);
+    vd.setConstant(gps.vd);
+
+    // ... and IMU Data (aircraft at rest), the tilt compensated mag
+    // heading is hypothesis 0 and the rest are spaced evenly around
+    // the circle
+    float the = asin(imu.ax/g);
+    float phi = asin(imu.ay/(g*cos(the)));
+    float psi = atan2(imu.hz*sin(phi)-imu.hy*cos(phi),imu.hx*cos(the)+imu.hy*sin(the)*sin(phi)+imu.hz*sin(the)*cos(phi));
+    for ( int k = 0; k < EKF15_BANK_SIZE; k++ ) {
+        Quaternionf q = eul2quat(phi, the, psi + 2.0*M_PI*k/EKF15_BANK_SIZE);
+        qw(k) = q.w(); qx(k) = q.x(); qy(k) = q.y(); qz(k) = q.z();
+    }
+
+    ab[0].setZero(); ab[1].setZero(); ab[2].setZero();
+    gb[0].setConstant(imu.p);
+    gb[1].setConstant(imu.q);
+    gb[2].setConstant(imu.r);
+
+    loglik.setZero();
+    moving_updates = 0;
+    imu_last = imu;
+    time = imu.time;
+}
+
+// Y = PHI * X using only the non-zero blocks of PHI (see
+// EKF15::phi_mult())
+void EKF15_bank::phi_mult(const Lanes X[15][15], Lanes Y[15][15]) {
+    for ( int c = 0; c < 15; c++ ) {
+        for ( int r = 0; r < 3; r++ ) {
+            Y[r][c] = X[r][c] + phi_pv * X[3+r][c];
+            Y[3+r][c] = X[3+r][c]
+                + phi_va[r][0]*X[6][c] + phi_va[r][1]*X[7][c] + phi_va[r][2]*X[8][c]
+                + phi_vb[r][0]*X[9][c] + phi_vb[r][1]*X[10][c] + phi_vb[r][2]*X[11][c];
+            Y[6+r][c] = phi_aa[r][0]*X[6][c] + phi_aa[r][1]*X[7][c]
+                + phi_aa[r][2]*X[8][c] + phi_ag * X[12+r][c];
+            Y[9+r][c] = phi_bb * X[9+r][c];
+            Y[12+r][c] = phi_gg * X[12+r][c];
+        }
+        Y[5][c] += phi_vp * X[2][c];
+    }
+}
+
+void EKF15_bank::time_update(IMUdata imu) {
+    float imu_dt = imu.time - imu_last.time;
+    imu_last = imu;
+    time = imu.time;
+
+    Lanes f_b[3] = { imu.ax - ab[0], imu.ay - ab[1], imu.az - ab[2] };
+    Lanes om_ib[3] = { imu.p - gb[0], imu.q - gb[1], imu.r - gb[2] };
+
+    // the position update uses the velocity from the previous step
+    Lanes vn0 = vn, ve0 = ve, vd0 = vd;
+
+    // Attitude Update, quat = quat * (1, 0.5*om_ib*dt)
+    Lanes dx = 0.5 * imu_dt * om_ib[0];
+    Lanes dy = 0.5 * imu_dt * om_ib[1];
+    Lanes dz = 0.5 * imu_dt * om_ib[2];
+    Lanes w = qw - qx*dx - qy*dy - qz*dz;
+    Lanes x = qw*dx + qx + qy*dz - qz*dy;
+    Lanes y = qw*dy - qx*dz + qy + qz*dx;
+    Lanes z = qw*dz + qx*dy - qy*dx + qz;
+    // normalize and avoid quaternion sign flips
+    Lanes scale = (w < 0).select(-1.0f, Lanes::Ones())
+        / (w*w + x*x + y*y + z*z).sqrt();
+    qw = w * scale; qx = x * scale; qy = y * scale; qz = z * scale;
+
+    // AHRS Transformations (C_B2N = quat2dcm(quat)')
+    C_B2N[0][0] = 2*(qw*qw + qx*qx) - 1;
+    C_B2N[1][1] = 2*(qw*qw + qy*qy) - 1;
+    C_B2N[2][2] = 2*(qw*qw + qz*qz) - 1;
+    C_B2N[1][0] = 2*(qx*qy + qw*qz);
+    C_B2N[2][0] = 2*(qx*qz - qw*qy);
+    C_B2N[0][1] = 2*(qx*qy - qw*qz);
+    C_B2N[2][1] = 2*(qy*qz + qw*qx);
+    C_B2N[0][2] = 2*(qx*qz + qw*qy);
+    C_B2N[1][2] = 2*(qy*qz - qw*qx);
+
+    // Velocity Update
+    Lanes a_n[3];
+    for ( int r = 0; r < 3; r++ ) {
+        a_n[r] = C_B2N[r][0]*f_b[0] + C_B2N[r][1]*f_b[1] + C_B2N[r][2]*f_b[2];
+    }
+    vn += imu_dt * a_n[0];
+    ve += imu_dt * a_n[1];
+    vd += imu_dt * (a_n[2] + g);
+
+    // Position Update (llarate())
+    Lanesd sin_lat = lat.sin();
+    Lanesd denom = (1.0 - ECC2 * sin_lat * sin_lat).abs();
+    Lanesd sqrt_denom = denom.sqrt();
+    Lanesd Rew = EarthRadius / sqrt_denom;
+    Lanesd Rns = EarthRadius*(1-ECC2) / (denom*sqrt_denom);
+    Lanesd altd = alt.cast<double>();
+    lon += imu_dt * ve0.cast<double>() / ((Rew + altd) * lat.cos());
+    lat += imu_dt * vn0.cast<double>() / (Rns + altd);
+    alt -= imu_dt * vd0;
+
+    // non-zero blocks of PHI = I15 + F*dt
+    phi_pv = imu_dt;
+    phi_vp = -2 * g / EarthRadius * imu_dt;
+    phi_ag = -0.5 * imu_dt;
+    phi_bb = 1.0 - imu_dt / config.tau_a;
+    phi_gg = 1.0 - imu_dt / config.tau_g;
+    Lanes sk_f[3][3] = { { Lanes::Zero(), -f_b[2], f_b[1] },
+                         { f_b[2], Lanes::Zero(), -f_b[0] },
+                         { -f_b[1], f_b[0], Lanes::Zero() } };
+    for ( int r = 0; r < 3; r++ ) {
+        for ( int c = 0; c < 3; c++ ) {
+            phi_va[r][c] = -2.0 * imu_dt * (C_B2N[r][0]*sk_f[0][c]
+                                            + C_B2N[r][1]*sk_f[1][c]
+                                            + C_B2N[r][2]*sk_f[2][c]);
+            phi_vb[r][c] = -imu_dt * C_B2N[r][c];
+        }
+    }
+    phi_aa[0][0] = Lanes::Ones();  phi_aa[0][1] = imu_dt*om_ib[2];  phi_aa[0][2] = -imu_dt*om_ib[1];
+    phi_aa[1][0] = -imu_dt*om_ib[2];  phi_aa[1][1] = Lanes::Ones();  phi_aa[1][2] = imu_dt*om_ib[0];
+    phi_aa[2][0] = imu_dt*om_ib[1];  phi_aa[2][1] = -imu_dt*om_ib[0];  phi_aa[2][2] = Lanes::Ones();
+
+    // Discrete Process Noise, Qw = dt*G*Rw*G' (block diagonal)
+    for ( int i = 0; i < 15; i++ ) {
+        for ( int j = 0; j < 15; j++ ) {
+            Qw[i][j].setZero();
+        }
+    }
+    for ( int r = 0; r < 3; r++ ) {
+        for ( int c = 0; c < 3; c++ ) {
+            Qw[3+r][3+c] = imu_dt * (C_B2N[r][0]*rw_acc[0]*C_B2N[c][0]
+                                     + C_B2N[r][1]*rw_acc[1]*C_B2N[c][1]
+                                     + C_B2N[r][2]*rw_acc[2]*C_B2N[c][2]);
+        }
+        Qw[6+r][6+r].setConstant(0.25 * rw_gyr[r] * imu_dt);
+        Qw[9+r][9+r].setConstant(rw_ab * imu_dt);
+        Qw[12+r][12+r].setConstant(rw_gb * imu_dt);
+    }
+    phi_mult(Qw, Q);                            // Q = (I+F*dt)*Qw
+
+    // Covariance Time Update, P = PHI*(PHI*P)' + 0.5*(Q+Q')
+    phi_mult(P, T);
+    for ( int i = 0; i < 15; i++ ) {
+        for ( int j = 0; j < 15; j++ ) {
+            TT[i][j] = T[j][i];
+        }
+    }
+    phi_mult(TT, P);
+    for ( int i = 0; i < 15; i++ ) {
+        for ( int j = i; j < 15; j++ ) {
+            Lanes p = 0.5 * (P[i][j] + P[j][i] + Q[i][j] + Q[j][i]);
+            P[i][j] = p;
+            P[j][i] = p;
+        }
+    }
+}
+
+void EKF15_bank::measurement_update(GPSdata gps) {
+    // gps residual per hypothesis (the ecef conversions are scalar
+    // code, but this only runs at the gps rate)
+    Lanes y[6];
+    Vector3d pos_gps(gps.lat*D2R, gps.lon*D2R, gps.alt);
+    Vector3d pos_gps_ecef = lla2ecef(pos_gps);
+    for ( int k = 0; k < EKF15_BANK_SIZE; k++ ) {
+        Vector3d pos_ref(lat(k), lon(k), alt(k));
+        Vector3f pos_error_ned = ecef2ned(pos_gps_ecef - lla2ecef(pos_ref),
+                                          pos_ref);
+        y[0](k) = pos_error_ned(0);
+        y[1](k) = pos_error_ned(1);
+        y[2](k) = pos_error_ned(2);
+    }
+    y[3] = gps.vn - vn;
+    y[4] = gps.ve - ve;
+    y[5] = gps.vd - vd;
+
+    // Sequential scalar update (see EKF15::measurement_update_sequential())
+    // accumulating the log likelihood of each innovation
+    Lanes x[15], k[15], PHt[15];
+    for ( int i = 0; i < 15; i++ ) {
+        x[i].setZero();
+    }
+    for ( int i = 0; i < 6; i++ ) {
+        Lanes s = P[i][i] + r_gps[i];
+        Lanes innov = y[i] - x[i];
+        loglik -= 0.5 * (innov * innov / s + s.log());
+        for ( int j = 0; j < 15; j++ ) {
+            PHt[j] = P[j][i];
+            k[j] = PHt[j] / s;
+        }
+        for ( int r = 0; r < 15; r++ ) {
+            x[r] += k[r] * innov;
+            for ( int c = 0; c < 15; c++ ) {
+                P[r][c] -= k[r] * PHt[c];
+            }
+        }
+    }
+    for ( int i = 0; i < 15; i++ ) {
+        for ( int j = i + 1; j < 15; j++ ) {
+            Lanes p = 0.5 * (P[i][j] + P[j][i]);
+            P[i][j] = p;
+            P[j][i] = p;
+        }
+    }
+
+    // State Update
+    Lanesd sin_lat = lat.sin();
+    Lanesd denom = (1.0 - ECC2 * sin_lat * sin_lat).abs();
+    Lanesd denom_sqrt = denom.sqrt();
+    Lanesd Re = EarthRadius / denom_sqrt;
+    Lanesd Rn = EarthRadius * (1-ECC2) * denom_sqrt / denom;
+    alt -= x[2];
+    Lanesd altd = alt.cast<double>();
+    lat += x[0].cast<double>() / (Re + altd);
+    lon += x[1].cast<double>() / (Rn + altd) / lat.cos();
+
+    vn += x[3];
+    ve += x[4];
+    vd += x[5];
+
+    // Attitude correction, quat = quat * (1, x6, x7, x8)
+    Lanes w = qw - qx*x[6] - qy*x[7] - qz*x[8];
+    Lanes qx1 = qw*x[6] + qx + qy*x[8] - qz*x[7];
+    Lanes qy1 = qw*x[7] - qx*x[8] + qy + qz*x[6];
+    Lanes qz1 = qw*x[8] + qx*x[7] - qy*x[6] + qz;
+    Lanes scale = 1.0 / (w*w + qx1*qx1 + qy1*qy1 + qz1*qz1).sqrt();
+    qw = w * scale; qx = qx1 * scale; qy = qy1 * scale; qz = qz1 * scale;
+
+    for ( int i = 0; i < 3; i++ ) {
+        ab[i] += x[9+i];
+        gb[i] += x[12+i];
+    }
+
+    if ( gps.vn*gps.vn + gps.ve*gps.ve > min_speed_ms*min_speed_ms ) {
+        moving_updates++;
+    }
+}
+
+int EKF15_bank::best() {
+    int i;
+    loglik.maxCoeff(&i);
+    return i;
+}
+
+float EKF15_bank::best_probability() {
+    Lanes w = (loglik - loglik.maxCoeff()).exp();
+    return 1.0 / w.sum();
+}
+
+// neighboring hypotheses usually settle on the same heading, so sum
+// the probability of every hypothesis that agrees with the best one
+bool EKF15_bank::converged() {
+    if ( moving_updates < collapse_updates ) {
+        return false;
+    }
+    int i = best();
+    Lanes w = (loglik - loglik(i)).exp();
+    Lanes psi = (2*(qw*qz + qx*qy)).binaryExpr(1 - 2*(qy*qy + qz*qz),
+                      [](float y, float x) { return atan2f(y, x); });
+    Lanes dpsi = (psi - psi(i)).abs();
+    dpsi = (dpsi > M_PI).select(2*M_PI - dpsi, dpsi);
+    float agree = (dpsi < collapse_heading_rad).select(w, 0).sum();
+    return agree / w.sum() >= collapse_probability;
+}
+
+NAVdata EKF15_bank::get_nav(int i) {
+    NAVdata nav;
+    nav.time = time;
+    nav.lat = lat(i);
+    nav.lon = lon(i);
+    nav.alt = alt(i);
+    nav.vn = vn(i);
+    nav.ve = ve(i);
+    nav.vd = vd(i);
+    Quaternionf quat(qw(i), qx(i), qy(i), qz(i));
+    Vector3f att_vec = quat2eul(quat);
+    nav.phi = att_vec(0);
+    nav.the = att_vec(1);
+    nav.psi = att_vec(2);
+    nav.qw = qw(i); nav.qx = qx(i); nav.qy = qy(i); nav.qz = qz(i);
+    nav.abx = ab[0](i); nav.aby = ab[1](i); nav.abz = ab[2](i);
+    nav.gbx = gb[0](i); nav.gby = gb[1](i); nav.gbz = gb[2](i);
+    nav.Pp0 = P[0][0](i);     nav.Pp1 = P[1][1](i);     nav.Pp2 = P[2][2](i);
+    nav.Pv0 = P[3][3](i);     nav.Pv1 = P[4][4](i);     nav.Pv2 = P[5][5](i);
+    nav.Pa0 = P[6][6](i);     nav.Pa1 = P[7][7](i);     nav.Pa2 = P[8][8](i);
+    nav.Pabx = P[9][9](i);    nav.Paby = P[10][10](i);  nav.Pabz = P[11][11](i);
+    nav.Pgbx = P[12][12](i);  nav.Pgby = P[13][13](i);  nav.Pgbz = P[14][14](i);
+    nav.err_type = data_valid;
+    return nav;
+}
+
+Matrix15f EKF15_bank::get_covariance(int i) {
+    Matrix15f result;
+    for ( int r = 0; r < 15; r++ ) {
+        for ( int c = 0; c < 15; c++ ) {
+            result(r,c) = P[r][c](i);
+        }
+    }
+    return result;
+}
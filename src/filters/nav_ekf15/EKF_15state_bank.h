@@ -0,0 +1,81 @@
+/*! \file EKF_15state_bank.h
+ *	\brief Bank of 15 state EKF's for multi-hypothesis heading init
+ *
+ *	\details Runs EKF15_BANK_SIZE copies of the 15 state filter in
+ *	lock step, each started from a different initial heading.  The
+ *	state and covariance are laid out as a structure of arrays (one
+ *	SIMD lane per hypothesis) so every time and measurement update
+ *	runs across all hypotheses in one vectorized pass.  The GPS
+ *	innovation likelihood of each hypothesis is accumulated so the
+ *	bank can be collapsed to the best one once GPS velocity has
+ *	resolved the heading.
+ */
+
+#pragma once
+
+#include "EKF_15state.h"
+
+// number of parallel heading hypotheses (one SIMD lane each)
+const int EKF15_BANK_SIZE = 8;
+
+class EKF15_bank {
+
+public:
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Array<float,EKF15_BANK_SIZE,1> Lanes;
+    typedef Array<double,EKF15_BANK_SIZE,1> Lanesd;
+
+    EKF15_bank() {
+	default_config();
+    }
+    ~EKF15_bank() {}
+
+    // set/get error characteristics of navigation sensors
+    void set_config(NAVconfig config);
+    NAVconfig get_config();
+    void default_config();
+
+    // main interface
+    void init(IMUdata imu, GPSdata gps);
+    void time_update(IMUdata imu);
+    void measurement_update(GPSdata gps);
+
+    // most likely hypothesis, its normalized probability, and true
+    // once the gps velocity has resolved the heading (the hypotheses
+    // agreeing with the best one carry nearly all the probability)
+    int best();
+    float best_probability();
+    bool converged();
+
+    // state and covariance of one hypothesis (to hand off to EKF15)
+    NAVdata get_nav(int i);
+    Matrix15f get_covariance(int i);
+
+private:
+
+    void phi_mult(const Lanes X[15][15], Lanes Y[15][15]);
+
+    NAVconfig config;
+
+    // noise terms (shared by all hypotheses)
+    float rw_acc[3], rw_gyr[3], rw_ab, rw_gb, r_gps[6];
+
+    // per hypothesis state
+    Lanesd lat, lon;
+    Lanes alt, vn, ve, vd;
+    Lanes qw, qx, qy, qz;
+    Lanes ab[3], gb[3];
+    Lanes P[15][15];
+    Lanes loglik;
+
+    // scratch
+    Lanes C_B2N[3][3], phi_va[3][3], phi_vb[3][3], phi_aa[3][3];
+    float phi_pv, phi_vp, phi_ag, phi_bb, phi_gg;
+    Lanes Qw[15][15], Q[15][15], T[15][15], TT[15][15];
+
+    IMUdata imu_last;
+    float time;
+    int moving_updates;
+};
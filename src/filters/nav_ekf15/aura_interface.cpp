@@ -6,20 +6,25 @@
 #include <pyprops.h>
 
 #include <math.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "include/globaldefs.h"
+#include "util/props_handle.h"
+#include "util/props_record.h"
 
 #include "../nav_common/constants.h"
 
 #include "aura_interface.h"
 #include "EKF_15state.h"
+#include "EKF_15state_bank.h"
 
 // these are the important sensor and result structures used by the
 // UMN code.  To avoid pointers and dynamic allocation, create static
 // copies of these and use them henceforth.
 
 static EKF15 filter;
+static EKF15_bank bank;
 
 static IMUdata imu_data;
 static GPSdata gps_data;
@@ -30,30 +35,58 @@ static pyPropertyNode imu_node;
 static pyPropertyNode gps_node;
 static pyPropertyNode filter_node;
 
+// per-frame values, bound once in init
+static struct {
+    prop_double_t time, p, q, r, ax, ay, az, hx, hy, hz;
+} imu_props;
+static struct {
+    prop_double_t time, lat, lon, alt, vn, ve, vd, data_age;
+    prop_bool_t settle;
+} gps_props;
+// filter outputs, published to filter_node as one record per frame
+struct ekf15_out_t {
+    double timestamp;
+    double roll_deg, pitch_deg, heading_deg;
+    double latitude_deg, longitude_deg, altitude_m;
+    double vn_ms, ve_ms, vd_ms;
+    double p_bias, q_bias, r_bias, ax_bias, ay_bias, az_bias;
+    double max_pos_cov, max_vel_cov, max_att_cov;
+    double altitude_ft, groundtrack_deg;
+    double groundspeed_ms, groundspeed_kt, vertical_speed_fps;
+    long status;
+};
+static ekf15_out_t filter_out;
+static prop_record_t filter_record;
+
 // when false will trigger a nav init if gps is alive and settled
 static bool nav_inited = false;
 
+// multi-hypothesis heading init: run the bank until the gps velocity
+// picks a heading, then seed the main filter from the best hypothesis
+static bool heading_bank = false;
+static bool bank_active = false;
+
 // update the imu_data and gps_data structures with most recent sensor
 // data prior to calling the filter init or update routines
 static void props2umn(void) {
-    imu_data.time = imu_node.getDouble("timestamp");
-    imu_data.p = imu_node.getDouble("p_rad_sec");
-    imu_data.q = imu_node.getDouble("q_rad_sec");
-    imu_data.r = imu_node.getDouble("r_rad_sec");
-    imu_data.ax = imu_node.getDouble("ax_mps_sec");
-    imu_data.ay = imu_node.getDouble("ay_mps_sec");
-    imu_data.az = imu_node.getDouble("az_mps_sec");
-    imu_data.hx = imu_node.getDouble("hx");
-    imu_data.hy = imu_node.getDouble("hy");
-    imu_data.hz = imu_node.getDouble("hz");
-
-    gps_data.time = gps_node.getDouble("timestamp");
-    gps_data.lat = gps_node.getDouble("latitude_deg");
-    gps_data.lon = gps_node.getDouble("longitude_deg");
-    gps_data.alt = gps_node.getDouble("altitude_m");
-    gps_data.vn = gps_node.getDouble("vn_ms");
-    gps_data.ve = gps_node.getDouble("ve_ms");
-    gps_data.vd = gps_node.getDouble("vd_ms");
+    imu_data.time = imu_props.time.get();
+    imu_data.p = imu_props.p.get();
+    imu_data.q = imu_props.q.get();
+    imu_data.r = imu_props.r.get();
+    imu_data.ax = imu_props.ax.get();
+    imu_data.ay = imu_props.ay.get();
+    imu_data.az = imu_props.az.get();
+    imu_data.hx = imu_props.hx.get();
+    imu_data.hy = imu_props.hy.get();
+    imu_data.hz = imu_props.hz.get();
+
+    gps_data.time = gps_props.time.get();
+    gps_data.lat = gps_props.lat.get();
+    gps_data.lon = gps_props.lon.get();
+    gps_data.alt = gps_props.alt.get();
+    gps_data.vn = gps_props.vn.get();
+    gps_data.ve = gps_props.ve.get();
+    gps_data.vd = gps_props.vd.get();
 }
 
 // update the property tree values from the nav_data structure
@@ -62,31 +95,31 @@ static void umn2props(void) {
     double psi = nav_data.psi;
     if ( psi < 0 ) { psi += M_PI*2.0; }
     if ( psi > M_PI*2.0 ) { psi -= M_PI*2.0; }
-    filter_node.setDouble( "timestamp", imu_data.time );
-    filter_node.setDouble( "roll_deg", nav_data.phi * R2D );
-    filter_node.setDouble( "pitch_deg", nav_data.the * R2D );
-    filter_node.setDouble( "heading_deg", psi * R2D );
-    filter_node.setDouble( "latitude_deg", nav_data.lat * R2D );
-    filter_node.setDouble( "longitude_deg", nav_data.lon * R2D );
-    filter_node.setDouble( "altitude_m", nav_data.alt );
-    filter_node.setDouble( "vn_ms", nav_data.vn );
-    filter_node.setDouble( "ve_ms", nav_data.ve );
-    filter_node.setDouble( "vd_ms", nav_data.vd );
+    filter_out.timestamp = imu_data.time;
+    filter_out.roll_deg = nav_data.phi * R2D;
+    filter_out.pitch_deg = nav_data.the * R2D;
+    filter_out.heading_deg = psi * R2D;
+    filter_out.latitude_deg = nav_data.lat * R2D;
+    filter_out.longitude_deg = nav_data.lon * R2D;
+    filter_out.altitude_m = nav_data.alt;
+    filter_out.vn_ms = nav_data.vn;
+    filter_out.ve_ms = nav_data.ve;
+    filter_out.vd_ms = nav_data.vd;
     if ( nav_data.err_type == data_valid ||
 	 nav_data.err_type == TU_only ||
 	 nav_data.err_type == gps_aided )
     {
-	filter_node.setLong( "status", 2 );
+	filter_out.status = 2;
     } else {
-	filter_node.setLong( "status", 1 );
+	filter_out.status = 1;
     }
 
-    filter_node.setDouble( "p_bias", nav_data.gbx );
-    filter_node.setDouble( "q_bias", nav_data.gby );
-    filter_node.setDouble( "r_bias", nav_data.gbz );
-    filter_node.setDouble( "ax_bias", nav_data.abx );
-    filter_node.setDouble( "ay_bias", nav_data.aby );
-    filter_node.setDouble( "az_bias", nav_data.abz );
+    filter_out.p_bias = nav_data.gbx;
+    filter_out.q_bias = nav_data.gby;
+    filter_out.r_bias = nav_data.gbz;
+    filter_out.ax_bias = nav_data.abx;
+    filter_out.ay_bias = nav_data.aby;
+    filter_out.az_bias = nav_data.abz;
     
     float max_pos_cov = nav_data.Pp0;
     if ( nav_data.Pp1 > max_pos_cov ) { max_pos_cov = nav_data.Pp1; }
@@ -100,27 +133,77 @@ static void umn2props(void) {
     if ( nav_data.Pa1 > max_att_cov ) { max_att_cov = nav_data.Pa1; }
     if ( nav_data.Pa2 > max_att_cov ) { max_att_cov = nav_data.Pa2; }
     if ( max_att_cov > 6.55 ) { max_vel_cov = 6.55; }
-    filter_node.setDouble( "max_pos_cov", max_pos_cov );
-    filter_node.setDouble( "max_vel_cov", max_vel_cov );
-    filter_node.setDouble( "max_att_cov", max_att_cov );
+    filter_out.max_pos_cov = max_pos_cov;
+    filter_out.max_vel_cov = max_vel_cov;
+    filter_out.max_att_cov = max_att_cov;
     
-    filter_node.setDouble( "altitude_ft",
-			   nav_data.alt * M2F );
-    filter_node.setDouble( "groundtrack_deg",
-			   90 - atan2(nav_data.vn, nav_data.ve) * R2D );
+    filter_out.altitude_ft = nav_data.alt * M2F;
+    filter_out.groundtrack_deg = 90 - atan2(nav_data.vn, nav_data.ve) * R2D;
     double gs_ms = sqrt(nav_data.vn * nav_data.vn + nav_data.ve * nav_data.ve);
-    filter_node.setDouble( "groundspeed_ms", gs_ms );
-    filter_node.setDouble( "groundspeed_kt", gs_ms * SG_MPS_TO_KT );
-    filter_node.setDouble( "vertical_speed_fps",
-			   -nav_data.vd * M2F );
+    filter_out.groundspeed_ms = gs_ms;
+    filter_out.groundspeed_kt = gs_ms * SG_MPS_TO_KT;
+    filter_out.vertical_speed_fps = -nav_data.vd * M2F;
+
+    filter_record.publish( filter_out );
 }
 
 
+// resolve the per-frame property handles
+static void bind_props() {
+    imu_props.time.bind( imu_node, "timestamp" );
+    imu_props.p.bind( imu_node, "p_rad_sec" );
+    imu_props.q.bind( imu_node, "q_rad_sec" );
+    imu_props.r.bind( imu_node, "r_rad_sec" );
+    imu_props.ax.bind( imu_node, "ax_mps_sec" );
+    imu_props.ay.bind( imu_node, "ay_mps_sec" );
+    imu_props.az.bind( imu_node, "az_mps_sec" );
+    imu_props.hx.bind( imu_node, "hx" );
+    imu_props.hy.bind( imu_node, "hy" );
+    imu_props.hz.bind( imu_node, "hz" );
+    gps_props.time.bind( gps_node, "timestamp" );
+    gps_props.lat.bind( gps_node, "latitude_deg" );
+    gps_props.lon.bind( gps_node, "longitude_deg" );
+    gps_props.alt.bind( gps_node, "altitude_m" );
+    gps_props.vn.bind( gps_node, "vn_ms" );
+    gps_props.ve.bind( gps_node, "ve_ms" );
+    gps_props.vd.bind( gps_node, "vd_ms" );
+    gps_props.data_age.bind( gps_node, "data_age" );
+    gps_props.settle.bind( gps_node, "settle" );
+    filter_record.bind( filter_node );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, timestamp );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, roll_deg );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, pitch_deg );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, heading_deg );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, latitude_deg );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, longitude_deg );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, altitude_m );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, vn_ms );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, ve_ms );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, vd_ms );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, p_bias );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, q_bias );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, r_bias );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, ax_bias );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, ay_bias );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, az_bias );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, max_pos_cov );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, max_vel_cov );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, max_att_cov );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, altitude_ft );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, groundtrack_deg );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, groundspeed_ms );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, groundspeed_kt );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, vertical_speed_fps );
+    PROP_RECORD_FIELD( filter_record, ekf15_out_t, status );
+    filter_record.expose( "record" );
+}
+
 void nav_ekf15_init( string output_path, pyPropertyNode *config ) {
     // initialize property nodes
     imu_node = pyGetNode("/sensors/imu", true);
     gps_node = pyGetNode("/sensors/gps", true);
     filter_node = pyGetNode(output_path, true);
+    bind_props();
     filter_node.setLong( "status", 0 );
 
 #if 0
@@ -136,11 +219,27 @@ void nav_ekf15_init( string output_path, pyPropertyNode *config ) {
     tau_f_node = config.getChild("tau-f", 0, true);
     tau_g_node = config.getChild("tau-g", 0, true);
 #endif
+
+    // optional block structured covariance propagation
+    filter.set_sparse_covariance( config->getBool("sparse_covariance") );
+
+    // optional sequential (scalar) measurement update
+    filter.set_sequential_update( config->getBool("sequential_update") );
+
+    // optional decimated covariance propagation (hz, 0 = imu rate)
+    filter.set_covariance_rate( config->getDouble("covariance_rate_hz") );
+
+    // optional delayed gps fusion (seconds from gps epoch to arrival)
+    filter.set_gps_delay( config->getDouble("gps_delay_sec") );
+
+    // optional multi-hypothesis heading initialization
+    heading_bank = config->getBool("heading_bank");
 }
 
 // trigger an ekf reset
 void nav_ekf15_reset() {
     nav_inited = false;
+    bank_active = false;
 }
 
 bool nav_ekf15_update() {
@@ -149,7 +248,22 @@ bool nav_ekf15_update() {
     // fill in the UMN structures
     props2umn();
 
-    if ( nav_inited ) {
+    if ( nav_inited && bank_active ) {
+        bank.time_update( imu_data );
+        if ( gps_data.time > last_gps_time ) {
+            last_gps_time = gps_data.time;
+            bank.measurement_update( gps_data );
+        }
+        int best = bank.best();
+        nav_data = bank.get_nav( best );
+        if ( bank.converged() ) {
+            printf("ekf15: heading hypothesis %d selected (p = %.3f)\n",
+                   best, bank.best_probability());
+            filter.init( imu_data, gps_data );
+            filter.set_state( nav_data, bank.get_covariance(best) );
+            bank_active = false;
+        }
+    } else if ( nav_inited ) {
 	filter.time_update( imu_data );
         if ( gps_data.time > last_gps_time ) {
             last_gps_time = gps_data.time;
@@ -157,9 +271,15 @@ bool nav_ekf15_update() {
         }
         nav_data = filter.get_nav();
     } else {
-	if ( gps_node.getDouble("data_age") < 1.0 && gps_node.getBool("settle") ) {
+	if ( gps_props.data_age.get() < 1.0 && gps_props.settle.get() ) {
 	    filter.init( imu_data, gps_data );
             nav_data = filter.get_nav();
+            if ( heading_bank ) {
+                bank.set_config( filter.get_config() );
+                bank.init( imu_data, gps_data );
+                nav_data = bank.get_nav( 0 );
+                bank_active = true;
+            }
 	    nav_inited = true;
 	}
     }
@@ -3,11 +3,22 @@
 
 #include "butter.h"
 
-ButterworthFilter::ButterworthFilter(int order, int samplerate, double cutoff)
+void butterworth_section( int order, int i, double samplerate,
+                          double cutoff, double *A, double *d1, double *d2 )
 {
-    n = order / 2;
+    int n = order / 2;
     double a = tan( M_PI * cutoff / samplerate );
     double a2 = a*a;
+    double r = sin(M_PI*(2.0*i+1.0)/(4.0*n));
+    double s = a2 + 2.0*a*r + 1.0;
+    *A = a2/s;
+    *d1 = 2.0*(1-a2)/s;
+    *d2 = -(a2 - 2.0*a*r + 1.0)/s;
+}
+
+ButterworthFilter::ButterworthFilter(int order, int samplerate, double cutoff)
+{
+    n = order / 2;
     A = new double[n];
     d1 = new double[n];
     d2 = new double[n];
@@ -17,11 +28,9 @@ ButterworthFilter::ButterworthFilter(int order, int samplerate, double cutoff)
 
     // generate coefficients
     for ( int i = 0; i < n; ++i ) {
-        double r = sin(M_PI*(2.0*i+1.0)/(4.0*n));
-        double s = a2 + 2.0*a*r + 1.0;
-        A[i] = a2/s;
-        d1[i] = 2.0*(1-a2)/s;
-        d2[i] = -(a2 - 2.0*a*r + 1.0)/s;
+        butterworth_section( order, i, samplerate, cutoff,
+                             &A[i], &d1[i], &d2[i] );
+        w0[i] = w1[i] = w2[i] = 0.0;
     }
 }
 
@@ -5,6 +5,12 @@
 
 #pragma once
 
+// coefficients of second order section i (0 .. order/2 - 1) of an
+// order 'order' low pass:
+//     w0 = d1*w1 + d2*w2 + x,  y = A*(w0 + 2*w1 + w2)
+void butterworth_section( int order, int i, double samplerate,
+                          double cutoff, double *A, double *d1, double *d2 );
+
 class ButterworthFilter {
     
 private:
@@ -0,0 +1,152 @@
+#include <math.h>
+
+#include "clock_sync.h"
+
+// gating (seconds): a sample later than the fit by more than
+// max(gate_sigmas * jitter, min_gate) is an outlier.  A counter that
+// steps backwards means the device was reset and the fit starts over.
+// A run of max_reject_run outliers also restarts the fit, but only
+// when the run agrees on a new offset (residuals within one gate
+// width of each other): a stall followed by a drained backlog gives
+// residuals that shrink sample by sample and must not be fit.
+static const double gate_sigmas = 4.0;
+static const double min_gate = 0.002;
+static const double max_early = 0.5;
+static const int max_reject_run = 25;
+
+// the drift term is only fit once the samples span this much remote
+// time (shorter spans make the slope mostly jitter)
+static const double min_drift_span = 5.0;
+static const double max_drift = 1e-3;
+
+double clock_sync_t::unwrap( uint32_t remote_ticks ) {
+    if ( !have_ticks ) {
+        have_ticks = true;
+        ext_ticks = remote_ticks;
+    } else {
+        ext_ticks += (int32_t)(remote_ticks - last_ticks);
+    }
+    last_ticks = remote_ticks;
+    return ext_ticks / ticks_per_sec;
+}
+
+double clock_sync_t::local_time( uint32_t remote_ticks ) {
+    int64_t ticks = ext_ticks + (int32_t)(remote_ticks - last_ticks);
+    double remote = ticks / ticks_per_sec;
+    return remote + a0 + a1 * (remote - origin);
+}
+
+void clock_sync_t::restart() {
+    have_ticks = false;
+    origin = 0.0;
+    last_x = 0.0;
+    sw = sx = sy = sxx = sxy = 0.0;
+    a0 = a1 = 0.0;
+    sigma = 0.0;
+    samples = 0;
+    reject_run = 0;
+}
+
+void clock_sync_t::reset() {
+    restart();
+    last_residual = 0.0;
+    outliers = 0;
+    resyncs = 0;
+}
+
+void clock_sync_t::add( double x, double y ) {
+    // forget old samples with the remote time elapsed since the last
+    // one
+    double dx = x - last_x;
+    if ( dx > 0.0 ) {
+        double decay = exp( -dx / tau );
+        sw *= decay;
+        sx *= decay;
+        sy *= decay;
+        sxx *= decay;
+        sxy *= decay;
+    }
+    last_x = x;
+    sw += 1.0;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+
+    double mean_x = sx / sw;
+    double var_x = sxx / sw - mean_x * mean_x;
+    if ( var_x > min_drift_span * min_drift_span ) {
+        a1 = (sxy / sw - mean_x * sy / sw) / var_x;
+        if ( a1 > max_drift ) { a1 = max_drift; }
+        if ( a1 < -max_drift ) { a1 = -max_drift; }
+    }
+    a0 = (sy - a1 * sx) / sw;
+}
+
+double clock_sync_t::update( uint32_t remote_ticks, double host_time ) {
+    if ( have_ticks && (int32_t)(remote_ticks - last_ticks) < 0 ) {
+        // counter went backwards: the device restarted
+        restart();
+        resyncs++;
+    }
+    double remote = unwrap( remote_ticks );
+    if ( samples == 0 ) {
+        origin = remote;
+        last_x = 0.0;
+    }
+
+    // keep x small (the sums are shifted exactly)
+    if ( remote - origin > 10 * tau ) {
+        double d = remote - origin;
+        sxx += -2.0 * d * sx + d * d * sw;
+        sxy += -d * sy;
+        sx += -d * sw;
+        a0 += a1 * d;
+        last_x -= d;
+        origin = remote;
+    }
+
+    double x = remote - origin;
+    double y = host_time - remote;
+    double e = y - (a0 + a1 * x);
+    if ( samples >= 2 ) {
+        double gate = gate_sigmas * sigma;
+        if ( gate < min_gate ) {
+            gate = min_gate;
+        }
+        if ( e > gate || e < -max_early ) {
+            outliers++;
+            double lo = e < run_min ? e : run_min;
+            double hi = e > run_max ? e : run_max;
+            if ( reject_run == 0 || hi - lo > gate ) {
+                // not (or no longer) a consistent offset, start the
+                // run over from this sample
+                reject_run = 0;
+                lo = hi = e;
+            }
+            run_min = lo;
+            run_max = hi;
+            reject_run++;
+            if ( reject_run <= max_reject_run ) {
+                return remote + a0 + a1 * x;
+            }
+            // the fit no longer describes the clocks, start over
+            // from this sample
+            restart();
+            resyncs++;
+            remote = unwrap( remote_ticks );
+            origin = remote;
+            x = 0.0;
+            y = host_time - remote;
+            e = 0.0;
+        }
+    }
+    reject_run = 0;
+    last_residual = e;
+    if ( samples > 0 ) {
+        sigma = sqrt( 0.99 * sigma * sigma + 0.01 * e * e );
+    }
+    add( x, y );
+    samples++;
+    return remote + a0 + a1 * x;
+}
@@ -0,0 +1,86 @@
+// clock_sync.h - map a remote (device) counter onto the host clock
+//
+// Each sample pairs the device's free running counter (e.g. the FMU
+// millis() stamp in an imu packet) with the host time the packet was
+// received.  The host time is the device time plus a slowly drifting
+// offset plus a transport delay that is always positive and sometimes
+// large (scheduling hiccups, a backlog drained in one read.)  The
+// filter fits
+//
+//     host = remote + offset + drift * (remote - origin)
+//
+// by least squares with exponential forgetting over remote time (so
+// the sample rate may vary), gating out samples that arrive late
+// relative to the fit.  local_time() then gives a smooth host time
+// for any device stamp.
+//
+// The 32 bit counter is unwrapped, so rollover is seamless.  A counter
+// that steps backwards (device reset), or a run of late samples that
+// agree on a new offset (host clock step), restarts the fit and is
+// counted in resyncs.  A transport stall only produces outliers.
+
+#pragma once
+
+#include <stdint.h>
+
+class clock_sync_t {
+
+public:
+
+    // ticks_per_sec: device counter rate, tau: fit memory (remote
+    // seconds)
+    clock_sync_t( double ticks_per_sec = 1000.0, double tau = 200.0 ):
+        ticks_per_sec(ticks_per_sec), tau(tau) {}
+
+    // add a sample, returns the smoothed host time for it
+    double update( uint32_t remote_ticks, double host_time );
+
+    // smoothed host time for a device stamp
+    double local_time( uint32_t remote_ticks );
+
+    // sync quality
+    bool synced() { return samples >= min_samples; }
+    double get_offset() { return a0 + a1 * last_x; } // host - remote (sec)
+    double get_drift_ppm() { return a1 * 1e6; }
+    double get_jitter() { return sigma; }       // rms residual (sec)
+    double get_residual() { return last_residual; } // last sample (sec)
+    uint32_t get_samples() { return samples; }
+    uint32_t get_outliers() { return outliers; }
+    uint32_t get_resyncs() { return resyncs; }
+
+    void reset();
+
+private:
+
+    double ticks_per_sec;
+    double tau;
+
+    // counter unwrapping
+    bool have_ticks = false;
+    uint32_t last_ticks = 0;
+    int64_t ext_ticks = 0;      // unwrapped counter
+
+    // weighted sums over x = remote sec - origin, y = host - remote
+    double origin = 0.0;
+    double last_x = 0.0;
+    double sw = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+
+    // the fit: y = a0 + a1 * x
+    double a0 = 0.0;
+    double a1 = 0.0;
+
+    double sigma = 0.0;
+    double last_residual = 0.0;
+    uint32_t samples = 0;
+    uint32_t outliers = 0;
+    uint32_t resyncs = 0;
+    int reject_run = 0;
+    double run_min = 0.0;       // residual range of the rejected run
+    double run_max = 0.0;
+
+    static const uint32_t min_samples = 50;
+
+    double unwrap( uint32_t remote_ticks );
+    void restart();
+    void add( double x, double y );
+};
@@ -0,0 +1,121 @@
+// clock_sync_test.cpp - feed clock_sync_t a simulated 100hz device
+// stream with transport delay and check the fit through drift,
+// counter rollover, device reset, a stall, and a host clock step
+
+#include <math.h>
+#include <stdio.h>
+
+#include "clock_sync.h"
+#include "test_check.h"
+
+// repeatable transport delay: mostly 0.5-1.5 ms, now and then a 20 ms
+// scheduling hiccup
+static unsigned int seed = 12345;
+static double delay() {
+    seed = seed * 1103515245 + 12345;
+    double u = ((seed >> 8) & 0xffff) / 65536.0;
+    if ( u > 0.995 ) {
+        return 0.020;
+    }
+    return 0.0005 + 0.001 * u;
+}
+static const double mean_delay = 0.001;
+
+// device at 1000 ticks/sec, sampled every 10 ms; the host clock runs
+// drift fast relative to it
+struct sim_t {
+    uint32_t ticks;
+    double offset;              // host - device at the start
+    double drift;
+    double elapsed = 0.0;       // device seconds since the start
+    sim_t( uint32_t ticks, double offset, double drift ):
+        ticks(ticks), offset(offset), drift(drift) {}
+    double host() { return elapsed * (1.0 + drift) + offset; }
+    void step() { ticks += 10; elapsed += 0.010; }
+};
+
+// worst error of local_time() against the true receive time less the
+// mean delay over the next n samples
+static double run( clock_sync_t &cs, sim_t &sim, int n ) {
+    double worst = 0.0;
+    for ( int i = 0; i < n; i++ ) {
+        sim.step();
+        cs.update( sim.ticks, sim.host() + delay() );
+        double err = fabs( cs.local_time( sim.ticks ) - (sim.host() + mean_delay) );
+        if ( err > worst ) {
+            worst = err;
+        }
+    }
+    return worst;
+}
+
+int main() {
+    // drift
+    {
+        clock_sync_t cs;
+        sim_t sim( 5000, 100.0, 50e-6 );
+        run( cs, sim, 6000 );
+        double err = run( cs, sim, 60000 );
+        check( cs.synced() && err < 0.0005, "tracks a 50 ppm drift" );
+        check( fabs( cs.get_drift_ppm() - 50.0 ) < 5.0, "drift estimate" );
+        check( cs.get_resyncs() == 0, "no resyncs" );
+        check( cs.get_outliers() > 0, "hiccups gated out" );
+    }
+
+    // counter rollover
+    {
+        clock_sync_t cs;
+        sim_t sim( 0xffffffffu - 60000, 100.0, 20e-6 );
+        run( cs, sim, 3000 );
+        double before = cs.local_time( sim.ticks );
+        sim.step();
+        cs.update( sim.ticks, sim.host() + delay() );
+        double step = cs.local_time( sim.ticks ) - before;
+        double err = run( cs, sim, 6000 );   // crosses the wrap
+        check( sim.ticks < 60000, "counter wrapped" );
+        check( fabs( step - 0.010 ) < 0.0005 && err < 0.0005,
+               "seamless across the wrap" );
+        check( cs.get_resyncs() == 0, "wrap is not a resync" );
+    }
+
+    // device reset: the counter starts over with a new offset
+    {
+        clock_sync_t cs;
+        sim_t sim( 5000000, 100.0, 0.0 );
+        run( cs, sim, 3000 );
+        sim_t reset( 0, sim.host(), 0.0 );
+        run( cs, reset, 100 );
+        double err = run( cs, reset, 3000 );
+        check( cs.get_resyncs() == 1, "reset restarts the fit" );
+        check( err < 0.0005, "tracks the restarted device" );
+    }
+
+    // stall: 0.4 s of packets arrive together, then normal again
+    {
+        clock_sync_t cs;
+        sim_t sim( 5000, 100.0, 0.0 );
+        run( cs, sim, 3000 );
+        double stall_end = sim.host() + 0.4;
+        for ( int i = 0; i < 40; i++ ) {
+            sim.step();
+            cs.update( sim.ticks, stall_end + 0.00002 * i );
+        }
+        double err = run( cs, sim, 1000 );
+        check( cs.get_resyncs() == 0, "stall does not restart the fit" );
+        check( err < 0.0005, "fit unchanged by the stall" );
+    }
+
+    // host clock step: every later sample agrees on a new offset
+    {
+        clock_sync_t cs;
+        sim_t sim( 5000, 100.0, 0.0 );
+        run( cs, sim, 3000 );
+        sim.offset += 0.5;
+        run( cs, sim, 200 );
+        double err = run( cs, sim, 3000 );
+        check( cs.get_resyncs() == 1, "offset step restarts the fit" );
+        check( err < 0.0005, "tracks the new offset" );
+    }
+
+    return check_summary();
+}
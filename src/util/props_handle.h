@@ -0,0 +1,265 @@
+// props_handle.h - bind-once typed handles to a single property value
+//
+// A pyPropertyNode get/set call converts the attribute name to a
+// python string (through a std::string keyed cache), checks for the
+// attribute, and then runs the full python attribute lookup.  In the
+// main loop the same (node, attribute) pairs are visited every frame,
+// so a handle resolves the pair once at init time: it holds the
+// node's attribute dictionary and an interned key whose hash python
+// caches.  A read is then a single borrowed dictionary probe and a
+// write stores straight into the same dictionary, so the value stays
+// visible (and writable) from python.
+//
+// The fast path assumes the plain attribute storage used by the
+// property tree.  If the node has no __dict__, overrides attribute
+// assignment, or holds a value of an unexpected type (e.g. a string
+// from a config file), the handle falls back to the pyPropertyNode
+// accessors so results are always identical to the string keyed
+// calls.  An unbound handle reads as 0 and ignores writes (like a
+// null pyPropertyNode.)  As with pyPropertyNode, the caller must hold
+// the GIL.
+//
+// An optional property that was never set (e.g. a component's debug
+// flag) is missing from the dictionary.  Once a full attribute lookup
+// confirms it is missing, reads return the default without the slow
+// path; the dictionary probe still sees the value as soon as it is
+// stored, and the full lookup is repeated every recheck_reads reads
+// in case it appears some other way (a class attribute, a property.)
+
+#pragma once
+
+#include <pyprops.h>
+
+#include <string>
+using std::string;
+
+template <class T>
+class prop_handle_t {
+
+public:
+
+    prop_handle_t() {}
+    prop_handle_t( const prop_handle_t &h ) {
+        copy( h );
+    }
+    ~prop_handle_t() {
+        release();
+    }
+    prop_handle_t & operator= ( const prop_handle_t &h ) {
+        if ( this != &h ) {
+            release();
+            copy( h );
+        }
+        return *this;
+    }
+
+    // bind to attribute 'name' of an existing node
+    bool bind( pyPropertyNode &n, const char *name ) {
+        release();
+        this->name = name;
+        if ( n.isNull() ) {
+            return false;
+        }
+        obj = n.pObj;
+        Py_INCREF(obj);
+        key = PyUnicode_InternFromString( name );
+        if ( Py_TYPE(obj)->tp_setattro == PyObject_GenericSetAttr ) {
+            dict = PyObject_GetAttrString( obj, "__dict__" );
+            if ( dict == NULL ) {
+                PyErr_Clear();
+            } else if ( !PyDict_Check(dict) ) {
+                Py_DECREF(dict);
+                dict = NULL;
+            }
+        }
+        return true;
+    }
+
+    // bind to "/path/to/node/attr" (the node is created if needed),
+    // returns false if prop is not a path
+    bool bind( const string &prop ) {
+        size_t pos = prop.rfind("/");
+        if ( pos == string::npos ) {
+            release();
+            return false;
+        }
+        pyPropertyNode n = pyGetNode( prop.substr(0, pos), true );
+        return bind( n, prop.substr(pos+1).c_str() );
+    }
+
+    bool isNull() { return obj == NULL; }
+    const char *get_name() { return name.c_str(); }
+
+    // bound to the same attribute of the same node (as any type)
+    template <class U>
+    bool same( const prop_handle_t<U> &h ) const {
+        return obj != NULL && obj == h.obj && name == h.name;
+    }
+
+    T get();
+    void set( T val );
+    // element 'index' of a list valued attribute (only double)
+    T get( int index );
+
+private:
+
+    template <class U> friend class prop_handle_t;
+
+    PyObject *obj = NULL;       // the property node
+    string name;
+    PyObject *dict = NULL;      // node.__dict__ (NULL = slow path)
+    PyObject *key = NULL;       // interned attribute name
+
+    // the slow path (pyPropertyNode(PyObject *) steals a reference),
+    // only valid when bound
+    pyPropertyNode node() {
+        Py_INCREF(obj);
+        return pyPropertyNode(obj);
+    }
+
+    // borrowed reference to the current value or NULL
+    PyObject *lookup() {
+        return dict ? PyDict_GetItem( dict, key ) : NULL;
+    }
+    void store( PyObject *val ) {
+        PyDict_SetItem( dict, key, val );
+        Py_DECREF(val);
+    }
+
+    // attribute confirmed missing (only called when the dictionary
+    // probe found nothing)
+    static const int recheck_reads = 256;
+    int absent_reads = 0;
+    bool absent() {
+        if ( dict == NULL ) {
+            return false;
+        }
+        if ( absent_reads > 0 ) {
+            absent_reads--;
+            return true;
+        }
+        if ( PyObject_HasAttr( obj, key ) ) {
+            return false;
+        }
+        absent_reads = recheck_reads;
+        return true;
+    }
+
+    void copy( const prop_handle_t &h ) {
+        absent_reads = 0;
+        obj = h.obj;
+        name = h.name;
+        dict = h.dict;
+        key = h.key;
+        Py_XINCREF(obj);
+        Py_XINCREF(dict);
+        Py_XINCREF(key);
+    }
+    void release() {
+        absent_reads = 0;
+        Py_XDECREF(obj);
+        Py_XDECREF(dict);
+        Py_XDECREF(key);
+        obj = NULL;
+        dict = NULL;
+        key = NULL;
+    }
+};
+
+template <> inline double prop_handle_t<double>::get() {
+    PyObject *val = lookup();
+    if ( val != NULL && PyFloat_CheckExact(val) ) {
+        return PyFloat_AS_DOUBLE(val);
+    } else if ( val != NULL && PyLong_CheckExact(val) ) {
+        return PyLong_AsLong(val);
+    } else if ( obj == NULL || (val == NULL && absent()) ) {
+        return 0.0;
+    }
+    return node().getDouble( name.c_str() );
+}
+
+template <> inline double prop_handle_t<double>::get( int index ) {
+    PyObject *list = lookup();
+    if ( list != NULL && PyList_CheckExact(list) && index >= 0
+         && index < PyList_GET_SIZE(list) ) {
+        PyObject *val = PyList_GET_ITEM(list, index);
+        if ( PyFloat_CheckExact(val) ) {
+            return PyFloat_AS_DOUBLE(val);
+        } else if ( PyLong_CheckExact(val) ) {
+            return PyLong_AsLong(val);
+        }
+    } else if ( obj == NULL || (list == NULL && absent()) ) {
+        return 0.0;
+    }
+    return node().getDouble( name.c_str(), index );
+}
+
+template <> inline void prop_handle_t<double>::set( double v ) {
+    if ( dict == NULL ) {
+        if ( obj != NULL ) {
+            node().setDouble( name.c_str(), v );
+        }
+        return;
+    }
+    PyObject *val = lookup();
+    if ( val != NULL && PyFloat_CheckExact(val) && PyFloat_AS_DOUBLE(val) == v ) {
+        return;                 // unchanged, skip the allocation
+    }
+    store( PyFloat_FromDouble(v) );
+}
+
+template <> inline long prop_handle_t<long>::get() {
+    PyObject *val = lookup();
+    if ( val != NULL && PyLong_CheckExact(val) ) {
+        return PyLong_AsLong(val);
+    } else if ( val != NULL && PyFloat_CheckExact(val) ) {
+        return (long)PyFloat_AS_DOUBLE(val);
+    } else if ( obj == NULL || (val == NULL && absent()) ) {
+        return 0;
+    }
+    return node().getLong( name.c_str() );
+}
+
+template <> inline void prop_handle_t<long>::set( long v ) {
+    if ( dict == NULL ) {
+        if ( obj != NULL ) {
+            node().setLong( name.c_str(), v );
+        }
+        return;
+    }
+    PyObject *val = lookup();
+    if ( val != NULL && PyLong_CheckExact(val) && PyLong_AsLong(val) == v ) {
+        return;
+    }
+    store( PyLong_FromLong(v) );
+}
+
+template <> inline bool prop_handle_t<bool>::get() {
+    PyObject *val = lookup();
+    if ( val == Py_True ) {
+        return true;
+    } else if ( val == Py_False ) {
+        return false;
+    } else if ( obj == NULL || (val == NULL && absent()) ) {
+        return false;
+    }
+    return node().getBool( name.c_str() );
+}
+
+template <> inline void prop_handle_t<bool>::set( bool v ) {
+    if ( dict == NULL ) {
+        if ( obj != NULL ) {
+            node().setBool( name.c_str(), v );
+        }
+        return;
+    }
+    PyObject *val = v ? Py_True : Py_False;
+    if ( lookup() != val ) {
+        Py_INCREF(val);
+        store( val );
+    }
+}
+
+typedef prop_handle_t<double> prop_double_t;
+typedef prop_handle_t<long> prop_long_t;
+typedef prop_handle_t<bool> prop_bool_t;
@@ -0,0 +1,76 @@
+// props_handle_test.cpp - check the bound handles against the string
+// keyed pyPropertyNode calls (build against libpyprops, embeds python)
+
+#include <stdio.h>
+
+#include <pyprops.h>
+
+#include "props_handle.h"
+#include "test_check.h"
+
+int main() {
+    Py_Initialize();
+    pyPropsInit();
+
+    pyPropertyNode n = pyGetNode( "/test/handles", true );
+    n.setDouble( "x", 1.5 );
+    n.setLong( "count", 7 );
+    n.setString( "text", "2.25" );
+
+    prop_double_t x, text, missing;
+    prop_long_t count;
+    prop_bool_t debug;
+    x.bind( n, "x" );
+    text.bind( n, "text" );
+    missing.bind( n, "missing" );
+    count.bind( n, "count" );
+    debug.bind( "/test/handles/debug" );
+
+    check( x.get() == n.getDouble("x"), "double read" );
+    check( text.get() == n.getDouble("text"), "string value (slow path)" );
+    check( count.get() == 7, "long read" );
+
+    x.set( 3.0 );
+    check( n.getDouble("x") == 3.0, "double write visible to the node" );
+
+    // optional properties that were never set read as the default,
+    // and are seen as soon as they are stored
+    bool ok = true;
+    for ( int i = 0; i < 1000; i++ ) {
+        if ( missing.get() != 0.0 || debug.get() ) {
+            ok = false;
+        }
+    }
+    check( ok, "missing properties read as 0/false" );
+    n.setDouble( "missing", 2.5 );
+    n.setBool( "debug", true );
+    check( missing.get() == 2.5, "missing double seen once set" );
+    check( debug.get(), "missing bool seen once set" );
+
+    // an attribute that appears outside the node's dictionary is
+    // picked up by the periodic recheck
+    prop_double_t cls;
+    cls.bind( n, "class_value" );
+    cls.get();
+    PyRun_SimpleString( "import props\n"
+                        "type(props.getNode('/test/handles')).class_value = 7.0\n" );
+    int reads = 0;
+    while ( cls.get() != 7.0 && reads < 1000 ) {
+        reads++;
+    }
+    check( reads <= 256, "class attribute seen within the recheck interval" );
+
+    // list elements
+    prop_double_t channel;
+    channel.bind( n, "channel" );
+    check( channel.get( 2 ) == 0.0, "missing list reads 0" );
+    n.setLen( "channel", 8, 0.0 );
+    n.setDouble( "channel", 2, 0.5 );
+    check( channel.get( 2 ) == 0.5 && channel.get( 8 ) == 0.0,
+           "list element read" );
+
+    prop_double_t unbound;
+    check( unbound.isNull() && unbound.get() == 0.0, "unbound handle reads 0" );
+
+    return check_summary();
+}
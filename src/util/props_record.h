@@ -0,0 +1,250 @@
+// props_record.h - publish a plain C++ struct to a property node
+//
+// A field table maps struct members to attributes of one property
+// node.  The table is built once at init time (interning every
+// attribute name), and publish() then stores the whole struct with
+// one call: each field is converted and written straight into the
+// node's attribute dictionary, skipping fields whose published value
+// has not changed.
+//
+// The record also keeps a copy of the last published struct.
+// expose() makes that copy visible to python as a read-only
+// memoryview (no copy) along with a struct module format string and
+// the field names, so a consumer can take the whole record at once:
+//
+//   values = struct.unpack(node.record_format, node.record)
+//
+// Field names are used as-is for the attribute names, so a struct
+// intended for publishing should carry its values in the published
+// units.  Supported member types are double, float, long, int,
+// uint32_t, and bool.  As with pyPropertyNode, the caller must hold
+// the GIL.
+
+#pragma once
+
+#include <pyprops.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// add a member whose attribute name matches the member name
+#define PROP_RECORD_FIELD(rec, S, member) (rec).add( #member, &S::member )
+
+class prop_record_t {
+
+public:
+
+    prop_record_t() {}
+    ~prop_record_t() {
+        for ( unsigned int i = 0; i < fields.size(); i++ ) {
+            Py_XDECREF(fields[i].key);
+        }
+        Py_XDECREF(obj);
+        Py_XDECREF(dict);
+    }
+
+    // exposed memory belongs to the record, so it can't be copied
+    prop_record_t( const prop_record_t & ) = delete;
+    prop_record_t & operator= ( const prop_record_t & ) = delete;
+
+    // the node that receives the record
+    bool bind( pyPropertyNode &n ) {
+        if ( n.isNull() ) {
+            return false;
+        }
+        Py_XDECREF(obj);
+        Py_XDECREF(dict);
+        obj = n.pObj;
+        Py_INCREF(obj);
+        dict = NULL;
+        if ( Py_TYPE(obj)->tp_setattro == PyObject_GenericSetAttr ) {
+            dict = PyObject_GetAttrString( obj, "__dict__" );
+            if ( dict == NULL ) {
+                PyErr_Clear();
+            } else if ( !PyDict_Check(dict) ) {
+                Py_DECREF(dict);
+                dict = NULL;
+            }
+        }
+        return true;
+    }
+
+    // add struct member 'member' as attribute 'name'
+    template <class S, class F>
+    void add( const char *name, F S::*member ) {
+        if ( exposed ) {
+            printf("WARNING: prop_record_t: field %s added after expose()\n",
+                   name);
+            return;
+        }
+        if ( buf.size() == 0 ) {
+            buf.resize( sizeof(S), 0 );
+        } else if ( buf.size() != sizeof(S) ) {
+            printf("WARNING: prop_record_t: field %s from another struct\n",
+                   name);
+            return;
+        }
+        // member offset without needing an instance of S
+        alignas(S) static char probe[sizeof(S)];
+        const S *s = reinterpret_cast<const S *>(probe);
+        field_t f;
+        f.name = name;
+        f.key = PyUnicode_InternFromString( name );
+        f.offset = (const char *)&(s->*member) - probe;
+        f.size = sizeof(F);
+        f.type = type_of( (F *)NULL );
+        fields.push_back( f );
+    }
+
+    // expose the last published record to python as node.<name> (a
+    // read-only memoryview), node.<name>_format, and node.<name>_fields
+    bool expose( const char *name ) {
+        if ( obj == NULL || buf.size() == 0 ) {
+            return false;
+        }
+        vector<field_t> sorted = fields;
+        std::sort( sorted.begin(), sorted.end(),
+                   []( const field_t &a, const field_t &b ) {
+                       return a.offset < b.offset;
+                   } );
+        string format = "=";
+        PyObject *names = PyList_New( 0 );
+        size_t pos = 0;
+        for ( unsigned int i = 0; i < sorted.size(); i++ ) {
+            if ( sorted[i].offset > pos ) {
+                format += std::to_string( sorted[i].offset - pos ) + "x";
+            }
+            format += format_char( sorted[i] );
+            pos = sorted[i].offset + sorted[i].size;
+            PyObject *n = PyUnicode_FromString( sorted[i].name.c_str() );
+            PyList_Append( names, n );
+            Py_DECREF(n);
+        }
+        if ( buf.size() > pos ) {
+            format += std::to_string( buf.size() - pos ) + "x";
+        }
+        PyObject *view = PyMemoryView_FromMemory( (char *)buf.data(),
+                                                  buf.size(), PyBUF_READ );
+        PyObject *fmt = PyUnicode_FromString( format.c_str() );
+        string base = name;
+        PyObject_SetAttrString( obj, base.c_str(), view );
+        PyObject_SetAttrString( obj, (base + "_format").c_str(), fmt );
+        PyObject_SetAttrString( obj, (base + "_fields").c_str(), names );
+        Py_DECREF(view);
+        Py_DECREF(fmt);
+        Py_DECREF(names);
+        exposed = true;
+        return true;
+    }
+
+    // write all fields of rec to the node
+    template <class S>
+    void publish( const S &rec ) {
+        if ( obj == NULL || sizeof(S) != buf.size() ) {
+            return;
+        }
+        const char *p = (const char *)&rec;
+        for ( unsigned int i = 0; i < fields.size(); i++ ) {
+            store( fields[i], p + fields[i].offset );
+        }
+        memcpy( buf.data(), p, sizeof(S) );
+    }
+
+private:
+
+    enum field_type {
+        FIELD_DOUBLE, FIELD_FLOAT, FIELD_LONG, FIELD_INT, FIELD_UINT,
+        FIELD_BOOL
+    };
+    struct field_t {
+        string name;
+        PyObject *key;          // interned attribute name
+        size_t offset;
+        size_t size;
+        field_type type;
+    };
+
+    static field_type type_of( double * ) { return FIELD_DOUBLE; }
+    static field_type type_of( float * ) { return FIELD_FLOAT; }
+    static field_type type_of( long * ) { return FIELD_LONG; }
+    static field_type type_of( int * ) { return FIELD_INT; }
+    static field_type type_of( uint32_t * ) { return FIELD_UINT; }
+    static field_type type_of( bool * ) { return FIELD_BOOL; }
+
+    static string format_char( const field_t &f ) {
+        switch ( f.type ) {
+        case FIELD_DOUBLE: return "d";
+        case FIELD_FLOAT: return "f";
+        case FIELD_LONG: return sizeof(long) == 8 ? "q" : "l";
+        case FIELD_INT: return "i";
+        case FIELD_UINT: return "I";
+        case FIELD_BOOL: return "?";
+        }
+        return "x";
+    }
+
+    void store( const field_t &f, const char *p ) {
+        PyObject *cur = dict ? PyDict_GetItem( dict, f.key ) : NULL;
+        PyObject *val = NULL;
+        if ( f.type == FIELD_DOUBLE || f.type == FIELD_FLOAT ) {
+            double v;
+            if ( f.type == FIELD_DOUBLE ) {
+                memcpy( &v, p, sizeof(double) );
+            } else {
+                float fv;
+                memcpy( &fv, p, sizeof(float) );
+                v = fv;
+            }
+            if ( cur != NULL && PyFloat_CheckExact(cur)
+                 && PyFloat_AS_DOUBLE(cur) == v ) {
+                return;
+            }
+            val = PyFloat_FromDouble( v );
+        } else if ( f.type == FIELD_BOOL ) {
+            bool v;
+            memcpy( &v, p, sizeof(bool) );
+            val = v ? Py_True : Py_False;
+            if ( cur == val ) {
+                return;
+            }
+            Py_INCREF(val);
+        } else {
+            long v;
+            if ( f.type == FIELD_LONG ) {
+                memcpy( &v, p, sizeof(long) );
+            } else if ( f.type == FIELD_INT ) {
+                int iv;
+                memcpy( &iv, p, sizeof(int) );
+                v = iv;
+            } else {
+                uint32_t uv;
+                memcpy( &uv, p, sizeof(uint32_t) );
+                v = uv;
+            }
+            if ( cur != NULL && PyLong_CheckExact(cur)
+                 && PyLong_AsLong(cur) == v ) {
+                return;
+            }
+            val = PyLong_FromLong( v );
+        }
+        if ( dict != NULL ) {
+            PyDict_SetItem( dict, f.key, val );
+        } else {
+            PyObject_SetAttr( obj, f.key, val );
+        }
+        Py_DECREF(val);
+    }
+
+    PyObject *obj = NULL;       // the property node
+    PyObject *dict = NULL;      // node.__dict__ (NULL = setattr)
+    vector<field_t> fields;
+    vector<char> buf;           // last published record
+    bool exposed = false;
+};
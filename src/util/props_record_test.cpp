@@ -0,0 +1,74 @@
+// props_record_test.cpp - publish a struct and read it back through
+// the node attributes and the exposed memoryview (build against
+// libpyprops, embeds python)
+
+#include <stdio.h>
+
+#include <pyprops.h>
+
+#include "props_record.h"
+#include "test_check.h"
+
+struct sample_t {
+    double timestamp;
+    float roll_deg;
+    bool valid;
+    int count;
+    uint32_t millis;
+    long status;
+};
+
+int main() {
+    Py_Initialize();
+    pyPropsInit();
+
+    pyPropertyNode n = pyGetNode( "/test/record", true );
+    prop_record_t rec;
+    rec.bind( n );
+    PROP_RECORD_FIELD( rec, sample_t, timestamp );
+    PROP_RECORD_FIELD( rec, sample_t, roll_deg );
+    PROP_RECORD_FIELD( rec, sample_t, valid );
+    PROP_RECORD_FIELD( rec, sample_t, count );
+    PROP_RECORD_FIELD( rec, sample_t, millis );
+    PROP_RECORD_FIELD( rec, sample_t, status );
+    check( rec.expose( "record" ), "expose" );
+
+    sample_t s;
+    s.timestamp = 12.5;
+    s.roll_deg = -3.25f;
+    s.valid = true;
+    s.count = -7;
+    s.millis = 4000000000u;
+    s.status = 2;
+    rec.publish( s );
+
+    check( n.getDouble("timestamp") == 12.5, "double field" );
+    check( n.getDouble("roll_deg") == -3.25, "float field" );
+    check( n.getBool("valid"), "bool field" );
+    check( n.getLong("count") == -7, "int field" );
+    check( n.getLong("millis") == 4000000000L, "uint32 field" );
+    check( n.getLong("status") == 2, "long field" );
+
+    // the memoryview holds the same record
+    int r = PyRun_SimpleString(
+        "import props, struct\n"
+        "n = props.getNode('/test/record')\n"
+        "v = dict(zip(n.record_fields, struct.unpack(n.record_format, n.record)))\n"
+        "assert v['timestamp'] == 12.5 and v['roll_deg'] == -3.25\n"
+        "assert v['valid'] is True and v['count'] == -7\n"
+        "assert v['millis'] == 4000000000 and v['status'] == 2\n"
+        "assert n.record.readonly\n" );
+    check( r == 0, "memoryview unpacks to the published values" );
+
+    // unchanged values are not rewritten, changed ones are
+    PyRun_SimpleString( "import props\n"
+                        "n = props.getNode('/test/record')\n"
+                        "saved = n.timestamp\n" );
+    s.roll_deg = 1.0f;
+    rec.publish( s );
+    r = PyRun_SimpleString( "assert n.timestamp is saved\n"
+                            "assert n.roll_deg == 1.0\n" );
+    check( r == 0, "only changed fields are stored" );
+
+    return check_summary();
+}
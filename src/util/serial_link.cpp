@@ -1,11 +1,14 @@
 #include <errno.h>		// errno
 #include <fcntl.h>		// open()
+#include <poll.h>		// poll()
 #include <stdio.h>		// printf() et. al.
 #include <termios.h>		// tcgetattr() et. al.
 #include <unistd.h>		// tcgetattr() et. al.
 #include <string.h>		// memset(), strerror()
 #include <sys/ioctl.h>          // FIONREAD
 
+#include "timing.h"
+
 #include "serial_link.h"
 
 SerialLink::SerialLink() {
@@ -46,6 +49,9 @@ void SerialLink::checksum( uint8_t hdr1, uint8_t hdr2, uint8_t *buf, uint8_t siz
 }
 
 bool SerialLink::open( int baud, const char *device_name ) {
+    rx_head = rx_tail = 0;
+    state = 0;
+
     // fd = open( device_name.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK );
     fd = ::open( device_name, O_RDWR | O_NOCTTY );
     if ( fd < 0 ) {
@@ -86,154 +92,177 @@ bool SerialLink::open( int baud, const char *device_name ) {
     return true;
 }
 
-bool SerialLink::update() {
-    int len;
-    uint8_t input[2];
-    int giveup_counter = 0;
-
-    // printf("update() entry state = %d\n", state);
-
-    bool new_data = false;
-
-    if ( state == 0 ) {
-        counter = 0;
-        len = read( fd, input, 1 );
-        giveup_counter = 0;
-        while ( len > 0 && input[0] != START_OF_MSG0 && giveup_counter < 100 ) {
-            // printf("state0: len = %d val = %2X (%c)\n", len, input[0] , input[0]);
-            len = read( fd, input, 1 );
-            giveup_counter++;
-            // fprintf( stderr, "giveup_counter = %d\n", giveup_counter);
-        }
-        if ( len > 0 && input[0] == START_OF_MSG0 ) {
-            // fprintf( stderr, "read START_OF_MSG0\n");
-            state++;
-        }
+// read whatever is available into the ring buffer (blocks until at
+// least one byte arrives, VMIN = 1)
+bool SerialLink::fill() {
+    uint32_t space = RX_BUF_SIZE - rx_count();
+    if ( space == 0 ) {
+        return false;
+    }
+    // contiguous free region starting at the tail
+    uint32_t pos = rx_tail & (RX_BUF_SIZE - 1);
+    if ( space > RX_BUF_SIZE - pos ) {
+        space = RX_BUF_SIZE - pos;
+    }
+    int len = read( fd, rx_buf + pos, space );
+    if ( len <= 0 ) {
+        return false;
     }
-    if ( state == 1 ) {
-        len = read( fd, input, 1 );
-        if ( len > 0 ) {
-            if ( input[0] == START_OF_MSG1 ) {
-                //fprintf( stderr, "read START_OF_MSG1\n");
+    rx_time = get_Time();
+    rx_tail += len;
+    return true;
+}
+
+// run the framing state machine over the buffered bytes, stop at the
+// end of a packet (returns true if it passed the checksum) or when
+// the buffer is empty.
+bool SerialLink::parse() {
+    while ( rx_count() > 0 ) {
+        if ( state == 4 ) {
+            // payload: copy as much as is buffered in one go
+            uint32_t pos = rx_head & (RX_BUF_SIZE - 1);
+            uint32_t n = pkt_len - counter;
+            if ( n > rx_count() ) { n = rx_count(); }
+            if ( n > RX_BUF_SIZE - pos ) { n = RX_BUF_SIZE - pos; }
+            memcpy( payload + counter, rx_buf + pos, n );
+            counter += n;
+            rx_head += n;
+            if ( counter >= pkt_len ) {
                 state++;
-            } else if ( input[0] == START_OF_MSG0 ) {
-                //fprintf( stderr, "read START_OF_MSG0\n");
-            } else {
-                parse_errors++;
-                state = 0;
             }
+            continue;
         }
-    }
-    if ( state == 2 ) {
-        len = read( fd, input, 1 );
-        if ( len > 0 ) {
-            pkt_id = input[0];
-            //fprintf( stderr, "pkt_id = %d\n", pkt_id );
-            state++;
-        }
-    }
-    if ( state == 3 ) {
-        len = read( fd, input, 1 );
-        if ( len > 0 ) {
-            pkt_len = input[0];
-            if ( pkt_len < 256 ) {
-                //fprintf( stderr, "pkt_len = %d\n", pkt_len );
+
+        uint8_t input = rx_buf[rx_head & (RX_BUF_SIZE - 1)];
+        rx_head++;
+
+        if ( state == 0 ) {
+            if ( input == START_OF_MSG0 ) {
+                state++;
+            }
+        } else if ( state == 1 ) {
+            if ( input == START_OF_MSG1 ) {
                 state++;
+            } else if ( input == START_OF_MSG0 ) {
+                // stay
             } else {
                 parse_errors++;
                 state = 0;
             }
-        }
-    }
-    if ( state == 4 ) {
-        len = read( fd, input, 1 );
-        while ( len > 0 ) {
-            payload[counter++] = input[0];
-            // fprintf( stderr, "%02X ", input[0] );
-            if ( counter >= pkt_len ) {
-                break;
-            }
-            len = read( fd, input, 1 );
-        }
-
-        if ( counter >= pkt_len ) {
+        } else if ( state == 2 ) {
+            pkt_id = input;
             state++;
-            // fprintf( stderr, "\n" );
-        }
-    }
-    if ( state == 5 ) {
-        len = read( fd, input, 1 );
-        if ( len > 0 ) {
-            cksum_lo = input[0];
+        } else if ( state == 3 ) {
+            pkt_len = input;
+            counter = 0;
+            if ( pkt_len > MAX_MESSAGE_LEN ) {
+                parse_errors++;
+                state = 0;
+            } else if ( pkt_len == 0 ) {
+                state = 5;
+            } else {
+                state++;
+            }
+        } else if ( state == 5 ) {
+            cksum_lo = input;
             state++;
-        }
-    }
-    if ( state == 6 ) {
-        len = read( fd, input, 1 );
-        if ( len > 0 ) {
-            cksum_hi = input[0];
+        } else if ( state == 6 ) {
+            cksum_hi = input;
+            // This Is the end of a record, reset state to 0 to start
+            // looking for next record
+            state = 0;
             uint8_t cksum0, cksum1;
             checksum( pkt_id, pkt_len, payload, pkt_len, &cksum0, &cksum1 );
             if ( cksum0 == cksum_lo && cksum1 == cksum_hi ) {
-                // printf( "checksum passes (%d)\n", pkt_id );
-                new_data = true;
+                return true;
             } else {
                 parse_errors++;
-                //if ( display_on ) {
-                    // printf("checksum failed %d %d (computed) != %d %d (message)\n",
-                    //        cksum_A, cksum_B, cksum_lo, cksum_hi );
-                //}
             }
-            // This Is the end of a record, reset state to 0 to start
-            // looking for next record
-            state = 0;
         }
     }
+    return false;
+}
+
+bool SerialLink::update() {
+    // a complete packet may already be buffered
+    if ( parse() ) {
+        return true;
+    }
+    if ( !fill() ) {
+        return false;
+    }
+    return parse();
+}
 
-    return new_data;
+bool SerialLink::update( int timeout_ms ) {
+    if ( parse() ) {
+        return true;
+    }
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if ( poll( &pfd, 1, timeout_ms ) <= 0 ) {
+        return false;
+    }
+    if ( !fill() ) {
+        return false;
+    }
+    return parse();
 }
 
 int SerialLink::bytes_available() {
     int avail = 0;
     ioctl(fd, FIONREAD, &avail);
-    return avail;
+    return avail + rx_count();
 }
 
 bool SerialLink::write_packet(uint8_t packet_id, uint8_t *payload, uint8_t len) {
-    uint8_t buf[2];
+    // assemble the whole packet and send it with a single write()
+    uint8_t buf[256 + 6];
     uint8_t cksum0, cksum1;
-    
+    int size = 0;
+
     // start of message sync (2) bytes
-    buf[0] = START_OF_MSG0;
-    write( fd, buf, 1 );
-    buf[0] = START_OF_MSG1;
-    write( fd, buf, 1 );
+    buf[size++] = START_OF_MSG0;
+    buf[size++] = START_OF_MSG1;
 
     // packet id (1 byte)
-    buf[0] = packet_id;
-    write( fd, buf, 1 );
-    
+    buf[size++] = packet_id;
+
     // packet length (1 byte)
-    buf[0] = len;
-    write( fd, buf, 1 );
+    buf[size++] = len;
 
-    // write payload
+    // payload
     if ( len > 0 ) {
-        write( fd, payload, len );
+        memcpy( buf + size, payload, len );
+        size += len;
     }
-    
+
     // check sum (2 bytes)
     checksum( packet_id, len, payload, len, &cksum0, &cksum1 );
-    buf[0] = cksum0;
-    write( fd, buf, 1 );
-    buf[0] = cksum1;
-    write( fd, buf, 1 );
+    buf[size++] = cksum0;
+    buf[size++] = cksum1;
+
+    int sent = 0;
+    while ( sent < size ) {
+        int result = write( fd, buf + sent, size - sent );
+        if ( result < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            return false;
+        }
+        sent += result;
+    }
 
     return true;
 }
 
 bool SerialLink::close() {
     int result = ::close(fd);
+    rx_head = rx_tail = 0;
+    state = 0;
     if ( result < 0 ) {
         fprintf( stderr, "unable to close serial: %s\n", strerror(errno) );
 	return false;
@@ -9,6 +9,13 @@ private:
     // port
     int fd = -1;
 
+    // receive ring buffer: each read() takes everything the uart has
+    // available and the parser then runs over the buffered bytes
+    static const uint32_t RX_BUF_SIZE = 4096; // power of 2
+    uint8_t rx_buf[RX_BUF_SIZE];
+    uint32_t rx_head = 0;       // next byte to parse
+    uint32_t rx_tail = 0;       // next free byte (head == tail: empty)
+
     // parser
     int state = 0;
     int counter = 0;
@@ -20,6 +27,9 @@ private:
 
     int encode_baud( int baud );
     void checksum( uint8_t hdr1, uint8_t hdr2, uint8_t *buf, uint8_t size, uint8_t *cksum0, uint8_t *cksum1 );
+    uint32_t rx_count() { return rx_tail - rx_head; }
+    bool fill();
+    bool parse();
 
 public:
 
@@ -29,13 +39,30 @@ public:
 
     uint32_t parse_errors = 0;
 
+    // get_Time() right after the read() that delivered the newest
+    // bytes.  A packet returned by update() completes in that read
+    // (buffered packets are drained before reading again), so this is
+    // its receive time, free of any delay before update() was called.
+    double rx_time = 0.0;
+
     SerialLink();
     ~SerialLink();
 
     bool open( int baud, const char *device_name );
+    // returns true when a complete packet is available in
+    // pkt_id/pkt_len/payload.  Packets already buffered are returned
+    // without a system call, otherwise a single (blocking) read()
+    // collects whatever has arrived.
     bool update();
+    // same, but waits at most timeout_ms for new bytes (for a reader
+    // thread that must notice a stop request)
+    bool update( int timeout_ms );
+    // bytes received but not yet parsed (uart + internal buffer)
     int bytes_available();
     bool write_packet(uint8_t packet_id, uint8_t *payload, uint8_t len);
     bool close();
     bool is_open() { return fd >= 0; }
+    int get_fd() { return fd; }
+    // bytes read from the uart but not yet parsed
+    int bytes_buffered() { return rx_count(); }
 };
@@ -0,0 +1,130 @@
+// serial_link_test.cpp - frame packets through the receive ring over a
+// pseudo terminal (no hardware needed)
+
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "serial_link.h"
+#include "test_check.h"
+
+// same fletcher style checksum as SerialLink
+static int frame( uint8_t *out, uint8_t id, const uint8_t *payload, uint8_t len,
+                  bool corrupt = false ) {
+    int size = 0;
+    out[size++] = 147;
+    out[size++] = 224;
+    out[size++] = id;
+    out[size++] = len;
+    uint8_t c0 = 0, c1 = 0;
+    c0 += id; c1 += c0;
+    c0 += len; c1 += c0;
+    for ( int i = 0; i < len; i++ ) {
+        out[size++] = payload[i];
+        c0 += payload[i];
+        c1 += c0;
+    }
+    out[size++] = corrupt ? c0 + 1 : c0;
+    out[size++] = c1;
+    return size;
+}
+
+int main() {
+    int master = posix_openpt( O_RDWR | O_NOCTTY );
+    if ( master < 0 || grantpt( master ) < 0 || unlockpt( master ) < 0 ) {
+        printf("no pseudo terminal available\n");
+        return 1;
+    }
+    SerialLink link;
+    check( link.open( 115200, ptsname( master ) ), "open" );
+
+    // 200 packets of varying length (0..199 bytes) with some noise and
+    // a corrupted packet every 25, sent in odd sized chunks so packets
+    // straddle reads and the ring wraps many times
+    static uint8_t stream[200 * 210 + 1000];
+    int size = 0;
+    int expected = 0;
+    int corrupted = 0;
+    for ( int i = 0; i < 200; i++ ) {
+        uint8_t payload[200];
+        int len = (i * 37) % 200;
+        for ( int j = 0; j < len; j++ ) {
+            payload[j] = (uint8_t)(i + j);
+        }
+        if ( i % 10 == 0 ) {
+            stream[size++] = 0x55;          // line noise
+            stream[size++] = 147;
+        }
+        bool corrupt = (i % 25 == 24);
+        size += frame( stream + size, i & 0xff, payload, len, corrupt );
+        if ( corrupt ) {
+            corrupted++;
+        } else {
+            expected++;
+        }
+    }
+
+    int sent = 0;
+    int received = 0;
+    int next_id = 0;
+    bool payload_ok = true;
+    bool order_ok = true;
+    while ( sent < size || link.bytes_available() > 0 ) {
+        if ( sent < size ) {
+            int chunk = 1 + (sent * 7) % 700;
+            if ( chunk > size - sent ) {
+                chunk = size - sent;
+            }
+            if ( write( master, stream + sent, chunk ) != chunk ) {
+                break;
+            }
+            sent += chunk;
+        }
+        while ( link.update( 10 ) ) {
+            while ( next_id % 25 == 24 ) {
+                next_id++;              // corrupted, never delivered
+            }
+            if ( link.pkt_id != next_id ) {
+                order_ok = false;
+            }
+            for ( int j = 0; j < link.pkt_len; j++ ) {
+                if ( link.payload[j] != (uint8_t)(next_id + j) ) {
+                    payload_ok = false;
+                }
+            }
+            if ( link.pkt_len != (next_id * 37) % 200 ) {
+                payload_ok = false;
+            }
+            next_id++;
+            received++;
+        }
+    }
+    check( received == expected, "every good packet delivered" );
+    check( order_ok, "packets in order" );
+    check( payload_ok, "payloads intact" );
+    check( link.parse_errors >= (uint32_t)corrupted, "bad checksums counted" );
+    check( link.rx_time > 0.0, "receive time stamped" );
+
+    // write_packet sends the whole frame
+    uint8_t payload[5] = { 1, 2, 3, 4, 5 };
+    uint8_t want[16], got[16];
+    int want_len = frame( want, 42, payload, 5 );
+    check( link.write_packet( 42, payload, 5 ), "write_packet" );
+    int got_len = 0;
+    while ( got_len < want_len ) {
+        int n = read( master, got + got_len, sizeof(got) - got_len );
+        if ( n <= 0 ) {
+            break;
+        }
+        got_len += n;
+    }
+    check( got_len == want_len && memcmp( got, want, want_len ) == 0,
+           "written frame matches" );
+
+    link.close();
+    close( master );
+    return check_summary();
+}
@@ -0,0 +1,56 @@
+// spsc_queue.h - fixed size single producer / single consumer queue
+//
+// A lock free ring for handing items from one thread to exactly one
+// other thread.  The producer only writes tail and the consumer only
+// writes head, so push() and pop() never wait on each other.  Items
+// are copied in and out; N must be a power of 2.
+
+#pragma once
+
+#include <atomic>
+
+template <class T, unsigned int N>
+class spsc_queue_t {
+
+    static_assert( (N & (N - 1)) == 0, "spsc_queue_t size must be a power of 2" );
+
+public:
+
+    // producer side, returns false (and drops item) when full
+    bool push( const T &item ) {
+        unsigned int t = tail.load( std::memory_order_relaxed );
+        if ( t - head.load( std::memory_order_acquire ) == N ) {
+            return false;
+        }
+        buf[t & (N - 1)] = item;
+        tail.store( t + 1, std::memory_order_release );
+        return true;
+    }
+
+    // consumer side, returns false when empty
+    bool pop( T *item ) {
+        unsigned int h = head.load( std::memory_order_relaxed );
+        if ( tail.load( std::memory_order_acquire ) == h ) {
+            return false;
+        }
+        *item = buf[h & (N - 1)];
+        head.store( h + 1, std::memory_order_release );
+        return true;
+    }
+
+    // number of queued items (exact from the consumer side)
+    unsigned int size() {
+        return tail.load( std::memory_order_acquire )
+            - head.load( std::memory_order_acquire );
+    }
+
+private:
+
+    T buf[N];
+    // keep the two indices on separate cache lines (padding rather
+    // than alignas so a heap allocated queue needs no aligned new)
+    char pad0[64];
+    std::atomic<unsigned int> head{0};
+    char pad1[64];
+    std::atomic<unsigned int> tail{0};
+};
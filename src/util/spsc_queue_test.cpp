@@ -0,0 +1,74 @@
+// spsc_queue_test.cpp - single thread edge cases, then a producer and
+// a consumer thread hammering one queue (also worth running under
+// -fsanitize=thread)
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <thread>
+
+#include "spsc_queue.h"
+#include "test_check.h"
+
+struct item_t {
+    uint32_t seq;
+    uint32_t check;
+    uint8_t data[48];
+};
+
+int main() {
+    // fill, overflow, drain, with the indices wrapping around
+    spsc_queue_t<int, 8> q;
+    int v;
+    check( !q.pop( &v ), "empty pop fails" );
+    bool ok = true;
+    for ( int round = 0; round < 1000; round++ ) {
+        for ( int i = 0; i < 8; i++ ) {
+            ok = ok && q.push( round * 8 + i );
+        }
+        ok = ok && !q.push( -1 ) && q.size() == 8;
+        for ( int i = 0; i < 8; i++ ) {
+            ok = ok && q.pop( &v ) && v == round * 8 + i;
+        }
+        ok = ok && q.size() == 0;
+    }
+    check( ok, "full queue rejects, items come out in order" );
+
+    // two threads: every item arrives once, intact and in order
+    static spsc_queue_t<item_t, 64> tq;
+    const uint32_t count = 200000;
+    std::thread producer( [&]() {
+            item_t item;
+            for ( uint32_t i = 0; i < count; ) {
+                item.seq = i;
+                item.check = i * 2654435761u;
+                for ( int j = 0; j < 48; j++ ) {
+                    item.data[j] = (uint8_t)(i + j);
+                }
+                if ( tq.push( item ) ) {
+                    i++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        } );
+    uint32_t expect = 0;
+    bool intact = true;
+    item_t item;
+    while ( expect < count ) {
+        if ( tq.pop( &item ) ) {
+            if ( item.seq != expect || item.check != expect * 2654435761u
+                 || item.data[47] != (uint8_t)(expect + 47) ) {
+                intact = false;
+            }
+            expect++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    check( intact, "two thread transfer intact and in order" );
+    check( tq.size() == 0, "drained" );
+
+    return check_summary();
+}
@@ -0,0 +1,21 @@
+// test_check.h - pass/fail reporting for the standalone *_test
+// programs: check() prints one result line, check_summary() prints
+// the failure count and returns the exit status for main()
+
+#pragma once
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+static inline void check( bool ok, const char *what ) {
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+    if ( !ok ) {
+        check_failures++;
+    }
+}
+
+static inline int check_summary() {
+    printf("%d failure(s)\n", check_failures);
+    return check_failures ? 1 : 0;
+}
@@ -33,7 +33,7 @@ type_code = { "double": 'd', "float": 'f',
 }
 
 reserved_names = [ 'id', 'len', 'payload', '_buf', '_i', '_pack_string',
-                   'pack', 'unpack' ]
+                   'pack', 'unpack', '_p', '_v', '_x' ]
 reserved_names += list(type_code.keys())
 
 basename, ext = os.path.splitext(args.input)
@@ -59,7 +59,115 @@ def field_name_helper(f):
     else:
         index = None
     return (name, index)
-    
+
+# packed size of each (non-string) field type
+type_size = { "double": 8, "float": 4,
+              "uint64_t": 8, "int64_t": 8,
+              "uint32_t": 4, "int32_t": 4,
+              "uint16_t": 2, "int16_t": 2,
+              "uint8_t": 1, "int8_t": 1,
+              "bool": 1
+}
+
+# read-only view and in-place builder for a fixed size message.  The
+# view decodes each field straight from a received payload and the
+# builder encodes each field straight into an outgoing payload, at
+# offsets computed here and checked against the packed struct at
+# compile time.
+def gen_cpp_view(m, enum_dict, constants_dict):
+    result = []
+    msg = m.getString("name")
+    id = id_dict[msg]
+    count = m.getLen("fields")
+    fields = []
+    offset = 0
+    for j in range(count):
+        f = m.getChild("fields[%d]" % j)
+        if f.getString("type") == "string":
+            # variable layout, only the copying struct is supported
+            return result
+        (name, index) = field_name_helper(f)
+        if f.hasChild("pack_type"):
+            ptype = f.getString("pack_type")
+        elif f.getString("type") in enum_dict:
+            ptype = "uint8_t"
+        else:
+            ptype = f.getString("type")
+        if index:
+            if index in constants_dict:
+                n = constants_dict[index]
+            else:
+                n = int(index)
+        else:
+            n = 1
+        fields.append( (f, name, index, ptype, offset) )
+        offset += type_size[ptype] * n
+    # an empty packed struct still has size 1 (and pack() sends it)
+    size = max(offset, 1)
+
+    result.append("// Read-only view of a received %s message (no copy)" % msg)
+    result.append("struct %s_view_t {" % msg)
+    result.append("    static const uint8_t id = %d;" % id)
+    result.append("    static const int len = %d;" % size)
+    result.append("    const uint8_t *_p;")
+    result.append("    %s_view_t(const uint8_t *payload): _p(payload) {}" % msg)
+    for (f, name, index, ptype, ofs) in fields:
+        ftype = f.getString("type")
+        if index:
+            line = "    %s %s(int _i) const { " % (ftype, name)
+            pos = "_p + %d + _i*%d" % (ofs, type_size[ptype])
+        else:
+            line = "    %s %s() const { " % (ftype, name)
+            pos = "_p + %d" % ofs
+        line += "%s _v; memcpy(&_v, %s, %d); " % (ptype, pos, type_size[ptype])
+        if f.hasChild("pack_scale"):
+            line += "return _v / (float)%s; }" % f.getString("pack_scale")
+        elif ftype in enum_dict:
+            line += "return (%s)_v; }" % ftype
+        else:
+            line += "return _v; }"
+        result.append(line)
+    result.append("};")
+    result.append("")
+
+    result.append("// In-place builder for an outgoing %s message (writes len bytes)" % msg)
+    result.append("struct %s_builder_t {" % msg)
+    result.append("    static const uint8_t id = %d;" % id)
+    result.append("    static const int len = %d;" % size)
+    result.append("    uint8_t *_p;")
+    result.append("    %s_builder_t(uint8_t *payload): _p(payload) {}" % msg)
+    for (f, name, index, ptype, ofs) in fields:
+        ftype = f.getString("type")
+        if index:
+            line = "    void %s(int _i, %s _v) { " % (name, ftype)
+            pos = "_p + %d + _i*%d" % (ofs, type_size[ptype])
+        else:
+            line = "    void %s(%s _v) { " % (name, ftype)
+            pos = "_p + %d" % ofs
+        if f.hasChild("pack_type"):
+            if ptype[0] == "i":
+                line += "%s _x = intround(_v" % ptype
+            else:
+                line += "%s _x = uintround(_v" % ptype
+            if f.hasChild("pack_scale"):
+                line += " * %s" % f.getString("pack_scale")
+            line += "); "
+        elif ftype in enum_dict:
+            line += "uint8_t _x = (uint8_t)_v; "
+        else:
+            line += "%s _x = _v; " % ptype
+        line += "memcpy(%s, &_x, %d); }" % (pos, type_size[ptype])
+        result.append(line)
+    result.append("};")
+    result.append("")
+
+    # compile time layout checks against the packed struct
+    result.append("static_assert(sizeof(%s_t::_compact_t) == %d, \"%s size\");" % (msg, size, msg))
+    for (f, name, index, ptype, ofs) in fields:
+        result.append("static_assert(offsetof(%s_t::_compact_t, %s) == %d, \"%s.%s offset\");" % (msg, name, ofs, msg, name))
+    result.append("")
+    return result
+
 def gen_cpp_header():
     result = []
 
@@ -76,6 +184,7 @@ def gen_cpp_header():
                 
     result.append("#pragma once")
     result.append("")
+    result.append("#include <stddef.h>  // offsetof()")
     result.append("#include <stdint.h>  // uint8_t, et. al.")
     result.append("#include <string.h>  // memcpy()")
     result.append("")
@@ -114,10 +223,12 @@ def gen_cpp_header():
     result.append("static const uint8_t message_max_len = 255;")
     result.append("");
     
+    constants_dict = {}
     if root.getLen("constants"):
         result.append("// Constants")
         for i in range(root.getLen("constants")):
             m = root.getChild("constants[%d]" % i)
+            constants_dict[m.getString("name")] = m.getInt("value")
             line = "static const %s %s = %s;" % (m.getString("type"), m.getString("name"), m.getString("value"))
             if m.hasChild("desc") != "":
                 line += "  // %s" % m.getString("desc")
@@ -332,6 +443,7 @@ def gen_cpp_header():
         result.append("    }")
         result.append("};")
         result.append("")
+        result += gen_cpp_view(m, enum_dict, constants_dict)
     result.append("} // namespace %s" % args.namespace)
     return result
 
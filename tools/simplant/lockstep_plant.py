@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+# lockstep_plant.py - stand-in aircraft plant for the fgfs driver's
+# lock-step mode.
+#
+# A simple kinematic fixed wing model (bank/pitch/speed responses to
+# aileron/elevator/throttle, coordinated turns) that speaks the fgfs
+# imu/gps/actuator udp packets.  Each frame it sends a gps packet (at
+# the gps rate) and an imu packet tagged with the frame number, then
+# waits for the actuator reply carrying the same frame number before
+# stepping again.  With --speedup 0 the flight code and plant run as
+# fast as they can answer each other.
+
+import argparse
+import math
+import socket
+import struct
+import time
+
+parser = argparse.ArgumentParser(description='lock-step stand-in plant for the fgfs driver')
+parser.add_argument('--host', default='127.0.0.1', help='host running the flight code')
+parser.add_argument('--imu-port', type=int, default=6500, help='flight code imu port')
+parser.add_argument('--gps-port', type=int, default=6501, help='flight code gps port')
+parser.add_argument('--act-port', type=int, default=6502, help='local actuator port')
+parser.add_argument('--rate', type=float, default=100.0, help='frame rate (hz)')
+parser.add_argument('--gps-rate', type=float, default=10.0, help='gps rate (hz)')
+parser.add_argument('--speedup', type=float, default=0.0, help='real time factor (0 = as fast as possible)')
+parser.add_argument('--duration', type=float, default=600.0, help='sim seconds to run')
+parser.add_argument('--lat', type=float, default=45.138, help='start latitude (deg)')
+parser.add_argument('--lon', type=float, default=-93.155, help='start longitude (deg)')
+parser.add_argument('--alt', type=float, default=400.0, help='start altitude MSL (m)')
+parser.add_argument('--ground', type=float, default=280.0, help='ground elevation MSL (m)')
+parser.add_argument('--heading', type=float, default=0.0, help='start heading (deg)')
+parser.add_argument('--airspeed', type=float, default=25.0, help='start airspeed (m/s)')
+parser.add_argument('--timeout', type=float, default=0.5, help='resend a frame if no reply (sec)')
+args = parser.parse_args()
+
+d2r = math.pi / 180.0
+r2d = 180.0 / math.pi
+g = 9.81
+earth_radius = 6378137.0
+mps2kt = 1.94384
+
+# packet formats (big endian, see drivers/fgfs.cpp)
+gps_fmt = '!dddffff'
+imu_fmt = '!dfffffffffffI'
+act_fmt = '!d17fI'
+
+class Plant():
+    def __init__(self):
+        self.lat = args.lat * d2r
+        self.lon = args.lon * d2r
+        self.alt = args.alt
+        self.phi = 0.0
+        self.theta = 2.0 * d2r
+        self.psi = args.heading * d2r
+        self.V = args.airspeed
+        self.v_ned = self.vel_ned()
+        self.rates = (0.0, 0.0, 0.0)
+        self.accel = (0.0, 0.0, -g)
+        self.ail = 0.0
+        self.ele = 0.0
+        self.thr = 0.5
+
+    def gamma(self):
+        # flight path angle, with a fixed small angle of attack
+        return self.theta - 2.0 * d2r
+
+    def vel_ned(self):
+        gamma = self.gamma()
+        return ( self.V * math.cos(gamma) * math.cos(self.psi),
+                 self.V * math.cos(gamma) * math.sin(self.psi),
+                 -self.V * math.sin(gamma) )
+
+    def update(self, dt):
+        # attitude responses (fgfs convention: +elevator is nose down)
+        phi_dot = 2.0 * self.ail - 0.2 * self.phi
+        theta_dot = -1.5 * self.ele + 1.0 * (2.0 * d2r - self.theta)
+        psi_dot = g * math.tan(self.phi) / max(self.V, 5.0)
+        self.phi = max(-60 * d2r, min(60 * d2r, self.phi + phi_dot * dt))
+        self.theta = max(-30 * d2r, min(30 * d2r, self.theta + theta_dot * dt))
+        self.psi = (self.psi + psi_dot * dt) % (2 * math.pi)
+
+        # speed: thrust - drag - gravity along the flight path
+        V_dot = 6.0 * self.thr - 0.006 * self.V * self.V - g * math.sin(self.gamma())
+        self.V = max(5.0, self.V + V_dot * dt)
+
+        # position
+        last_v = self.v_ned
+        self.v_ned = self.vel_ned()
+        vn, ve, vd = self.v_ned
+        self.lat += vn / earth_radius * dt
+        self.lon += ve / (earth_radius * math.cos(self.lat)) * dt
+        self.alt -= vd * dt
+        if self.alt < args.ground:
+            self.alt = args.ground
+            self.v_ned = (vn, ve, 0.0)
+
+        # body rates from the euler rates
+        sphi = math.sin(self.phi); cphi = math.cos(self.phi)
+        sthe = math.sin(self.theta); cthe = math.cos(self.theta)
+        p = phi_dot - psi_dot * sthe
+        q = theta_dot * cphi + psi_dot * sphi * cthe
+        r = -theta_dot * sphi + psi_dot * cphi * cthe
+        self.rates = (p, q, r)
+
+        # specific force (ned) rotated into the body frame
+        fn = (self.v_ned[0] - last_v[0]) / dt
+        fe = (self.v_ned[1] - last_v[1]) / dt
+        fd = (self.v_ned[2] - last_v[2]) / dt - g
+        spsi = math.sin(self.psi); cpsi = math.cos(self.psi)
+        ax = cthe*cpsi*fn + cthe*spsi*fe - sthe*fd
+        ay = (sphi*sthe*cpsi - cphi*spsi)*fn + (sphi*sthe*spsi + cphi*cpsi)*fe + sphi*cthe*fd
+        az = (cphi*sthe*cpsi + sphi*spsi)*fn + (cphi*sthe*spsi - sphi*cpsi)*fe + cphi*cthe*fd
+        self.accel = (ax, ay, az)
+
+    def gps_packet(self, sim_time, unix_time):
+        vn, ve, vd = self.v_ned
+        return struct.pack(gps_fmt, unix_time, self.lat * r2d, self.lon * r2d,
+                           self.alt, vn, ve, vd)
+
+    def imu_packet(self, sim_time, frame):
+        p, q, r = self.rates
+        ax, ay, az = self.accel
+        pressure = 29.92 * math.pow(1.0 - 2.25577e-5 * self.alt, 5.25588)
+        return struct.pack(imu_fmt, sim_time, p, q, r, ax, ay, az,
+                           self.V * mps2kt, pressure,
+                           self.phi * r2d, self.theta * r2d, self.psi * r2d,
+                           frame)
+
+    def set_controls(self, act):
+        self.ail = max(-1.0, min(1.0, act[1]))
+        self.ele = max(-1.0, min(1.0, act[2]))
+        self.thr = max(0.0, min(1.0, act[3]))
+
+sock_out = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+sock_act = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+sock_act.bind(('', args.act_port))
+sock_act.settimeout(args.timeout)
+act_size = struct.calcsize(act_fmt)
+
+plant = Plant()
+dt = 1.0 / args.rate
+gps_div = max(1, int(round(args.rate / args.gps_rate)))
+unix_start = time.time()
+wall_start = time.time()
+frame = 0
+resends = 0
+sim_time = 0.0
+
+print('lock-step plant: %.0f hz, gps every %d frames' % (args.rate, gps_div))
+while sim_time < args.duration:
+    frame += 1
+    sim_time = frame * dt
+    plant.update(dt)
+    gps_pkt = None
+    if frame % gps_div == 0:
+        gps_pkt = plant.gps_packet(sim_time, unix_start + sim_time)
+    imu_pkt = plant.imu_packet(sim_time, frame)
+    while True:
+        if gps_pkt:
+            sock_out.sendto(gps_pkt, (args.host, args.gps_port))
+        sock_out.sendto(imu_pkt, (args.host, args.imu_port))
+        act = None
+        try:
+            while True:
+                data = sock_act.recv(1024)
+                if len(data) == act_size:
+                    reply = struct.unpack(act_fmt, data)
+                    if reply[-1] == frame:
+                        act = reply
+                        break
+        except socket.timeout:
+            pass
+        if act:
+            break
+        resends += 1
+        # the gps packet only needs to go out once per frame
+        gps_pkt = None
+    plant.set_controls(act)
+
+    if args.speedup > 0.0:
+        ahead = sim_time / args.speedup - (time.time() - wall_start)
+        if ahead > 0.0:
+            time.sleep(ahead)
+
+    if frame % int(args.rate * 10) == 0:
+        elapsed = time.time() - wall_start
+        print('t=%.0f alt=%.1f V=%.1f hdg=%.0f  %.1fx real time  resends=%d'
+              % (sim_time, plant.alt, plant.V, plant.psi * r2d,
+                 sim_time / elapsed, resends))